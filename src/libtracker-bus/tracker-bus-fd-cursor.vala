@@ -28,6 +28,9 @@ class Tracker.Bus.FDCursor : Tracker.Sparql.Cursor {
 	internal char* data;
 	internal string[] variable_names;
 
+	/* Set when buffer is a query snapshot mapped in memory */
+	internal MappedFile mapped_file;
+
 	public FDCursor (char* buffer, ulong buffer_size, string[] variable_names) {
 		this.buffer = buffer;
 		this.buffer_size = buffer_size;
@@ -35,8 +38,18 @@ class Tracker.Bus.FDCursor : Tracker.Sparql.Cursor {
 		_n_columns = variable_names.length;
 	}
 
+	public FDCursor.mapped (MappedFile mapped_file, string[] variable_names) {
+		this.mapped_file = mapped_file;
+		this.buffer = mapped_file.get_contents ();
+		this.buffer_size = mapped_file.get_length ();
+		this.variable_names = variable_names;
+		_n_columns = variable_names.length;
+	}
+
 	~FDCursor () {
-		free (buffer);
+		if (mapped_file == null) {
+			free (buffer);
+		}
 	}
 
 	inline int buffer_read_int () {
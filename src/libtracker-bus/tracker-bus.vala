@@ -109,6 +109,34 @@ public class Tracker.Bus.Connection : Tracker.Sparql.Connection {
 		return new FDCursor (mem_stream.steal_data (), mem_stream.data_size, variable_names);
 	}
 
+	public async override Sparql.Cursor query_snapshot_async (string sparql, Cancellable? cancellable = null) throws Sparql.Error, IOError, DBusError {
+		var message = new DBusMessage.method_call (TRACKER_DBUS_SERVICE, TRACKER_DBUS_OBJECT_STEROIDS, TRACKER_DBUS_INTERFACE_STEROIDS, "QuerySnapshot");
+		message.set_body (new Variant ("(s)", sparql));
+
+		var reply = yield bus.send_message_with_reply (message, DBusSendMessageFlags.NONE, int.MAX, null, cancellable);
+		handle_error_reply (reply);
+
+		// (as h), in the order of the out parameters of QuerySnapshot
+		var body = reply.get_body ();
+		string[] variable_names = (string[]) body.get_child_value (0);
+		int fd = -1;
+
+		try {
+			fd = reply.get_unix_fd_list ().get (body.get_child_value (1).get_handle ());
+
+			// results are paged in from the spill file as the cursor goes
+			var snapshot = new MappedFile.from_fd (fd, false);
+
+			return new FDCursor.mapped (snapshot, variable_names);
+		} catch (Error e) {
+			throw new IOError.FAILED ("Could not map query snapshot: %s", e.message);
+		} finally {
+			if (fd >= 0) {
+				Posix.close (fd);
+			}
+		}
+	}
+
 	void send_update (string method, UnixInputStream input, Cancellable? cancellable, AsyncReadyCallback? callback) throws GLib.IOError {
 		var message = new DBusMessage.method_call (TRACKER_DBUS_SERVICE, TRACKER_DBUS_OBJECT_STEROIDS, TRACKER_DBUS_INTERFACE_STEROIDS, method);
 		var fd_list = new UnixFDList ();
@@ -221,6 +249,41 @@ public class Tracker.Bus.Connection : Tracker.Sparql.Connection {
 		return result;
 	}
 
+	public async override void update_statements_async (Sparql.Statements statements, int priority = GLib.Priority.DEFAULT, Cancellable? cancellable = null) throws Sparql.Error, IOError, DBusError {
+		UnixInputStream input;
+		UnixOutputStream output;
+		pipe (out input, out output);
+
+		var data = statements.end ();
+
+		// send D-Bus request
+		AsyncResult dbus_res = null;
+		bool sent_update = false;
+		send_update (priority <= GLib.Priority.DEFAULT ? "UpdateStatements" : "BatchUpdateStatements", input, cancellable, (o, res) => {
+			dbus_res = res;
+			if (sent_update) {
+				update_statements_async.callback ();
+			}
+		});
+
+		// send serialized statements via fd, no SPARQL involved
+		var data_stream = new DataOutputStream (output);
+		data_stream.set_byte_order (DataStreamByteOrder.HOST_ENDIAN);
+		size_t bytes_written;
+		data_stream.put_int32 ((int32) data.get_size ());
+		data_stream.write_all (data.get_data_as_bytes ().get_data (), out bytes_written);
+		data_stream = null;
+
+		// wait for D-Bus reply
+		sent_update = true;
+		if (dbus_res == null) {
+			yield;
+		}
+
+		var reply = bus.send_message_with_reply.end (dbus_res);
+		handle_error_reply (reply);
+	}
+
 	public override GLib.Variant? update_blank (string sparql, int priority = GLib.Priority.DEFAULT, Cancellable? cancellable = null) throws Sparql.Error, IOError, DBusError {
 		// use separate main context for sync operation
 		var context = new MainContext ();
@@ -32,6 +32,33 @@
 #define GET_PRIV(obj) (((TrackerClass*) obj)->priv)
 #define TRACKER_CLASS_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), TRACKER_TYPE_CLASS, TrackerClassPrivate))
 
+/* Events are appended to a batch preallocated for this many, batches
+ * are recycled once emitted unless they grew past the max size.
+ */
+#define EVENT_BATCH_PREALLOC_SIZE 64
+#define EVENT_BATCH_MAX_RECYCLED_SIZE 4096
+#define EVENT_BATCH_MAX_SPARE 32
+
+typedef struct {
+	gint64 sub_pred_id;
+	gint64 obj_graph_id;
+} TrackerClassEvent;
+
+typedef struct {
+	/* events of the current transaction */
+	GArray *pending;
+	/* how many of those belong to released savepoints */
+	guint n_staged;
+	/* batches of committed transactions, waiting to be emitted */
+	GPtrArray *ready;
+} TrackerClassEvents;
+
+/* Shared by all classes. Batches are taken on commit, in the update
+ * thread, and given back once emitted, in the main loop.
+ */
+static GPtrArray *spare_batches = NULL;
+static GMutex spare_batches_mutex;
+
 struct _TrackerClassPrivate {
 	gchar *uri;
 	gchar *name;
@@ -48,32 +75,188 @@ struct _TrackerClassPrivate {
 	GArray *last_domain_indexes;
 	GArray *last_super_classes;
 
-	struct {
-		struct {
-			GArray *sub_pred_ids;
-			GArray *obj_graph_ids;
-		} pending;
-		struct {
-			GArray *sub_pred_ids;
-			GArray *obj_graph_ids;
-		} ready;
-	} deletes;
-	struct {
-		struct {
-			GArray *sub_pred_ids;
-			GArray *obj_graph_ids;
-		} pending;
-		struct {
-			GArray *sub_pred_ids;
-			GArray *obj_graph_ids;
-		} ready;
-	} inserts;
+	TrackerClassEvents deletes;
+	TrackerClassEvents inserts;
 };
 
 static void class_finalize     (GObject      *object);
 
 G_DEFINE_TYPE (TrackerClass, tracker_class, G_TYPE_OBJECT);
 
+static GArray *
+event_batch_new (void)
+{
+	GArray *batch = NULL;
+
+	g_mutex_lock (&spare_batches_mutex);
+
+	if (spare_batches && spare_batches->len > 0) {
+		batch = g_ptr_array_remove_index_fast (spare_batches,
+		                                       spare_batches->len - 1);
+	}
+
+	g_mutex_unlock (&spare_batches_mutex);
+
+	if (batch) {
+		return batch;
+	}
+
+	return g_array_sized_new (FALSE, FALSE, sizeof (TrackerClassEvent),
+	                          EVENT_BATCH_PREALLOC_SIZE);
+}
+
+static void
+event_batch_release (GArray *batch)
+{
+	g_mutex_lock (&spare_batches_mutex);
+
+	if (!spare_batches) {
+		spare_batches = g_ptr_array_new ();
+	}
+
+	/* Don't keep around the memory of unusually big transactions */
+	if (batch->len > EVENT_BATCH_MAX_RECYCLED_SIZE ||
+	    spare_batches->len >= EVENT_BATCH_MAX_SPARE) {
+		g_mutex_unlock (&spare_batches_mutex);
+		g_array_free (batch, TRUE);
+		return;
+	}
+
+	g_array_set_size (batch, 0);
+	g_ptr_array_add (spare_batches, batch);
+
+	g_mutex_unlock (&spare_batches_mutex);
+}
+
+static gint
+event_compare (gconstpointer a,
+               gconstpointer b)
+{
+	const TrackerClassEvent *ea = a, *eb = b;
+
+	if (ea->sub_pred_id != eb->sub_pred_id) {
+		return (ea->sub_pred_id < eb->sub_pred_id) ? -1 : 1;
+	}
+
+	if (ea->obj_graph_id != eb->obj_graph_id) {
+		return (ea->obj_graph_id < eb->obj_graph_id) ? -1 : 1;
+	}
+
+	return 0;
+}
+
+/* Sorts the batch on subject and predicate, and drops the
+ * events repeated within it.
+ */
+static void
+event_batch_compact (GArray *batch)
+{
+	TrackerClassEvent *events;
+	guint i, n;
+
+	if (batch->len < 2) {
+		return;
+	}
+
+	g_array_sort (batch, event_compare);
+	events = (TrackerClassEvent *) batch->data;
+
+	for (i = 1, n = 1; i < batch->len; i++) {
+		if (event_compare (&events[n - 1], &events[i]) != 0) {
+			events[n++] = events[i];
+		}
+	}
+
+	g_array_set_size (batch, n);
+}
+
+static void
+class_events_init (TrackerClassEvents *events)
+{
+	events->pending = event_batch_new ();
+	events->n_staged = 0;
+	events->ready = g_ptr_array_new ();
+}
+
+static void
+class_events_reset_ready (TrackerClassEvents *events)
+{
+	guint i;
+
+	for (i = 0; i < events->ready->len; i++) {
+		event_batch_release (g_ptr_array_index (events->ready, i));
+	}
+
+	g_ptr_array_set_size (events->ready, 0);
+}
+
+static void
+class_events_free (TrackerClassEvents *events)
+{
+	class_events_reset_ready (events);
+	g_ptr_array_free (events->ready, TRUE);
+	g_array_free (events->pending, TRUE);
+}
+
+static void
+class_events_transact (TrackerClassEvents *events)
+{
+	events->n_staged = 0;
+
+	if (events->pending->len == 0) {
+		return;
+	}
+
+	event_batch_compact (events->pending);
+
+	/* The whole batch moves to the ready queue */
+	g_ptr_array_add (events->ready, events->pending);
+	events->pending = event_batch_new ();
+}
+
+static void
+class_events_foreach (TrackerClassEvents  *events,
+                      TrackerEventsForeach foreach,
+                      gpointer             user_data)
+{
+	guint i, j;
+
+	for (i = 0; i < events->ready->len; i++) {
+		GArray *batch = g_ptr_array_index (events->ready, i);
+
+		for (j = 0; j < batch->len; j++) {
+			TrackerClassEvent *event;
+			gint graph_id, subject_id, pred_id, object_id;
+
+			event = &g_array_index (batch, TrackerClassEvent, j);
+
+			pred_id = event->sub_pred_id & 0xffffffff;
+			subject_id = event->sub_pred_id >> 32;
+			graph_id = event->obj_graph_id & 0xffffffff;
+			object_id = event->obj_graph_id >> 32;
+
+			foreach (graph_id, subject_id, pred_id, object_id, user_data);
+		}
+	}
+}
+
+static void
+class_events_add (TrackerClassEvents *events,
+                  gint                graph_id,
+                  gint                subject_id,
+                  gint                pred_id,
+                  gint                object_id)
+{
+	TrackerClassEvent event;
+
+	event.sub_pred_id = (gint64) subject_id;
+	event.sub_pred_id = event.sub_pred_id << 32 | pred_id;
+	event.obj_graph_id = (gint64) object_id;
+	event.obj_graph_id = event.obj_graph_id << 32 | graph_id;
+
+	g_array_append_val (events->pending, event);
+}
+
 static void
 tracker_class_class_init (TrackerClassClass *klass)
 {
@@ -97,15 +280,8 @@ tracker_class_init (TrackerClass *service)
 	priv->last_domain_indexes = NULL;
 	priv->last_super_classes = NULL;
 
-	priv->deletes.pending.sub_pred_ids = g_array_new (FALSE, FALSE, sizeof (gint64));
-	priv->deletes.pending.obj_graph_ids = g_array_new (FALSE, FALSE, sizeof (gint64));
-	priv->deletes.ready.sub_pred_ids = g_array_new (FALSE, FALSE, sizeof (gint64));
-	priv->deletes.ready.obj_graph_ids = g_array_new (FALSE, FALSE, sizeof (gint64));
-
-	priv->inserts.pending.sub_pred_ids = g_array_new (FALSE, FALSE, sizeof (gint64));
-	priv->inserts.pending.obj_graph_ids = g_array_new (FALSE, FALSE, sizeof (gint64));
-	priv->inserts.ready.sub_pred_ids = g_array_new (FALSE, FALSE, sizeof (gint64));
-	priv->inserts.ready.obj_graph_ids = g_array_new (FALSE, FALSE, sizeof (gint64));
+	class_events_init (&priv->deletes);
+	class_events_init (&priv->inserts);
 
 	/* Make GET_PRIV working */
 	service->priv = priv;
@@ -124,15 +300,8 @@ class_finalize (GObject *object)
 	g_array_free (priv->super_classes, TRUE);
 	g_array_free (priv->domain_indexes, TRUE);
 
-	g_array_free (priv->deletes.pending.sub_pred_ids, TRUE);
-	g_array_free (priv->deletes.pending.obj_graph_ids, TRUE);
-	g_array_free (priv->deletes.ready.sub_pred_ids, TRUE);
-	g_array_free (priv->deletes.ready.obj_graph_ids, TRUE);
-
-	g_array_free (priv->inserts.pending.sub_pred_ids, TRUE);
-	g_array_free (priv->inserts.pending.obj_graph_ids, TRUE);
-	g_array_free (priv->inserts.ready.sub_pred_ids, TRUE);
-	g_array_free (priv->inserts.ready.obj_graph_ids, TRUE);
+	class_events_free (&priv->deletes);
+	class_events_free (&priv->inserts);
 
 	if (priv->last_domain_indexes) {
 		g_array_free (priv->last_domain_indexes, TRUE);
@@ -518,7 +687,7 @@ tracker_class_has_insert_events (TrackerClass *class)
 
 	priv = GET_PRIV (class);
 
-	return (priv->inserts.ready.sub_pred_ids->len > 0);
+	return (priv->inserts.ready->len > 0);
 }
 
 gboolean
@@ -530,7 +699,7 @@ tracker_class_has_delete_events (TrackerClass *class)
 
 	priv = GET_PRIV (class);
 
-	return (priv->deletes.ready.sub_pred_ids->len > 0);
+	return (priv->deletes.ready->len > 0);
 }
 
 void
@@ -538,7 +707,6 @@ tracker_class_foreach_insert_event (TrackerClass        *class,
                                     TrackerEventsForeach foreach,
                                     gpointer             user_data)
 {
-	guint i;
 	TrackerClassPrivate *priv;
 
 	g_return_if_fail (TRACKER_IS_CLASS (class));
@@ -546,21 +714,7 @@ tracker_class_foreach_insert_event (TrackerClass        *class,
 
 	priv = GET_PRIV (class);
 
-	for (i = 0; i < priv->inserts.ready.sub_pred_ids->len; i++) {
-		gint graph_id, subject_id, pred_id, object_id;
-		gint64 sub_pred_id;
-		gint64 obj_graph_id;
-
-		sub_pred_id = g_array_index (priv->inserts.ready.sub_pred_ids, gint64, i);
-		obj_graph_id = g_array_index (priv->inserts.ready.obj_graph_ids, gint64, i);
-
-		pred_id = sub_pred_id & 0xffffffff;
-		subject_id = sub_pred_id >> 32;
-		graph_id = obj_graph_id & 0xffffffff;
-		object_id = obj_graph_id >> 32;
-
-		foreach (graph_id, subject_id, pred_id, object_id, user_data);
-	}
+	class_events_foreach (&priv->inserts, foreach, user_data);
 }
 
 void
@@ -568,7 +722,6 @@ tracker_class_foreach_delete_event (TrackerClass        *class,
                                     TrackerEventsForeach foreach,
                                     gpointer             user_data)
 {
-	guint i;
 	TrackerClassPrivate *priv;
 
 	g_return_if_fail (TRACKER_IS_CLASS (class));
@@ -576,21 +729,7 @@ tracker_class_foreach_delete_event (TrackerClass        *class,
 
 	priv = GET_PRIV (class);
 
-	for (i = 0; i < priv->deletes.ready.sub_pred_ids->len; i++) {
-		gint graph_id, subject_id, pred_id, object_id;
-		gint64 sub_pred_id;
-		gint64 obj_graph_id;
-
-		sub_pred_id = g_array_index (priv->deletes.ready.sub_pred_ids, gint64, i);
-		obj_graph_id = g_array_index (priv->deletes.ready.obj_graph_ids, gint64, i);
-
-		pred_id = sub_pred_id & 0xffffffff;
-		subject_id = sub_pred_id >> 32;
-		graph_id = obj_graph_id & 0xffffffff;
-		object_id = obj_graph_id >> 32;
-
-		foreach (graph_id, subject_id, pred_id, object_id, user_data);
-	}
+	class_events_foreach (&priv->deletes, foreach, user_data);
 }
 
 void
@@ -602,13 +741,8 @@ tracker_class_reset_ready_events (TrackerClass *class)
 
 	priv = GET_PRIV (class);
 
-	/* Reset */
-	g_array_set_size (priv->deletes.ready.sub_pred_ids, 0);
-	g_array_set_size (priv->deletes.ready.obj_graph_ids, 0);
-
-	g_array_set_size (priv->inserts.ready.sub_pred_ids, 0);
-	g_array_set_size (priv->inserts.ready.obj_graph_ids, 0);
-
+	class_events_reset_ready (&priv->deletes);
+	class_events_reset_ready (&priv->inserts);
 }
 
 void
@@ -621,90 +755,54 @@ tracker_class_reset_pending_events (TrackerClass *class)
 	priv = GET_PRIV (class);
 
 	/* Reset */
-	g_array_set_size (priv->deletes.pending.sub_pred_ids, 0);
-	g_array_set_size (priv->deletes.pending.obj_graph_ids, 0);
-
-	g_array_set_size (priv->inserts.pending.sub_pred_ids, 0);
-	g_array_set_size (priv->inserts.pending.obj_graph_ids, 0);
+	g_array_set_size (priv->deletes.pending, 0);
+	priv->deletes.n_staged = 0;
 
+	g_array_set_size (priv->inserts.pending, 0);
+	priv->inserts.n_staged = 0;
 }
 
 void
-tracker_class_transact_events (TrackerClass *class)
+tracker_class_stage_events (TrackerClass *class)
 {
 	TrackerClassPrivate *priv;
 
 	g_return_if_fail (TRACKER_IS_CLASS (class));
 	priv = GET_PRIV (class);
 
-	/* Move */
-	g_array_insert_vals (priv->deletes.ready.obj_graph_ids,
-	                     priv->deletes.ready.obj_graph_ids->len,
-	                     priv->deletes.pending.obj_graph_ids->data,
-	                     priv->deletes.pending.obj_graph_ids->len);
-
-	g_array_insert_vals (priv->deletes.ready.sub_pred_ids,
-	                     priv->deletes.ready.sub_pred_ids->len,
-	                     priv->deletes.pending.sub_pred_ids->data,
-	                     priv->deletes.pending.sub_pred_ids->len);
-
-	/* Reset */
-	g_array_set_size (priv->deletes.pending.sub_pred_ids, 0);
-	g_array_set_size (priv->deletes.pending.obj_graph_ids, 0);
+	priv->deletes.n_staged = priv->deletes.pending->len;
+	priv->inserts.n_staged = priv->inserts.pending->len;
+}
 
+guint
+tracker_class_reset_unstaged_events (TrackerClass *class)
+{
+	TrackerClassPrivate *priv;
+	guint n_events;
 
-	/* Move */
-	g_array_insert_vals (priv->inserts.ready.obj_graph_ids,
-	                     priv->inserts.ready.obj_graph_ids->len,
-	                     priv->inserts.pending.obj_graph_ids->data,
-	                     priv->inserts.pending.obj_graph_ids->len);
+	g_return_val_if_fail (TRACKER_IS_CLASS (class), 0);
+	priv = GET_PRIV (class);
 
-	g_array_insert_vals (priv->inserts.ready.sub_pred_ids,
-	                     priv->inserts.ready.sub_pred_ids->len,
-	                     priv->inserts.pending.sub_pred_ids->data,
-	                     priv->inserts.pending.sub_pred_ids->len);
+	n_events = (priv->deletes.pending->len - priv->deletes.n_staged) +
+	           (priv->inserts.pending->len - priv->inserts.n_staged);
 
-	/* Reset */
-	g_array_set_size (priv->inserts.pending.sub_pred_ids, 0);
-	g_array_set_size (priv->inserts.pending.obj_graph_ids, 0);
+	/* Only drop what was added since the last stage */
+	g_array_set_size (priv->deletes.pending, priv->deletes.n_staged);
+	g_array_set_size (priv->inserts.pending, priv->inserts.n_staged);
 
+	return n_events;
 }
 
-static void
-insert_vals_into_arrays (GArray *sub_pred_ids,
-                         GArray *obj_graph_ids,
-                         gint    graph_id,
-                         gint    subject_id,
-                         gint    pred_id,
-                         gint    object_id)
-{
-	gint i, j, k;
-	gint64 tmp;
-	gint64 sub_pred_id;
-	gint64 obj_graph_id;
-
-	sub_pred_id = (gint64) subject_id;
-	sub_pred_id = sub_pred_id << 32 | pred_id;
-	obj_graph_id = (gint64) object_id;
-	obj_graph_id = obj_graph_id << 32 | graph_id;
-
-	i = 0;
-	j = sub_pred_ids->len - 1;
+void
+tracker_class_transact_events (TrackerClass *class)
+{
+	TrackerClassPrivate *priv;
 
-	while (j - i > 0) {
-		k = (i + j) / 2;
-		tmp = g_array_index (sub_pred_ids, gint64, k);
-		if (tmp == sub_pred_id) {
-			i = k + 1;
-			break;
-		} else if (tmp > sub_pred_id)
-			j = k;
-		else
-			i = k + 1;
-	}
+	g_return_if_fail (TRACKER_IS_CLASS (class));
+	priv = GET_PRIV (class);
 
-	g_array_insert_val (sub_pred_ids, i, sub_pred_id);
-	g_array_insert_val (obj_graph_ids, i, obj_graph_id);
+	class_events_transact (&priv->deletes);
+	class_events_transact (&priv->inserts);
 }
 
 void
@@ -719,12 +817,7 @@ tracker_class_add_insert_event (TrackerClass *class,
 	g_return_if_fail (TRACKER_IS_CLASS (class));
 	priv = GET_PRIV (class);
 
-	insert_vals_into_arrays (priv->inserts.pending.sub_pred_ids,
-	                         priv->inserts.pending.obj_graph_ids,
-	                         graph_id,
-	                         subject_id,
-	                         pred_id,
-	                         object_id);
+	class_events_add (&priv->inserts, graph_id, subject_id, pred_id, object_id);
 }
 
 void
@@ -739,10 +832,5 @@ tracker_class_add_delete_event (TrackerClass *class,
 	g_return_if_fail (TRACKER_IS_CLASS (class));
 	priv = GET_PRIV (class);
 
-	insert_vals_into_arrays (priv->deletes.pending.sub_pred_ids,
-	                         priv->deletes.pending.obj_graph_ids,
-	                         graph_id,
-	                         subject_id,
-	                         pred_id,
-	                         object_id);
+	class_events_add (&priv->deletes, graph_id, subject_id, pred_id, object_id);
 }
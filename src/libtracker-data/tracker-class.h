@@ -103,6 +103,8 @@ gboolean          tracker_class_has_insert_events      (TrackerClass        *cla
 gboolean          tracker_class_has_delete_events      (TrackerClass        *class);
 void              tracker_class_reset_ready_events     (TrackerClass        *class);
 void              tracker_class_reset_pending_events   (TrackerClass        *class);
+void              tracker_class_stage_events           (TrackerClass        *class);
+guint             tracker_class_reset_unstaged_events  (TrackerClass        *class);
 void              tracker_class_transact_events        (TrackerClass        *class);
 void              tracker_class_add_delete_event       (TrackerClass        *class,
                                                         gint                 graph_id,
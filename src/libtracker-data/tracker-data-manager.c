@@ -3611,6 +3611,36 @@ tracker_data_manager_init_fts (TrackerDBInterface *iface,
 #endif
 }
 
+static void
+tracker_data_manager_update_fts (TrackerDBInterface *iface)
+{
+#if HAVE_TRACKER_FTS
+	GHashTable *fts_props, *multivalued;
+	GError *error = NULL;
+
+	if (!tracker_db_interface_sqlite_fts_is_outdated (iface)) {
+		return;
+	}
+
+	/* FTS configuration affecting the table layout changed */
+	g_message ("Rebuilding full text index, this may take a while...");
+
+	ontology_get_fts_properties (FALSE, &fts_props, &multivalued);
+
+	tracker_db_interface_start_transaction (iface);
+	tracker_db_interface_sqlite_fts_alter_table (iface, fts_props, multivalued);
+	tracker_db_interface_end_db_transaction (iface, &error);
+
+	if (error) {
+		g_critical ("Could not rebuild full text index: %s", error->message);
+		g_error_free (error);
+	}
+
+	g_hash_table_unref (fts_props);
+	g_hash_table_unref (multivalued);
+#endif
+}
+
 gboolean
 tracker_data_manager_init (TrackerDBManagerFlags   flags,
                            const gchar           **test_schemas,
@@ -4024,6 +4054,10 @@ tracker_data_manager_init (TrackerDBManagerFlags   flags,
 		}
 
 		tracker_data_manager_init_fts (iface, FALSE);
+
+		if (!read_only) {
+			tracker_data_manager_update_fts (iface);
+		}
 	}
 
 	if (check_ontology) {
@@ -4574,6 +4608,29 @@ tracker_data_manager_init (TrackerDBManagerFlags   flags,
 
 	if (!read_only) {
 		tracker_ontologies_sort ();
+
+		/* After any journal replay, which isn't recorded */
+		tracker_data_change_log_init (&internal_error);
+	}
+
+	if (!internal_error) {
+		tracker_data_class_counts_init (read_only, &internal_error);
+	}
+
+	if (internal_error) {
+		g_propagate_error (error, internal_error);
+
+#ifndef DISABLE_JOURNAL
+		tracker_db_journal_shutdown (NULL);
+#endif /* DISABLE_JOURNAL */
+		tracker_db_manager_shutdown ();
+		tracker_ontologies_shutdown ();
+		if (!reloading) {
+			tracker_locale_shutdown ();
+		}
+		tracker_data_update_shutdown ();
+
+		return FALSE;
 	}
 
 	initialized = TRUE;
@@ -129,6 +129,105 @@ tracker_data_query_resource_id (const gchar *uri)
 }
 
 
+/**
+ * tracker_data_query_changes:
+ * @since_modseq: last modseq already known to the caller
+ * @class_ids: IDs of the classes to get changes for, or %NULL for all
+ * @n_class_ids: number of elements in @class_ids
+ * @error: return location for errors
+ *
+ * Returns a cursor over the change log entries after @since_modseq,
+ * in the order they were done. Columns are the modseq, class,
+ * graph, subject and predicate IDs, and the #TrackerDataStatementOperation.
+ *
+ * Changes are only complete if @since_modseq is not below
+ * tracker_data_query_change_log_start() - 1, read after going
+ * through the cursor.
+ *
+ * Returns: a #TrackerDBCursor, or %NULL on error.
+ **/
+TrackerDBCursor *
+tracker_data_query_changes (gint          since_modseq,
+                            const gint   *class_ids,
+                            gint          n_class_ids,
+                            GError      **error)
+{
+	TrackerDBInterface *iface;
+	TrackerDBStatement *stmt;
+	TrackerDBCursor *cursor = NULL;
+	GString *sql;
+	gint i;
+
+	iface = tracker_db_manager_get_db_interface ();
+
+	sql = g_string_new ("SELECT Modseq, Class, Graph, Subject, Predicate, Op "
+	                    "FROM ChangeLog WHERE Modseq > ?");
+
+	if (n_class_ids > 0) {
+		g_string_append (sql, " AND Class IN (");
+
+		for (i = 0; i < n_class_ids; i++) {
+			g_string_append_printf (sql, "%s%d", i > 0 ? ", " : "", class_ids[i]);
+		}
+
+		g_string_append_c (sql, ')');
+	}
+
+	g_string_append (sql, " ORDER BY Modseq, rowid");
+
+	stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_NONE, error,
+	                                              "%s", sql->str);
+	g_string_free (sql, TRUE);
+
+	if (stmt) {
+		tracker_db_statement_bind_int (stmt, 0, since_modseq);
+		cursor = tracker_db_statement_start_cursor (stmt, error);
+		g_object_unref (stmt);
+	}
+
+	return cursor;
+}
+
+/**
+ * tracker_data_query_change_log_start:
+ * @error: return location for errors
+ *
+ * Returns: the first modseq the change log has all changes for.
+ **/
+gint
+tracker_data_query_change_log_start (GError **error)
+{
+	TrackerDBInterface *iface;
+	TrackerDBStatement *stmt;
+	TrackerDBCursor *cursor = NULL;
+	GError *internal_error = NULL;
+	gint start = 0;
+
+	iface = tracker_db_manager_get_db_interface ();
+
+	stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_SELECT, &internal_error,
+	                                              "SELECT Modseq FROM ChangeLogStart");
+
+	if (stmt) {
+		cursor = tracker_db_statement_start_cursor (stmt, &internal_error);
+		g_object_unref (stmt);
+	}
+
+	if (cursor) {
+		if (tracker_db_cursor_iter_next (cursor, NULL, &internal_error)) {
+			start = tracker_db_cursor_get_int (cursor, 0);
+		}
+
+		g_object_unref (cursor);
+	}
+
+	if (internal_error) {
+		g_propagate_error (error, internal_error);
+	}
+
+	return start;
+}
+
 TrackerDBCursor *
 tracker_data_query_sparql_cursor (const gchar  *query,
                                   GError      **error)
@@ -39,6 +39,12 @@ TrackerDBCursor     *tracker_data_query_sparql_cursor (const gchar  *query,
 
 GPtrArray*           tracker_data_query_rdf_type      (gint          id);
 
+TrackerDBCursor     *tracker_data_query_changes          (gint          since_modseq,
+                                                          const gint   *class_ids,
+                                                          gint          n_class_ids,
+                                                          GError      **error);
+gint                 tracker_data_query_change_log_start (GError      **error);
+
 G_END_DECLS
 
 #endif /* __LIBTRACKER_DATA_QUERY_H__ */
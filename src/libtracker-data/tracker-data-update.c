@@ -56,9 +56,11 @@ typedef struct _TrackerDataUpdateBufferResource TrackerDataUpdateBufferResource;
 typedef struct _TrackerDataUpdateBufferPredicate TrackerDataUpdateBufferPredicate;
 typedef struct _TrackerDataUpdateBufferProperty TrackerDataUpdateBufferProperty;
 typedef struct _TrackerDataUpdateBufferTable TrackerDataUpdateBufferTable;
+typedef struct _TrackerDataUpdateBufferFts TrackerDataUpdateBufferFts;
 typedef struct _TrackerDataBlankBuffer TrackerDataBlankBuffer;
 typedef struct _TrackerStatementDelegate TrackerStatementDelegate;
 typedef struct _TrackerCommitDelegate TrackerCommitDelegate;
+typedef struct _TrackerSavepointDelegate TrackerSavepointDelegate;
 
 struct _TrackerDataUpdateBuffer {
 	/* string -> integer */
@@ -71,9 +73,13 @@ struct _TrackerDataUpdateBuffer {
 	/* the following two fields are valid per sqlite transaction, not just for same subject */
 	/* TrackerClass -> integer */
 	GHashTable *class_counts;
+	/* TrackerClass -> integer, changes since the current savepoint */
+	GHashTable *savepoint_class_counts;
 
 #if HAVE_TRACKER_FTS
 	gboolean fts_ever_updated;
+	/* integer -> TrackerDataUpdateBufferFts */
+	GHashTable *fts_pending;
 #endif
 };
 
@@ -91,6 +97,8 @@ struct _TrackerDataUpdateBufferResource {
 
 #if HAVE_TRACKER_FTS
 	gboolean fts_updated;
+	/* TrackerProperty -> string, indexed text before this update */
+	GHashTable *fts_old_text;
 #endif
 };
 
@@ -115,6 +123,16 @@ struct _TrackerDataUpdateBufferTable {
 	GArray *properties;
 };
 
+/* FTS row to be inserted on commit, kept until then so
+ * all rows in a transaction are inserted in docid order */
+struct _TrackerDataUpdateBufferFts {
+	gint id;
+	/* const gchar*, NULL-terminated */
+	GPtrArray *properties;
+	/* gchar*, NULL-terminated */
+	GPtrArray *text;
+};
+
 /* buffer for anonymous blank nodes
  * that are not yet in the database */
 struct _TrackerDataBlankBuffer {
@@ -138,6 +156,11 @@ struct _TrackerCommitDelegate {
 	gpointer user_data;
 };
 
+struct _TrackerSavepointDelegate {
+	TrackerSavepointCallback callback;
+	gpointer user_data;
+};
+
 typedef struct {
 	gchar *graph;
 	gchar *subject;
@@ -156,16 +179,39 @@ static TrackerDataBlankBuffer blank_buffer;
 static time_t resource_time = 0;
 static gint transaction_modseq = 0;
 static gboolean has_persistent = TRUE;
+static gboolean in_savepoint = FALSE;
+static gboolean change_log_enabled = FALSE;
+static gboolean class_counts_enabled = FALSE;
+static gboolean class_counts_loaded = FALSE;
 
 static GPtrArray *insert_callbacks = NULL;
 static GPtrArray *delete_callbacks = NULL;
 static GPtrArray *commit_callbacks = NULL;
 static GPtrArray *rollback_callbacks = NULL;
+static GPtrArray *savepoint_callbacks = NULL;
 static gint max_service_id = 0;
 static gint max_ontology_id = 0;
 
 static gint         ensure_resource_id         (const gchar      *uri,
                                                 gboolean         *create);
+static void         change_log_insert_cb       (gint              graph_id,
+                                                const gchar      *graph,
+                                                gint              subject_id,
+                                                const gchar      *subject,
+                                                gint              predicate_id,
+                                                gint              object_id,
+                                                const gchar      *object,
+                                                GPtrArray        *rdf_types,
+                                                gpointer          user_data);
+static void         change_log_delete_cb       (gint              graph_id,
+                                                const gchar      *graph,
+                                                gint              subject_id,
+                                                const gchar      *subject,
+                                                gint              predicate_id,
+                                                gint              object_id,
+                                                const gchar      *object,
+                                                GPtrArray        *rdf_types,
+                                                gpointer          user_data);
 static void         cache_insert_value         (const gchar      *table_name,
                                                 const gchar      *field_name,
                                                 gboolean          transient,
@@ -272,6 +318,48 @@ tracker_data_remove_rollback_statement_callback (TrackerCommitCallback callback,
 	}
 }
 
+void
+tracker_data_add_savepoint_callback (TrackerSavepointCallback callback,
+                                     gpointer                 user_data)
+{
+	TrackerSavepointDelegate *delegate = g_new0 (TrackerSavepointDelegate, 1);
+
+	if (!savepoint_callbacks) {
+		savepoint_callbacks = g_ptr_array_new ();
+	}
+
+	delegate->callback = callback;
+	delegate->user_data = user_data;
+
+	g_ptr_array_add (savepoint_callbacks, delegate);
+}
+
+void
+tracker_data_remove_savepoint_callback (TrackerSavepointCallback callback,
+                                        gpointer                 user_data)
+{
+	TrackerSavepointDelegate *delegate;
+	guint i;
+	gboolean found = FALSE;
+
+	if (!savepoint_callbacks) {
+		return;
+	}
+
+	for (i = 0; i < savepoint_callbacks->len; i++) {
+		delegate = g_ptr_array_index (savepoint_callbacks, i);
+		if (delegate->callback == callback && delegate->user_data == user_data) {
+			found = TRUE;
+			break;
+		}
+	}
+
+	if (found) {
+		g_free (delegate);
+		g_ptr_array_remove_index (savepoint_callbacks, i);
+	}
+}
+
 void
 tracker_data_add_insert_statement_callback (TrackerStatementCallback callback,
                                             gpointer                 user_data)
@@ -468,6 +556,15 @@ tracker_data_update_shutdown (void)
 	max_service_id = 0;
 	max_ontology_id = 0;
 	transaction_modseq = 0;
+
+	if (change_log_enabled) {
+		tracker_data_remove_insert_statement_callback (change_log_insert_cb, NULL);
+		tracker_data_remove_delete_statement_callback (change_log_delete_cb, NULL);
+		change_log_enabled = FALSE;
+	}
+
+	class_counts_enabled = FALSE;
+	class_counts_loaded = FALSE;
 }
 
 static gint
@@ -485,6 +582,516 @@ get_transaction_modseq (void)
 	return transaction_modseq;
 }
 
+/* The change log keeps, for resources of tracker:notify classes, the
+ * same changes GraphUpdated signals are emitted for, so clients that
+ * missed the signals can catch up from the last modseq they saw.
+ * It's trimmed to about CHANGE_LOG_MAX_ROWS rows every
+ * CHANGE_LOG_TRIM_INTERVAL transactions, ChangeLogStart holding the
+ * first modseq it still has complete changes for.
+ */
+#define CHANGE_LOG_MAX_ROWS      100000
+#define CHANGE_LOG_TRIM_INTERVAL 1000
+
+static gint change_log_max_rows = CHANGE_LOG_MAX_ROWS;
+static gint change_log_trim_interval = CHANGE_LOG_TRIM_INTERVAL;
+
+static void
+change_log_add (gint                         graph_id,
+                gint                         subject_id,
+                gint                         predicate_id,
+                GPtrArray                   *rdf_types,
+                TrackerDataStatementOperation operation)
+{
+	TrackerDBInterface *iface;
+	TrackerDBStatement *stmt;
+	GError *error = NULL;
+	guint i;
+
+	if (in_journal_replay || in_ontology_transaction) {
+		return;
+	}
+
+	iface = tracker_db_manager_get_db_interface ();
+
+	for (i = 0; i < rdf_types->len; i++) {
+		TrackerClass *class = g_ptr_array_index (rdf_types, i);
+
+		if (!tracker_class_get_notify (class)) {
+			continue;
+		}
+
+		stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_UPDATE, &error,
+		                                              "INSERT INTO ChangeLog (Modseq, Class, Graph, Subject, Predicate, Op) "
+		                                              "VALUES (?, ?, ?, ?, ?, ?)");
+
+		if (stmt) {
+			tracker_db_statement_bind_int (stmt, 0, get_transaction_modseq ());
+			tracker_db_statement_bind_int (stmt, 1, tracker_class_get_id (class));
+			tracker_db_statement_bind_int (stmt, 2, graph_id);
+			tracker_db_statement_bind_int (stmt, 3, subject_id);
+			tracker_db_statement_bind_int (stmt, 4, predicate_id);
+			tracker_db_statement_bind_int (stmt, 5, operation);
+			tracker_db_statement_execute (stmt, &error);
+			g_object_unref (stmt);
+		}
+
+		if (error) {
+			g_warning ("Could not add to change log: %s", error->message);
+			g_clear_error (&error);
+			return;
+		}
+	}
+}
+
+static void
+change_log_insert_cb (gint         graph_id,
+                      const gchar *graph,
+                      gint         subject_id,
+                      const gchar *subject,
+                      gint         predicate_id,
+                      gint         object_id,
+                      const gchar *object,
+                      GPtrArray   *rdf_types,
+                      gpointer     user_data)
+{
+	change_log_add (graph_id, subject_id, predicate_id, rdf_types,
+	                TRACKER_DATA_STATEMENT_INSERT);
+}
+
+static void
+change_log_delete_cb (gint         graph_id,
+                      const gchar *graph,
+                      gint         subject_id,
+                      const gchar *subject,
+                      gint         predicate_id,
+                      gint         object_id,
+                      const gchar *object,
+                      GPtrArray   *rdf_types,
+                      gpointer     user_data)
+{
+	change_log_add (graph_id, subject_id, predicate_id, rdf_types,
+	                TRACKER_DATA_STATEMENT_DELETE);
+}
+
+static void
+change_log_trim (void)
+{
+	TrackerDBInterface *iface;
+	TrackerDBStatement *stmt;
+	TrackerDBCursor *cursor = NULL;
+	GError *error = NULL;
+	gint start = 0;
+
+	iface = tracker_db_manager_get_db_interface ();
+
+	stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_SELECT, &error,
+	                                              "SELECT Modseq FROM ChangeLog "
+	                                              "ORDER BY Modseq DESC LIMIT 1 OFFSET ?");
+
+	if (stmt) {
+		tracker_db_statement_bind_int (stmt, 0, change_log_max_rows);
+		cursor = tracker_db_statement_start_cursor (stmt, &error);
+		g_object_unref (stmt);
+	}
+
+	if (cursor) {
+		if (tracker_db_cursor_iter_next (cursor, NULL, &error)) {
+			start = tracker_db_cursor_get_int (cursor, 0);
+		}
+
+		g_object_unref (cursor);
+	}
+
+	if (start > 0) {
+		stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_UPDATE, &error,
+		                                              "DELETE FROM ChangeLog WHERE Modseq < ?");
+
+		if (stmt) {
+			tracker_db_statement_bind_int (stmt, 0, start);
+			tracker_db_statement_execute (stmt, &error);
+			g_object_unref (stmt);
+		}
+	}
+
+	if (start > 0 && !error) {
+		stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_UPDATE, &error,
+		                                              "UPDATE ChangeLogStart SET Modseq = ?");
+
+		if (stmt) {
+			tracker_db_statement_bind_int (stmt, 0, start);
+			tracker_db_statement_execute (stmt, &error);
+			g_object_unref (stmt);
+		}
+	}
+
+	if (G_UNLIKELY (error)) {
+		g_warning ("Could not trim change log: %s", error->message);
+		g_error_free (error);
+	}
+}
+
+static gint
+change_log_limit (const gchar *variable,
+                  gint         default_value)
+{
+	const gchar *value;
+	gint limit;
+
+	value = g_getenv (variable);
+	limit = value ? atoi (value) : 0;
+
+	return limit > 0 ? limit : default_value;
+}
+
+/**
+ * tracker_data_change_log_init:
+ * @error: return location for errors
+ *
+ * Creates the change log tables if needed, and starts recording
+ * changes in them.
+ **/
+void
+tracker_data_change_log_init (GError **error)
+{
+	TrackerDBInterface *iface;
+	TrackerDBStatement *stmt;
+	GError *internal_error = NULL;
+
+	/* Tests shrink the log to see it trimmed */
+	change_log_max_rows = change_log_limit ("TRACKER_CHANGE_LOG_MAX_ROWS",
+	                                        CHANGE_LOG_MAX_ROWS);
+	change_log_trim_interval = change_log_limit ("TRACKER_CHANGE_LOG_TRIM_INTERVAL",
+	                                             CHANGE_LOG_TRIM_INTERVAL);
+
+	iface = tracker_db_manager_get_db_interface ();
+
+	tracker_db_interface_execute_query (iface, &internal_error,
+	                                    "CREATE TABLE IF NOT EXISTS ChangeLog ("
+	                                    "Modseq INTEGER NOT NULL, "
+	                                    "Class INTEGER NOT NULL, "
+	                                    "Graph INTEGER NOT NULL, "
+	                                    "Subject INTEGER NOT NULL, "
+	                                    "Predicate INTEGER NOT NULL, "
+	                                    "Op INTEGER NOT NULL)");
+
+	if (!internal_error) {
+		tracker_db_interface_execute_query (iface, &internal_error,
+		                                    "CREATE INDEX IF NOT EXISTS \"ChangeLog_Modseq\" "
+		                                    "ON ChangeLog (Modseq)");
+	}
+
+	if (!internal_error) {
+		tracker_db_interface_execute_query (iface, &internal_error,
+		                                    "CREATE TABLE IF NOT EXISTS ChangeLogStart ("
+		                                    "Modseq INTEGER NOT NULL)");
+	}
+
+	if (!internal_error) {
+		/* Changes before the log existed are unknown, it's
+		 * complete from the next transaction on.
+		 */
+		stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_NONE, &internal_error,
+		                                              "INSERT INTO ChangeLogStart (Modseq) "
+		                                              "SELECT ? WHERE NOT EXISTS (SELECT 1 FROM ChangeLogStart)");
+
+		if (stmt) {
+			tracker_db_statement_bind_int (stmt, 0, tracker_data_update_get_next_modseq ());
+			tracker_db_statement_execute (stmt, &internal_error);
+			g_object_unref (stmt);
+		}
+	}
+
+	if (internal_error) {
+		g_propagate_error (error, internal_error);
+		return;
+	}
+
+	tracker_data_add_insert_statement_callback (change_log_insert_cb, NULL);
+	tracker_data_add_delete_statement_callback (change_log_delete_cb, NULL);
+	change_log_enabled = TRUE;
+}
+
+/* Instance counts of classes are kept in memory by add_class_count(),
+ * ClassCounts holds them as of the last commit, so they don't need
+ * counting again on each start.
+ */
+static void
+class_counts_write (TrackerClass  *class,
+                    GError       **error)
+{
+	TrackerDBInterface *iface;
+	TrackerDBStatement *stmt;
+
+	iface = tracker_db_manager_get_db_interface ();
+
+	stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_UPDATE, error,
+	                                              "INSERT OR REPLACE INTO ClassCounts (Class, Count) "
+	                                              "VALUES (?, ?)");
+
+	if (stmt) {
+		tracker_db_statement_bind_int (stmt, 0, tracker_class_get_id (class));
+		tracker_db_statement_bind_int (stmt, 1, tracker_class_get_count (class));
+		tracker_db_statement_execute (stmt, error);
+		g_object_unref (stmt);
+	}
+}
+
+/* Writes the counts of the classes changed in this transaction */
+static void
+class_counts_flush (GError **error)
+{
+	GHashTableIter iter;
+	gpointer class;
+
+	if (!update_buffer.class_counts) {
+		return;
+	}
+
+	g_hash_table_iter_init (&iter, update_buffer.class_counts);
+	while (g_hash_table_iter_next (&iter, &class, NULL)) {
+		class_counts_write (class, error);
+
+		if (*error) {
+			return;
+		}
+	}
+}
+
+static gint
+class_counts_count_instances (TrackerClass  *class,
+                              GError       **error)
+{
+	TrackerDBInterface *iface;
+	TrackerDBStatement *stmt;
+	TrackerDBCursor *cursor = NULL;
+	gint count = 0;
+
+	iface = tracker_db_manager_get_db_interface ();
+
+	stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_NONE, error,
+	                                              "SELECT COUNT(1) FROM \"%s\"",
+	                                              tracker_class_get_name (class));
+
+	if (stmt) {
+		cursor = tracker_db_statement_start_cursor (stmt, error);
+		g_object_unref (stmt);
+	}
+
+	if (cursor) {
+		if (tracker_db_cursor_iter_next (cursor, NULL, error)) {
+			count = tracker_db_cursor_get_int (cursor, 0);
+		}
+
+		g_object_unref (cursor);
+	}
+
+	return count;
+}
+
+static gboolean
+class_has_table (TrackerClass *class)
+{
+	/* xsd classes do not derive from rdfs:Resource and do not use separate tables */
+	return !g_str_has_prefix (tracker_class_get_name (class), "xsd:");
+}
+
+/**
+ * tracker_data_class_counts_init:
+ * @read_only: whether the database is opened read only
+ * @error: return location for errors
+ *
+ * Loads the instance counts of classes kept in the database. They
+ * are counted, and kept from then on, the first time. In read only
+ * mode, counts are only loaded if they were kept before.
+ **/
+void
+tracker_data_class_counts_init (gboolean   read_only,
+                                GError   **error)
+{
+	TrackerDBInterface *iface;
+	TrackerDBStatement *stmt;
+	TrackerDBCursor *cursor = NULL;
+	GError *internal_error = NULL;
+	GHashTable *classes_by_id;
+	GPtrArray *changed;
+	TrackerClass **classes;
+	guint i, n_classes;
+	gint n_loaded = 0;
+
+	iface = tracker_db_manager_get_db_interface ();
+
+	if (!read_only) {
+		tracker_db_interface_execute_query (iface, &internal_error,
+		                                    "CREATE TABLE IF NOT EXISTS ClassCounts ("
+		                                    "Class INTEGER NOT NULL PRIMARY KEY, "
+		                                    "Count INTEGER NOT NULL)");
+
+		if (internal_error) {
+			g_propagate_error (error, internal_error);
+			return;
+		}
+	}
+
+	classes = tracker_ontologies_get_classes (&n_classes);
+	classes_by_id = g_hash_table_new (g_direct_hash, g_direct_equal);
+	changed = g_ptr_array_new ();
+
+	for (i = 0; i < n_classes; i++) {
+		g_hash_table_insert (classes_by_id,
+		                     GINT_TO_POINTER (tracker_class_get_id (classes[i])),
+		                     classes[i]);
+	}
+
+	stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_NONE, &internal_error,
+	                                              "SELECT Class, Count FROM ClassCounts");
+
+	if (stmt) {
+		cursor = tracker_db_statement_start_cursor (stmt, &internal_error);
+		g_object_unref (stmt);
+	}
+
+	if (cursor) {
+		while (tracker_db_cursor_iter_next (cursor, NULL, &internal_error)) {
+			TrackerClass *class;
+
+			class = g_hash_table_lookup (classes_by_id,
+			                             GINT_TO_POINTER (tracker_db_cursor_get_int (cursor, 0)));
+
+			/* Ontology changes since startup are already counted */
+			if (class && tracker_class_get_count (class) != 0) {
+				g_ptr_array_add (changed, class);
+			}
+
+			if (class) {
+				tracker_class_set_count (class,
+				                         tracker_class_get_count (class) +
+				                         tracker_db_cursor_get_int (cursor, 1));
+			}
+
+			n_loaded++;
+		}
+
+		g_object_unref (cursor);
+	}
+
+	g_hash_table_unref (classes_by_id);
+
+	if (read_only) {
+		/* If counts weren't kept, counting is left to the caller */
+		g_clear_error (&internal_error);
+		g_ptr_array_unref (changed);
+		class_counts_loaded = (n_loaded > 0);
+		return;
+	}
+
+	if (!internal_error && n_loaded == 0) {
+		g_message ("Counting class instances, this happens only once...");
+
+		tracker_db_interface_start_transaction (iface);
+
+		for (i = 0; i < n_classes && !internal_error; i++) {
+			gint count;
+
+			if (!class_has_table (classes[i])) {
+				continue;
+			}
+
+			count = class_counts_count_instances (classes[i], &internal_error);
+
+			if (!internal_error) {
+				tracker_class_set_count (classes[i], count);
+				class_counts_write (classes[i], &internal_error);
+			}
+		}
+
+		if (internal_error) {
+			tracker_db_interface_execute_query (iface, NULL, "ROLLBACK");
+		} else {
+			tracker_db_interface_end_db_transaction (iface, &internal_error);
+		}
+	}
+
+	if (!internal_error && n_loaded > 0) {
+		for (i = 0; i < changed->len && !internal_error; i++) {
+			class_counts_write (g_ptr_array_index (changed, i), &internal_error);
+		}
+	}
+
+	g_ptr_array_unref (changed);
+
+	if (internal_error) {
+		g_propagate_error (error, internal_error);
+		return;
+	}
+
+	class_counts_enabled = TRUE;
+	class_counts_loaded = TRUE;
+}
+
+/**
+ * tracker_data_class_counts_loaded:
+ *
+ * Returns: %TRUE if the instance counts of classes are up to date,
+ * %FALSE if they were never kept in a database opened read only.
+ **/
+gboolean
+tracker_data_class_counts_loaded (void)
+{
+	return class_counts_loaded;
+}
+
+/**
+ * tracker_data_class_counts_verify:
+ * @class: a #TrackerClass
+ * @error: return location for errors
+ *
+ * Counts the instances of @class in its table, and fixes the kept
+ * count if it was wrong. Must not be called inside a transaction.
+ *
+ * Returns: %TRUE if the kept count was right.
+ **/
+gboolean
+tracker_data_class_counts_verify (TrackerClass  *class,
+                                  GError       **error)
+{
+	GError *internal_error = NULL;
+	gint count;
+
+	g_return_val_if_fail (TRACKER_IS_CLASS (class), FALSE);
+	g_return_val_if_fail (!in_transaction, FALSE);
+
+	if (!class_has_table (class)) {
+		return TRUE;
+	}
+
+	count = class_counts_count_instances (class, &internal_error);
+
+	if (internal_error) {
+		g_propagate_error (error, internal_error);
+		return FALSE;
+	}
+
+	if (count == tracker_class_get_count (class)) {
+		return TRUE;
+	}
+
+	g_warning ("Instance count of class %s was %d instead of %d, fixed",
+	           tracker_class_get_name (class),
+	           tracker_class_get_count (class), count);
+
+	tracker_class_set_count (class, count);
+
+	if (class_counts_enabled) {
+		class_counts_write (class, &internal_error);
+
+		if (internal_error) {
+			g_propagate_error (error, internal_error);
+		}
+	}
+
+	return FALSE;
+}
+
 static TrackerDataUpdateBufferTable *
 cache_table_new (gboolean multiple_values)
 {
@@ -706,26 +1313,179 @@ statement_bind_gvalue (TrackerDBStatement *stmt,
 		} else {
 			g_warning ("Unknown type for binding: %s\n", G_VALUE_TYPE_NAME (value));
 		}
-		break;
+		break;
+	}
+}
+
+static void
+add_class_count (TrackerClass *class,
+                 gint          count)
+{
+	gint old_count_entry;
+
+	tracker_class_set_count (class, tracker_class_get_count (class) + count);
+
+	/* update class_counts table so that the count change can be reverted in case of rollback */
+	if (!update_buffer.class_counts) {
+		update_buffer.class_counts = g_hash_table_new (g_direct_hash, g_direct_equal);
+	}
+
+	old_count_entry = GPOINTER_TO_INT (g_hash_table_lookup (update_buffer.class_counts, class));
+	g_hash_table_insert (update_buffer.class_counts, class,
+	                     GINT_TO_POINTER (old_count_entry + count));
+
+	if (in_savepoint) {
+		if (!update_buffer.savepoint_class_counts) {
+			update_buffer.savepoint_class_counts = g_hash_table_new (g_direct_hash, g_direct_equal);
+		}
+
+		old_count_entry = GPOINTER_TO_INT (g_hash_table_lookup (update_buffer.savepoint_class_counts, class));
+		g_hash_table_insert (update_buffer.savepoint_class_counts, class,
+		                     GINT_TO_POINTER (old_count_entry + count));
+	}
+}
+
+#if HAVE_TRACKER_FTS
+static gchar *
+fts_text_from_values (GArray *values)
+{
+	GString *fts;
+	guint i;
+
+	fts = g_string_new ("");
+
+	/* Same text fts_view gives back when the row is deleted */
+	for (i = 0; i < values->len; i++) {
+		GValue *v = &g_array_index (values, GValue, i);
+
+		if (i > 0) {
+			g_string_append_c (fts, ',');
+		}
+
+		g_string_append (fts, g_value_get_string (v));
+	}
+
+	return g_string_free (fts, FALSE);
+}
+
+static void
+fts_buffer_free (TrackerDataUpdateBufferFts *fts)
+{
+	g_ptr_array_free (fts->properties, TRUE);
+	g_ptr_array_free (fts->text, TRUE);
+	g_slice_free (TrackerDataUpdateBufferFts, fts);
+}
+
+static void
+tracker_data_resource_buffer_fts_flush (TrackerDBInterface *iface)
+{
+	TrackerDataUpdateBufferFts *fts;
+	TrackerProperty *prop;
+	GHashTableIter iter;
+	GArray *values;
+	gboolean changed = resource_buffer->create;
+
+	fts = g_slice_new (TrackerDataUpdateBufferFts);
+	fts->id = resource_buffer->id;
+	fts->properties = g_ptr_array_new ();
+	fts->text = g_ptr_array_new_with_free_func ((GDestroyNotify) g_free);
+
+	g_hash_table_iter_init (&iter, resource_buffer->predicates);
+	while (g_hash_table_iter_next (&iter, (gpointer*) &prop, (gpointer*) &values)) {
+		const gchar *old_text = NULL;
+		gchar *text;
+
+		if (!tracker_property_get_fulltext_indexed (prop)) {
+			continue;
+		}
+
+		text = fts_text_from_values (values);
+
+		if (resource_buffer->fts_old_text) {
+			old_text = g_hash_table_lookup (resource_buffer->fts_old_text, prop);
+		}
+
+		if (g_strcmp0 (old_text ? old_text : "", text) != 0) {
+			changed = TRUE;
+		}
+
+		g_ptr_array_add (fts->properties, (gpointer) tracker_property_get_name (prop));
+		g_ptr_array_add (fts->text, text);
+	}
+
+	g_ptr_array_add (fts->properties, NULL);
+	g_ptr_array_add (fts->text, NULL);
+
+	if (!resource_buffer->create &&
+	    !g_hash_table_lookup (update_buffer.fts_pending, GINT_TO_POINTER (fts->id))) {
+		if (!changed) {
+			/* Indexed text is the same, avoid tokenizing it all again */
+			fts_buffer_free (fts);
+			return;
+		}
+
+		/* Terms of the old row must be removed before the property
+		 * tables are modified, as FTS reads them back from fts_view.
+		 * Rows still pending insertion were never indexed.
+		 */
+		tracker_db_interface_sqlite_fts_delete_id (iface, fts->id);
 	}
+
+	g_hash_table_insert (update_buffer.fts_pending, GINT_TO_POINTER (fts->id), fts);
+	update_buffer.fts_ever_updated = TRUE;
 }
 
-static void
-add_class_count (TrackerClass *class,
-                 gint          count)
+static gint
+fts_buffer_compare (gconstpointer a,
+                    gconstpointer b)
 {
-	gint old_count_entry;
+	const TrackerDataUpdateBufferFts *fts_a = *(TrackerDataUpdateBufferFts **) a;
+	const TrackerDataUpdateBufferFts *fts_b = *(TrackerDataUpdateBufferFts **) b;
 
-	tracker_class_set_count (class, tracker_class_get_count (class) + count);
+	return fts_a->id - fts_b->id;
+}
+#endif
 
-	/* update class_counts table so that the count change can be reverted in case of rollback */
-	if (!update_buffer.class_counts) {
-		update_buffer.class_counts = g_hash_table_new (g_direct_hash, g_direct_equal);
+void
+tracker_data_update_buffer_fts_flush (void)
+{
+#if HAVE_TRACKER_FTS
+	TrackerDBInterface *iface;
+	TrackerDataUpdateBufferFts *fts;
+	GHashTableIter iter;
+	GPtrArray *pending;
+	guint i;
+
+	if (!update_buffer.fts_pending ||
+	    g_hash_table_size (update_buffer.fts_pending) == 0) {
+		return;
 	}
 
-	old_count_entry = GPOINTER_TO_INT (g_hash_table_lookup (update_buffer.class_counts, class));
-	g_hash_table_insert (update_buffer.class_counts, class,
-	                     GINT_TO_POINTER (old_count_entry + count));
+	pending = g_ptr_array_sized_new (g_hash_table_size (update_buffer.fts_pending));
+
+	g_hash_table_iter_init (&iter, update_buffer.fts_pending);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer*) &fts)) {
+		g_ptr_array_add (pending, fts);
+	}
+
+	/* FTS flushes its pending terms to a new segment whenever
+	 * docids do not come in increasing order, so sort them.
+	 */
+	g_ptr_array_sort (pending, fts_buffer_compare);
+
+	iface = tracker_db_manager_get_db_interface ();
+
+	for (i = 0; i < pending->len; i++) {
+		fts = g_ptr_array_index (pending, i);
+		tracker_db_interface_sqlite_fts_update_text (iface,
+		                                             fts->id,
+		                                             (const gchar **) fts->properties->pdata,
+		                                             (const gchar **) fts->text->pdata);
+	}
+
+	g_ptr_array_free (pending, TRUE);
+	g_hash_table_remove_all (update_buffer.fts_pending);
+#endif
 }
 
 static void
@@ -742,6 +1502,12 @@ tracker_data_resource_buffer_flush (GError **error)
 
 	iface = tracker_db_manager_get_db_interface ();
 
+#if HAVE_TRACKER_FTS
+	if (resource_buffer->fts_updated) {
+		tracker_data_resource_buffer_fts_flush (iface);
+	}
+#endif
+
 	g_hash_table_iter_init (&iter, resource_buffer->tables);
 	while (g_hash_table_iter_next (&iter, (gpointer*) &table_name, (gpointer*) &table)) {
 		if (table->multiple_values) {
@@ -956,52 +1722,6 @@ tracker_data_resource_buffer_flush (GError **error)
 			}
 		}
 	}
-
-#if HAVE_TRACKER_FTS
-	if (resource_buffer->fts_updated) {
-		TrackerProperty *prop;
-		GArray *values;
-		gboolean create = resource_buffer->create;
-		GPtrArray *properties, *text;
-
-		properties = text = NULL;
-		g_hash_table_iter_init (&iter, resource_buffer->predicates);
-		while (g_hash_table_iter_next (&iter, (gpointer*) &prop, (gpointer*) &values)) {
-			if (tracker_property_get_fulltext_indexed (prop)) {
-				GString *fts;
-
-				fts = g_string_new ("");
-				for (i = 0; i < values->len; i++) {
-					GValue *v = &g_array_index (values, GValue, i);
-					g_string_append (fts, g_value_get_string (v));
-					g_string_append_c (fts, ' ');
-				}
-
-				if (!properties && !text) {
-					properties = g_ptr_array_new ();
-					text = g_ptr_array_new_with_free_func ((GDestroyNotify) g_free);
-				}
-
-				g_ptr_array_add (properties, (gpointer) tracker_property_get_name (prop));
-				g_ptr_array_add (text, g_string_free (fts, FALSE));
-			}
-		}
-
-		if (properties && text) {
-			g_ptr_array_add (properties, NULL);
-			g_ptr_array_add (text, NULL);
-
-			tracker_db_interface_sqlite_fts_update_text (iface,
-			                                             resource_buffer->id,
-			                                             (gchar **) properties->pdata,
-			                                             (gchar **) text->pdata,
-			                                             create);
-			update_buffer.fts_ever_updated = TRUE;
-			g_ptr_array_free (properties, TRUE);
-			g_ptr_array_free (text, TRUE);
-		}
-	}
-#endif
 }
 
 static void resource_buffer_free (TrackerDataUpdateBufferResource *resource)
@@ -1013,6 +1733,12 @@ static void resource_buffer_free (TrackerDataUpdateBufferResource *resource)
 	g_ptr_array_free (resource->types, TRUE);
 	resource->types = NULL;
 
+#if HAVE_TRACKER_FTS
+	if (resource->fts_old_text) {
+		g_hash_table_unref (resource->fts_old_text);
+	}
+#endif
+
 	g_slice_free (TrackerDataUpdateBufferResource, resource);
 }
 
@@ -1046,6 +1772,14 @@ tracker_data_update_buffer_flush (GError **error)
 		g_hash_table_remove_all (update_buffer.resources);
 	}
 	resource_buffer = NULL;
+
+#if HAVE_TRACKER_FTS
+	/* avoid high memory usage by FTS rows pending insertion */
+	if (update_buffer.fts_pending &&
+	    g_hash_table_size (update_buffer.fts_pending) >= 1000) {
+		tracker_data_update_buffer_fts_flush ();
+	}
+#endif
 }
 
 void
@@ -1068,6 +1802,7 @@ tracker_data_update_buffer_clear (void)
 
 #if HAVE_TRACKER_FTS
 	update_buffer.fts_ever_updated = FALSE;
+	g_hash_table_remove_all (update_buffer.fts_pending);
 #endif
 
 	if (update_buffer.class_counts) {
@@ -1458,41 +2193,32 @@ get_old_property_values (TrackerProperty  *property,
 
 #if HAVE_TRACKER_FTS
 		if (tracker_property_get_fulltext_indexed (property)) {
-			TrackerDBInterface *iface;
-
-			iface = tracker_db_manager_get_db_interface ();
-
 			if (!resource_buffer->fts_updated && !resource_buffer->create) {
 				guint i, n_props;
 				TrackerProperty   **properties, *prop;
 
 				/* first fulltext indexed property to be modified
-				 * retrieve values of all fulltext indexed properties
+				 * retrieve values of all fulltext indexed properties,
+				 * the indexed text is compared with these on flush
 				 */
 				properties = tracker_ontologies_get_properties (&n_props);
 
+				if (!resource_buffer->fts_old_text) {
+					resource_buffer->fts_old_text = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+					                                                       NULL, g_free);
+				}
+
 				for (i = 0; i < n_props; i++) {
 					prop = properties[i];
 
 					if (tracker_property_get_fulltext_indexed (prop)
 					    && check_property_domain (prop)) {
-						const gchar *property_name;
-						gint i;
-
 						old_values = get_property_values (prop);
-						property_name = tracker_property_get_name (prop);
-
-						/* delete old fts entries */
-						for (i = 0; i < old_values->len; i++) {
-							tracker_db_interface_sqlite_fts_delete_text (iface,
-							                                             resource_buffer->id,
-							                                             property_name);
-						}
+						g_hash_table_insert (resource_buffer->fts_old_text, prop,
+						                     fts_text_from_values (old_values));
 					}
 				}
 
-				update_buffer.fts_ever_updated = TRUE;
-
 				old_values = g_hash_table_lookup (resource_buffer->predicates, property);
 			} else {
 				old_values = get_property_values (property);
@@ -3292,6 +4018,9 @@ tracker_data_begin_transaction (GError **error)
 		update_buffer.resources = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) resource_buffer_free);
 		/* used for journal replay */
 		update_buffer.resources_by_id = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) resource_buffer_free);
+#if HAVE_TRACKER_FTS
+		update_buffer.fts_pending = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) fts_buffer_free);
+#endif
 	}
 
 	resource_buffer = NULL;
@@ -3361,6 +4090,24 @@ tracker_data_commit_transaction (GError **error)
 		return;
 	}
 
+	tracker_data_update_buffer_fts_flush ();
+
+	if (change_log_enabled && has_persistent &&
+	    !in_ontology_transaction && !in_journal_replay &&
+	    get_transaction_modseq () % change_log_trim_interval == 0) {
+		change_log_trim ();
+	}
+
+	if (class_counts_enabled && !in_journal_replay) {
+		class_counts_flush (&actual_error);
+
+		if (actual_error) {
+			tracker_data_rollback_transaction ();
+			g_propagate_error (error, actual_error);
+			return;
+		}
+	}
+
 	tracker_db_interface_end_db_transaction (iface,
 	                                         &actual_error);
 
@@ -3532,6 +4279,294 @@ tracker_data_update_sparql_blank (const gchar  *update,
 	return update_sparql (update, TRUE, error);
 }
 
+static void
+apply_statements (GVariant  *statements,
+                  GError   **error)
+{
+	GError *actual_error = NULL;
+	GVariantIter iter;
+	const gchar *graph, *subject, *predicate, *object;
+	guchar operation;
+
+	g_variant_iter_init (&iter, statements);
+
+	while (g_variant_iter_next (&iter, "(ym&s&s&sm&s)",
+	                            &operation, &graph, &subject,
+	                            &predicate, &object)) {
+		switch (operation) {
+		case TRACKER_DATA_STATEMENT_INSERT:
+		case TRACKER_DATA_STATEMENT_DELETE:
+			if (object == NULL) {
+				g_set_error (&actual_error, TRACKER_SPARQL_ERROR, TRACKER_SPARQL_ERROR_PARSE,
+				             "Missing object for '%s' of '%s'", predicate, subject);
+			} else if (operation == TRACKER_DATA_STATEMENT_INSERT) {
+				tracker_data_insert_statement (graph, subject, predicate, object, &actual_error);
+			} else {
+				tracker_data_delete_statement (graph, subject, predicate, object, &actual_error);
+			}
+			break;
+		case TRACKER_DATA_STATEMENT_UPDATE:
+			/* A missing object deletes all values */
+			tracker_data_update_statement (graph, subject, predicate, object, &actual_error);
+			break;
+		default:
+			g_set_error (&actual_error, TRACKER_SPARQL_ERROR, TRACKER_SPARQL_ERROR_PARSE,
+			             "Unknown statement operation %d", operation);
+			break;
+		}
+
+		if (!actual_error) {
+			tracker_data_update_buffer_might_flush (&actual_error);
+		}
+
+		if (actual_error) {
+			g_propagate_error (error, actual_error);
+			return;
+		}
+	}
+}
+
+/**
+ * tracker_data_update_statements:
+ * @statements: a #GVariant of type %TRACKER_DATA_STATEMENTS_TYPE
+ * @error: return location for errors
+ *
+ * Applies @statements in a single transaction, the same way
+ * a SPARQL update inserting or deleting them would, but
+ * without generating and parsing SPARQL in between.
+ **/
+void
+tracker_data_update_statements (GVariant  *statements,
+                                GError   **error)
+{
+	GError *actual_error = NULL;
+
+	g_return_if_fail (statements != NULL);
+
+	if (!g_variant_is_of_type (statements, TRACKER_DATA_STATEMENTS_TYPE)) {
+		g_set_error (error, TRACKER_SPARQL_ERROR, TRACKER_SPARQL_ERROR_PARSE,
+		             "Unexpected statements of type '%s'",
+		             g_variant_get_type_string (statements));
+		return;
+	}
+
+	tracker_data_begin_transaction (&actual_error);
+	if (actual_error) {
+		g_propagate_error (error, actual_error);
+		return;
+	}
+
+	apply_statements (statements, &actual_error);
+
+	if (actual_error) {
+		tracker_data_rollback_transaction ();
+		g_propagate_error (error, actual_error);
+		return;
+	}
+
+	tracker_data_commit_transaction (error);
+}
+
+static void
+notify_savepoint (gboolean rolled_back)
+{
+	if (savepoint_callbacks) {
+		guint n;
+		for (n = 0; n < savepoint_callbacks->len; n++) {
+			TrackerSavepointDelegate *delegate;
+			delegate = g_ptr_array_index (savepoint_callbacks, n);
+			delegate->callback (rolled_back, delegate->user_data);
+		}
+	}
+}
+
+static void
+savepoint_begin (TrackerDBInterface  *iface,
+                 GError             **error)
+{
+	GError *actual_error = NULL;
+
+	/* The update buffer is flushed at every savepoint
+	 * boundary, so only SQLite, the journal block and the
+	 * class counts hold changes that may need undoing */
+	tracker_db_interface_execute_query (iface, &actual_error, "SAVEPOINT update_array");
+
+	if (actual_error) {
+		g_propagate_error (error, actual_error);
+		return;
+	}
+
+#ifndef DISABLE_JOURNAL
+	tracker_db_journal_set_savepoint ();
+#endif /* DISABLE_JOURNAL */
+
+	in_savepoint = TRUE;
+}
+
+static void
+savepoint_release (TrackerDBInterface *iface)
+{
+	in_savepoint = FALSE;
+
+	if (update_buffer.savepoint_class_counts) {
+		g_hash_table_remove_all (update_buffer.savepoint_class_counts);
+	}
+
+	tracker_db_interface_execute_query (iface, NULL, "RELEASE update_array");
+
+	notify_savepoint (FALSE);
+}
+
+static void
+savepoint_rollback (TrackerDBInterface *iface,
+                    gboolean            had_persistent)
+{
+	GError *ignorable = NULL;
+
+	in_savepoint = FALSE;
+
+	g_hash_table_remove_all (update_buffer.resources);
+	g_hash_table_remove_all (update_buffer.resources_by_id);
+	/* Resource IDs created inside the savepoint are gone */
+	g_hash_table_remove_all (update_buffer.resource_cache);
+	resource_buffer = NULL;
+
+#if HAVE_TRACKER_FTS
+	g_hash_table_remove_all (update_buffer.fts_pending);
+#endif
+
+	if (update_buffer.savepoint_class_counts) {
+		GHashTableIter iter;
+		TrackerClass *class;
+		gpointer count_ptr;
+
+		g_hash_table_iter_init (&iter, update_buffer.savepoint_class_counts);
+		while (g_hash_table_iter_next (&iter, (gpointer*) &class, &count_ptr)) {
+			gint count, old_count_entry;
+
+			count = GPOINTER_TO_INT (count_ptr);
+			tracker_class_set_count (class, tracker_class_get_count (class) - count);
+
+			old_count_entry = GPOINTER_TO_INT (g_hash_table_lookup (update_buffer.class_counts, class));
+			g_hash_table_insert (update_buffer.class_counts, class,
+			                     GINT_TO_POINTER (old_count_entry - count));
+		}
+
+		g_hash_table_remove_all (update_buffer.savepoint_class_counts);
+	}
+
+	/* ROLLBACK TO keeps the savepoint open */
+	tracker_db_interface_execute_query (iface, &ignorable, "ROLLBACK TO update_array");
+
+	if (ignorable) {
+		g_error_free (ignorable);
+		ignorable = NULL;
+	}
+
+	tracker_db_interface_execute_query (iface, &ignorable, "RELEASE update_array");
+
+	if (ignorable) {
+		g_error_free (ignorable);
+	}
+
+#ifndef DISABLE_JOURNAL
+	tracker_db_journal_rollback_to_savepoint ();
+#endif /* DISABLE_JOURNAL */
+
+	has_persistent = had_persistent;
+
+	notify_savepoint (TRUE);
+}
+
+static void
+error_free0 (GError *error)
+{
+	if (error) {
+		g_error_free (error);
+	}
+}
+
+/**
+ * tracker_data_update_array:
+ * @updates: SPARQL updates
+ * @n_updates: length of @updates
+ * @error: return location for errors
+ *
+ * Runs all @updates in a single transaction, each of them in its
+ * own savepoint, so an update failing only rolls back its own
+ * changes.
+ *
+ * Returns: an array of @n_updates #GError, %NULL where the update
+ *          succeeded, or %NULL if the transaction as a whole failed.
+ **/
+GPtrArray *
+tracker_data_update_array (const gchar **updates,
+                           gint          n_updates,
+                           GError      **error)
+{
+	TrackerDBInterface *iface;
+	GError *actual_error = NULL;
+	GPtrArray *errors;
+	gint i;
+
+	g_return_val_if_fail (updates != NULL || n_updates == 0, NULL);
+
+	tracker_data_begin_transaction (&actual_error);
+	if (actual_error) {
+		g_propagate_error (error, actual_error);
+		return NULL;
+	}
+
+	iface = tracker_db_manager_get_db_interface ();
+	errors = g_ptr_array_new_with_free_func ((GDestroyNotify) error_free0);
+
+	for (i = 0; i < n_updates; i++) {
+		TrackerSparqlQuery *sparql_query;
+		gboolean had_persistent;
+
+		had_persistent = has_persistent;
+
+		savepoint_begin (iface, &actual_error);
+		if (actual_error) {
+			/* Nothing to roll back to, give up on the whole batch */
+			tracker_data_rollback_transaction ();
+			g_propagate_error (error, actual_error);
+			g_ptr_array_unref (errors);
+			return NULL;
+		}
+
+		sparql_query = tracker_sparql_query_new_update (updates[i]);
+		tracker_sparql_query_execute_update (sparql_query, FALSE, &actual_error);
+		g_object_unref (sparql_query);
+
+		if (!actual_error) {
+			tracker_data_update_buffer_flush (&actual_error);
+		}
+
+		if (!actual_error) {
+			tracker_data_update_buffer_fts_flush ();
+		}
+
+		if (actual_error) {
+			savepoint_rollback (iface, had_persistent);
+			g_ptr_array_add (errors, actual_error);
+			actual_error = NULL;
+		} else {
+			savepoint_release (iface);
+			g_ptr_array_add (errors, NULL);
+		}
+	}
+
+	tracker_data_commit_transaction (&actual_error);
+	if (actual_error) {
+		g_propagate_error (error, actual_error);
+		g_ptr_array_unref (errors);
+		return NULL;
+	}
+
+	return errors;
+}
+
 void
 tracker_data_load_turtle_file (GFile   *file,
                                GError **error)
@@ -26,6 +26,7 @@
 
 #include <libtracker-common/tracker-ontologies.h>
 
+#include "tracker-class.h"
 #include "tracker-db-interface.h"
 
 G_BEGIN_DECLS
@@ -40,6 +41,17 @@ typedef enum {
 	TRACKER_DATA_COMMIT_BATCH_LAST
 } TrackerDataCommitType;
 
+/* Statement operations of tracker_data_update_statements(),
+ * kept in sync with TrackerSparqlStatementsOperation */
+typedef enum {
+	TRACKER_DATA_STATEMENT_INSERT,
+	TRACKER_DATA_STATEMENT_DELETE,
+	TRACKER_DATA_STATEMENT_UPDATE
+} TrackerDataStatementOperation;
+
+/* operation, graph, subject, predicate, object */
+#define TRACKER_DATA_STATEMENTS_TYPE G_VARIANT_TYPE ("a(ymsssms)")
+
 typedef void (*TrackerStatementCallback) (gint                  graph_id,
                                           const gchar          *graph,
                                           gint                  subject_id,
@@ -51,6 +63,8 @@ typedef void (*TrackerStatementCallback) (gint                  graph_id,
                                           gpointer              user_data);
 typedef void (*TrackerCommitCallback)    (TrackerDataCommitType commit_type,
                                           gpointer              user_data);
+typedef void (*TrackerSavepointCallback) (gboolean              rolled_back,
+                                          gpointer              user_data);
 
 GQuark   tracker_data_error_quark                   (void);
 
@@ -92,8 +106,15 @@ void     tracker_data_update_sparql                 (const gchar               *
 GVariant *
          tracker_data_update_sparql_blank           (const gchar               *update,
                                                      GError                   **error);
+GPtrArray *
+         tracker_data_update_array                  (const gchar              **updates,
+                                                     gint                       n_updates,
+                                                     GError                   **error);
+void     tracker_data_update_statements             (GVariant                  *statements,
+                                                     GError                   **error);
 void     tracker_data_update_buffer_flush           (GError                   **error);
 void     tracker_data_update_buffer_might_flush     (GError                   **error);
+void     tracker_data_update_buffer_fts_flush       (void);
 void     tracker_data_load_turtle_file              (GFile                     *file,
                                                      GError                   **error);
 
@@ -112,6 +133,8 @@ void     tracker_data_add_commit_statement_callback      (TrackerCommitCallback
                                                           gpointer                   user_data);
 void     tracker_data_add_rollback_statement_callback    (TrackerCommitCallback      callback,
                                                           gpointer                   user_data);
+void     tracker_data_add_savepoint_callback             (TrackerSavepointCallback   callback,
+                                                          gpointer                   user_data);
 void     tracker_data_remove_insert_statement_callback   (TrackerStatementCallback   callback,
                                                           gpointer                   user_data);
 void     tracker_data_remove_delete_statement_callback   (TrackerStatementCallback   callback,
@@ -120,6 +143,15 @@ void     tracker_data_remove_commit_statement_callback   (TrackerCommitCallback
                                                           gpointer                   user_data);
 void     tracker_data_remove_rollback_statement_callback (TrackerCommitCallback      callback,
                                                           gpointer                   user_data);
+void     tracker_data_remove_savepoint_callback          (TrackerSavepointCallback   callback,
+                                                          gpointer                   user_data);
+
+void     tracker_data_change_log_init                 (GError                   **error);
+void     tracker_data_class_counts_init               (gboolean                   read_only,
+                                                       GError                   **error);
+gboolean tracker_data_class_counts_loaded             (void);
+gboolean tracker_data_class_counts_verify             (TrackerClass              *class,
+                                                       GError                   **error);
 
 void     tracker_data_update_shutdown                 (void);
 #define  tracker_data_update_init                     tracker_data_update_shutdown
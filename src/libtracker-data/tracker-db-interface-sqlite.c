@@ -88,8 +88,6 @@ struct TrackerDBInterface {
 	TrackerBusyCallback busy_callback;
 	gpointer busy_user_data;
 	gchar *busy_status;
-
-	gchar *fts_insert_str;
 };
 
 struct TrackerDBInterfaceClass {
@@ -1111,34 +1109,6 @@ close_database (TrackerDBInterface *db_interface)
 	}
 }
 
-static gchar **
-_fts_create_properties (GHashTable *properties)
-{
-	GHashTableIter iter;
-	GPtrArray *cols;
-	GList *columns;
-	gchar *table;
-
-	if (g_hash_table_size (properties) == 0) {
-		return NULL;
-	}
-
-	g_hash_table_iter_init (&iter, properties);
-	cols = g_ptr_array_new ();
-
-	while (g_hash_table_iter_next (&iter, (gpointer *) &table,
-				       (gpointer *) &columns)) {
-		while (columns) {
-			g_ptr_array_add (cols, g_strdup (columns->data));
-			columns = columns->next;
-		}
-	}
-
-	g_ptr_array_add (cols, NULL);
-
-	return (gchar **) g_ptr_array_free (cols, FALSE);
-}
-
 void
 tracker_db_interface_sqlite_fts_init (TrackerDBInterface  *db_interface,
                                       GHashTable          *properties,
@@ -1146,8 +1116,6 @@ tracker_db_interface_sqlite_fts_init (TrackerDBInterface  *db_interface,
                                       gboolean             create)
 {
 #if HAVE_TRACKER_FTS
-	GStrv fts_columns;
-
 	tracker_fts_init_db (db_interface->db, properties);
 
 	if (create &&
@@ -1155,33 +1123,6 @@ tracker_db_interface_sqlite_fts_init (TrackerDBInterface  *db_interface,
 				       properties, multivalued)) {
 		g_warning ("FTS tables creation failed");
 	}
-
-	fts_columns = _fts_create_properties (properties);
-
-	if (fts_columns) {
-		GString *insert, *select;
-		gint i = 0;
-
-		insert = g_string_new ("INSERT INTO fts (docid");
-		select = g_string_new ("SELECT rowid");
-
-		while (fts_columns[i]) {
-			g_string_append_printf (insert, ", \"%s\"",
-						fts_columns[i]);
-			g_string_append_printf (select, ", \"%s\"",
-						fts_columns[i]);
-			i++;
-		}
-
-		g_string_append (select, " FROM fts_view WHERE rowid=?");
-		g_string_append (insert, ") ");
-		g_string_append (insert, select->str);
-
-		g_string_free (select, TRUE);
-		db_interface->fts_insert_str = g_string_free (insert, FALSE);
-
-		g_strfreev (fts_columns);
-	}
 #endif
 }
 
@@ -1196,38 +1137,41 @@ tracker_db_interface_sqlite_fts_alter_table (TrackerDBInterface  *db_interface,
 	}
 }
 
+gboolean
+tracker_db_interface_sqlite_fts_is_outdated (TrackerDBInterface *db_interface)
+{
+	return tracker_fts_table_is_outdated (db_interface->db, "fts");
+}
+
 gboolean
 tracker_db_interface_sqlite_fts_update_text (TrackerDBInterface  *db_interface,
                                              int                  id,
                                              const gchar        **properties,
-                                             const char         **text,
-                                             gboolean             create)
+                                             const char         **text)
 {
 	TrackerDBStatement *stmt;
 	GError *error = NULL;
+	GString *insert, *values;
+	gint i;
 
-	if (!create) {
-		stmt = tracker_db_interface_create_statement (db_interface,
-							      TRACKER_DB_STATEMENT_CACHE_TYPE_UPDATE,
-							      &error,
-							      "DELETE FROM fts WHERE docid=?");
-		tracker_db_statement_bind_int (stmt, 0, id);
-
-		tracker_db_statement_execute (stmt, &error);
-		g_object_unref (stmt);
+	/* Text is bound directly, so the group_concat() of the
+	 * fts_view is not involved when (re)indexing a document.
+	 */
+	insert = g_string_new ("INSERT INTO fts (docid");
+	values = g_string_new ("VALUES (?");
 
-		if (error) {
-			g_warning ("Could not update FTS text: %s", error->message);
-			g_error_free (error);
-			return FALSE;
-		}
+	for (i = 0; properties[i] != NULL; i++) {
+		g_string_append_printf (insert, ", \"%s\"", properties[i]);
+		g_string_append (values, ", ?");
 	}
 
 	stmt = tracker_db_interface_create_statement (db_interface,
 	                                              TRACKER_DB_STATEMENT_CACHE_TYPE_UPDATE,
 	                                              &error,
-	                                              "%s",
-	                                              db_interface->fts_insert_str);
+	                                              "%s) %s)",
+	                                              insert->str, values->str);
+	g_string_free (insert, TRUE);
+	g_string_free (values, TRUE);
 
 	if (!stmt || error) {
 		if (error) {
@@ -1239,6 +1183,11 @@ tracker_db_interface_sqlite_fts_update_text (TrackerDBInterface  *db_interface,
 	}
 
 	tracker_db_statement_bind_int (stmt, 0, id);
+
+	for (i = 0; text[i] != NULL; i++) {
+		tracker_db_statement_bind_text (stmt, i + 1, text[i]);
+	}
+
 	tracker_db_statement_execute (stmt, &error);
 	g_object_unref (stmt);
 
@@ -1252,22 +1201,24 @@ tracker_db_interface_sqlite_fts_update_text (TrackerDBInterface  *db_interface,
 }
 
 gboolean
-tracker_db_interface_sqlite_fts_delete_text (TrackerDBInterface *db_interface,
-                                             int                 id,
-					     const gchar        *property)
+tracker_db_interface_sqlite_fts_delete_id (TrackerDBInterface *db_interface,
+                                           int                 id)
 {
 	TrackerDBStatement *stmt;
 	GError *error = NULL;
 
+	/* FTS reads the indexed text back through fts_view in order
+	 * to remove its terms, so this must be called before the
+	 * property tables are modified.
+	 */
 	stmt = tracker_db_interface_create_statement (db_interface,
 	                                              TRACKER_DB_STATEMENT_CACHE_TYPE_UPDATE,
 	                                              &error,
-	                                              "UPDATE fts SET \"%s\" = '' WHERE docid = ?",
-	                                              property);
+	                                              "DELETE FROM fts WHERE docid = ?");
 
 	if (!stmt || error) {
 		if (error) {
-			g_warning ("Could not create FTS update statement: %s\n",
+			g_warning ("Could not create FTS delete statement: %s\n",
 			           error->message);
 			g_error_free (error);
 		}
@@ -1279,7 +1230,7 @@ tracker_db_interface_sqlite_fts_delete_text (TrackerDBInterface *db_interface,
 	g_object_unref (stmt);
 
 	if (error) {
-		g_warning ("Could not execute FTS update: %s", error->message);
+		g_warning ("Could not delete FTS text: %s", error->message);
 		g_error_free (error);
 		return FALSE;
 	}
@@ -1289,6 +1240,18 @@ tracker_db_interface_sqlite_fts_delete_text (TrackerDBInterface *db_interface,
 
 #endif
 
+gboolean
+tracker_db_interface_sqlite_fts_merge (TrackerDBInterface *db_interface,
+                                       gint                n_pages,
+                                       gint                min_segments)
+{
+#if HAVE_TRACKER_FTS
+	return tracker_fts_merge (db_interface->db, "fts", n_pages, min_segments);
+#else
+	return FALSE;
+#endif
+}
+
 void
 tracker_db_interface_sqlite_reset_collator (TrackerDBInterface *db_interface)
 {
@@ -1334,7 +1297,6 @@ tracker_db_interface_sqlite_finalize (GObject *object)
 	db_interface = TRACKER_DB_INTERFACE (object);
 
 	close_database (db_interface);
-	g_free (db_interface->fts_insert_str);
 
 	g_message ("Closed sqlite3 database:'%s'", db_interface->filename);
 
@@ -47,20 +47,21 @@ void                tracker_db_interface_sqlite_fts_init               (TrackerD
 void                tracker_db_interface_sqlite_reset_collator         (TrackerDBInterface       *interface);
 void                tracker_db_interface_sqlite_wal_hook               (TrackerDBInterface       *interface,
                                                                         TrackerDBWalCallback      callback);
+gboolean            tracker_db_interface_sqlite_fts_merge              (TrackerDBInterface       *interface,
+                                                                        gint                      n_pages,
+                                                                        gint                      min_segments);
 
 #if HAVE_TRACKER_FTS
 void                tracker_db_interface_sqlite_fts_alter_table        (TrackerDBInterface       *interface,
                                                                         GHashTable               *properties,
                                                                         GHashTable               *multivalued);
-int                 tracker_db_interface_sqlite_fts_update_text        (TrackerDBInterface       *interface,
+gboolean            tracker_db_interface_sqlite_fts_is_outdated        (TrackerDBInterface       *interface);
+gboolean            tracker_db_interface_sqlite_fts_update_text        (TrackerDBInterface       *interface,
                                                                         int                       id,
                                                                         const gchar             **properties,
-                                                                        const char              **text,
-                                                                        gboolean                  create);
-
-gboolean            tracker_db_interface_sqlite_fts_delete_text        (TrackerDBInterface       *db_interface,
-									int                       id,
-									const gchar              *property);
+                                                                        const char              **text);
+gboolean            tracker_db_interface_sqlite_fts_delete_id          (TrackerDBInterface       *interface,
+                                                                        int                       id);
 void                tracker_db_interface_sqlite_fts_update_commit      (TrackerDBInterface       *interface);
 void                tracker_db_interface_sqlite_fts_update_rollback    (TrackerDBInterface       *interface);
 #endif
@@ -120,6 +120,13 @@ static JournalWriter ontology_writer = {0};
 
 static TransactionFormat current_transaction_format;
 
+/* Position in the data writer's block to go back to when
+ * only part of a transaction is rolled back */
+static struct {
+	guint cur_block_len;
+	guint cur_entry_amount;
+} savepoint;
+
 static gboolean tracker_db_journal_rotate (GError **error);
 
 static gboolean
@@ -1129,6 +1136,28 @@ tracker_db_journal_rollback_transaction (GError **error)
 	return TRUE;
 }
 
+void
+tracker_db_journal_set_savepoint (void)
+{
+	g_return_if_fail (current_transaction_format == TRANSACTION_FORMAT_DATA);
+
+	savepoint.cur_block_len = writer.cur_block_len;
+	savepoint.cur_entry_amount = writer.cur_entry_amount;
+}
+
+void
+tracker_db_journal_rollback_to_savepoint (void)
+{
+	g_return_if_fail (current_transaction_format == TRANSACTION_FORMAT_DATA);
+	g_return_if_fail (savepoint.cur_block_len <= writer.cur_block_len);
+
+	/* Entries are only appended, so dropping those written
+	 * after the savepoint is a matter of moving back */
+	writer.cur_block_len = savepoint.cur_block_len;
+	writer.cur_pos = savepoint.cur_block_len;
+	writer.cur_entry_amount = savepoint.cur_entry_amount;
+}
+
 gboolean
 tracker_db_journal_truncate (gsize new_size)
 {
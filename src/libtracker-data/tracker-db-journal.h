@@ -106,6 +106,8 @@ gboolean     tracker_db_journal_append_update_statement_id   (gint         g_id,
 gboolean     tracker_db_journal_append_resource              (gint         s_id,
                                                               const gchar *uri);
 
+void         tracker_db_journal_set_savepoint                (void);
+void         tracker_db_journal_rollback_to_savepoint        (void);
 gboolean     tracker_db_journal_rollback_transaction         (GError **error);
 gboolean     tracker_db_journal_commit_db_transaction        (GError **error);
 
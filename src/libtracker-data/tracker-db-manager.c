@@ -69,6 +69,9 @@
 #define LAST_CRAWL_FILENAME           "last-crawl.txt"
 #define NEED_MTIME_CHECK_FILENAME     "no-need-mtime-check.txt"
 
+/* Directory where miners keep the state of their last crawl */
+#define CRAWL_CACHE_DIRNAME           "crawl-cache"
+
 typedef enum {
 	TRACKER_DB_LOCATION_DATA_DIR,
 	TRACKER_DB_LOCATION_USER_DATA_DIR,
@@ -151,6 +154,7 @@ static TrackerDBInterface *tracker_db_manager_get_db_interfaces     (GError
 static TrackerDBInterface *tracker_db_manager_get_db_interfaces_ro  (GError             **error,
                                                                      gint                 num, ...);
 static void                db_remove_locale_file                    (void);
+static void                db_remove_crawl_cache_files              (void);
 
 static gboolean              initialized;
 static gboolean              locations_initialized;
@@ -505,6 +509,9 @@ db_manager_remove_all (gboolean rm_journal)
 
 	/* Remove locale file also */
 	db_remove_locale_file ();
+
+	/* Crawl caches describe the store contents being removed */
+	db_remove_crawl_cache_files ();
 }
 
 static TrackerDBVersion
@@ -590,6 +597,32 @@ db_remove_locale_file (void)
 	g_free (filename);
 }
 
+static void
+db_remove_crawl_cache_files (void)
+{
+	const gchar *name;
+	gchar *dirname;
+	GDir *dir;
+
+	dirname = g_build_filename (data_dir, CRAWL_CACHE_DIRNAME, NULL);
+	dir = g_dir_open (dirname, 0, NULL);
+
+	if (dir) {
+		while ((name = g_dir_read_name (dir)) != NULL) {
+			gchar *filename;
+
+			filename = g_build_filename (dirname, name, NULL);
+			g_message ("  Removing crawl cache:'%s'", filename);
+			g_unlink (filename);
+			g_free (filename);
+		}
+
+		g_dir_close (dir);
+	}
+
+	g_free (dirname);
+}
+
 static gchar *
 db_get_locale (void)
 {
@@ -1515,6 +1548,35 @@ tracker_db_manager_get_db_interface (void)
 	return interface;
 }
 
+/**
+ * tracker_db_manager_new_ro_db_interface:
+ *
+ * Opens a new read-only connection to the database, set up like the
+ * one the manager keeps, for readers needing one connection per thread.
+ *
+ * The caller must g_object_unref the result when finished using it.
+ *
+ * returns: (caller-owns): a database connection
+ **/
+TrackerDBInterface *
+tracker_db_manager_new_ro_db_interface (GError **error)
+{
+	TrackerDBInterface *interface;
+
+	g_return_val_if_fail (initialized != FALSE, NULL);
+
+	interface = tracker_db_manager_get_db_interfaces_ro (error, 1,
+	                                                     TRACKER_DB_METADATA);
+
+	if (interface) {
+		tracker_db_interface_set_max_stmt_cache_size (interface,
+		                                              TRACKER_DB_STATEMENT_CACHE_TYPE_SELECT,
+		                                              s_cache_size);
+	}
+
+	return interface;
+}
+
 /**
  * tracker_db_manager_has_enough_space:
  *
@@ -28,6 +28,9 @@ class Tracker.Sparql.Expression : Object {
 
 	string? fts_sql;
 
+	// set when an aggregate function has been translated
+	internal bool has_aggregate;
+
 	public Expression (Query query) {
 		this.query = query;
 	}
@@ -1224,6 +1227,7 @@ class Tracker.Sparql.Expression : Object {
 			return type;
 		case SparqlTokenType.GROUP_CONCAT:
 			next ();
+			has_aggregate = true;
 			sql.append ("GROUP_CONCAT(");
 			expect (SparqlTokenType.OPEN_PARENS);
 			translate_expression_as_string (sql);
@@ -1478,6 +1482,7 @@ class Tracker.Sparql.Expression : Object {
 	}
 
 	PropertyType translate_aggregate_expression (StringBuilder sql) throws Sparql.Error {
+		has_aggregate = true;
 		expect (SparqlTokenType.OPEN_PARENS);
 		if (accept (SparqlTokenType.DISTINCT)) {
 			sql.append ("DISTINCT ");
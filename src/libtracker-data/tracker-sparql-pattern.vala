@@ -241,6 +241,21 @@ class Tracker.Sparql.Pattern : Object {
 
 	TripleContext? triple_context;
 
+	static bool is_rank_order_condition (string order_sql) {
+		// fts:rank() translates to the "<variable>_u_rank" column
+		// of the WHERE results
+		string condition = order_sql;
+		if (condition.has_suffix (" DESC")) {
+			condition = condition.substring (0, condition.length - 5);
+		} else if (condition.has_suffix (" ASC")) {
+			condition = condition.substring (0, condition.length - 4);
+		}
+
+		return (condition.has_prefix ("\"") &&
+		        condition.has_suffix ("_u_rank\"") &&
+		        condition.index_of_char ('"', 1) == condition.length - 1);
+	}
+
 	internal SelectContext translate_select (StringBuilder sql, bool subquery = false, bool scalar_subquery = false) throws Sparql.Error {
 		SelectContext result;
 
@@ -259,7 +274,9 @@ class Tracker.Sparql.Pattern : Object {
 
 		expect (SparqlTokenType.SELECT);
 
+		bool distinct = false;
 		if (accept (SparqlTokenType.DISTINCT)) {
+			distinct = true;
 			sql.append ("DISTINCT ");
 		} else if (accept (SparqlTokenType.REDUCED)) {
 		}
@@ -294,6 +311,9 @@ class Tracker.Sparql.Pattern : Object {
 		var where_bindings = (owned) query.bindings;
 		query.bindings = (owned) old_bindings;
 
+		bool old_has_aggregate = expression.has_aggregate;
+		expression.has_aggregate = false;
+
 		bool first = true;
 		if (accept (SparqlTokenType.STAR)) {
 			foreach (var variable in context.var_set.get_keys ()) {
@@ -340,6 +360,9 @@ class Tracker.Sparql.Pattern : Object {
 			}
 		}
 
+		bool aggregated = expression.has_aggregate;
+		expression.has_aggregate = old_has_aggregate || aggregated;
+
 		if (queries_fts_data && fts_subject != null) {
 			// Ensure there's a docid to match on in FTS queries
 			if (!first) {
@@ -362,12 +385,16 @@ class Tracker.Sparql.Pattern : Object {
 
 		// select from results of WHERE clause
 		sql.append (" FROM (");
+		long pattern_start = sql.len;
 		sql.append (pattern_sql.str);
+		long pattern_end = sql.len;
 		sql.append (")");
 
 		set_location (after_where);
 
+		bool grouped = false;
 		if (accept (SparqlTokenType.GROUP)) {
+			grouped = true;
 			expect (SparqlTokenType.BY);
 			sql.append (" GROUP BY ");
 			bool first_group = true;
@@ -386,17 +413,28 @@ class Tracker.Sparql.Pattern : Object {
 			}
 		}
 
+		string? rank_order = null;
 		if (accept (SparqlTokenType.ORDER)) {
 			expect (SparqlTokenType.BY);
 			sql.append (" ORDER BY ");
 			bool first_order = true;
+			int n_conditions = 0;
 			do {
 				if (first_order) {
 					first_order = false;
 				} else {
 					sql.append (", ");
 				}
-				expression.translate_order_condition (sql);
+				var order_sql = new StringBuilder ();
+				expression.translate_order_condition (order_sql);
+				sql.append (order_sql.str);
+				n_conditions++;
+
+				if (n_conditions == 1 && is_rank_order_condition (order_sql.str)) {
+					rank_order = order_sql.str;
+				} else {
+					rank_order = null;
+				}
 			} while (current () != SparqlTokenType.LIMIT && current () != SparqlTokenType.OFFSET && current () != SparqlTokenType.CLOSE_BRACE && current () != SparqlTokenType.CLOSE_PARENS && current () != SparqlTokenType.EOF);
 		}
 
@@ -419,6 +457,16 @@ class Tracker.Sparql.Pattern : Object {
 			}
 		}
 
+		if (limit >= 0 && rank_order != null && fts_subject != null && !grouped && !aggregated && !distinct) {
+			// Top-K over fts:rank: sort the bare WHERE results by rank
+			// and keep only the first LIMIT + OFFSET rows before the
+			// select expressions get evaluated, so these only run for
+			// the rows that can make it into the result.
+			var top_k = limit + int.max (offset, 0);
+			sql.insert (pattern_end, ") ORDER BY %s LIMIT %d".printf (rank_order, top_k));
+			sql.insert (pattern_start, "SELECT * FROM (");
+		}
+
 		// LIMIT and OFFSET
 		if (limit >= 0) {
 			sql.append (" LIMIT ?");
@@ -1331,6 +1379,11 @@ class Tracker.Sparql.Pattern : Object {
 					share_table = false;
 					is_fts_match = true;
 					fts_subject = context.get_variable (current_subject);
+
+					if (query.update_extensions) {
+						// FTS rows of the current transaction are only inserted on commit
+						Data.update_buffer_fts_flush ();
+					}
 				} else {
 					throw new Sparql.Error.UNKNOWN_PROPERTY ("Unknown property `%s'".printf (current_predicate));
 				}
@@ -209,7 +209,7 @@ public class Tracker.Sparql.Query : Object {
 	const string FN_NS = "http://www.w3.org/2005/xpath-functions#";
 
 	string query_string;
-	bool update_extensions;
+	internal bool update_extensions;
 
 	internal Expression expression;
 	internal Pattern pattern;
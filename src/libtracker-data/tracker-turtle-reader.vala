@@ -29,6 +29,13 @@ public class Tracker.TurtleReader : Object {
 
 	const int BUFFER_SIZE = 32;
 
+	// files are parsed in chunks of at least this size when loaded
+	const size_t CHUNK_SIZE = 1024 * 1024;
+
+	// read once from TRACKER_TURTLE_CHUNK_SIZE, which tests lower
+	// to cut small files in many chunks
+	static size_t chunk_size = 0;
+
 	struct TokenInfo {
 		public SparqlTokenType type;
 		public SourceLocation begin;
@@ -59,9 +66,14 @@ public class Tracker.TurtleReader : Object {
 	string[] predicate_stack;
 
 	int bnodeid = 0;
+	// prefix of anonymous blank node names
+	string bnode_prefix = ":";
 	// base UUID used for blank nodes
 	uchar[] base_uuid;
 
+	// line of the file the buffer starts at
+	int first_line = 1;
+
 	MappedFile? mapped_file;
 
 	public TurtleReader (string path) throws FileError {
@@ -75,10 +87,22 @@ public class Tracker.TurtleReader : Object {
 		prefix_map = new HashTable<string,string>.full (str_hash, str_equal, g_free, g_free);
 	}
 
+	// reads part of a file, prefixes defined in it are added to prefix_map
+	TurtleReader.for_chunk (char* buffer, size_t length, int first_line, uchar[] base_uuid, string bnode_prefix, HashTable<string,string> prefix_map) {
+		scanner = new SparqlScanner (buffer, length);
+
+		this.first_line = first_line;
+		this.base_uuid = base_uuid;
+		this.bnode_prefix = bnode_prefix;
+		this.prefix_map = prefix_map;
+
+		tokens = new TokenInfo[BUFFER_SIZE];
+	}
+
 	string generate_bnodeid (string? user_bnodeid) {
 		// user_bnodeid is NULL for anonymous nodes
 		if (user_bnodeid == null) {
-			return ":%d".printf (++bnodeid);
+			return "%s%d".printf (bnode_prefix, ++bnodeid);
 		} else {
 			var checksum = new Checksum (ChecksumType.SHA1);
 			// base UUID, unique per file
@@ -121,7 +145,7 @@ public class Tracker.TurtleReader : Object {
 	}
 
 	Sparql.Error get_error (string msg) {
-		return new Sparql.Error.PARSE ("%d.%d: syntax error, %s".printf (tokens[index].begin.line, tokens[index].begin.column, msg));
+		return new Sparql.Error.PARSE ("%d.%d: syntax error, %s".printf (tokens[index].begin.line + first_line - 1, tokens[index].begin.column, msg));
 	}
 
 	bool expect (SparqlTokenType type) throws Sparql.Error {
@@ -365,18 +389,288 @@ public class Tracker.TurtleReader : Object {
 		}
 	}
 
+	// Whole statements of a file, parsed into triples by a worker thread
+	class Chunk {
+		public int index;
+		public char* buffer;
+		public size_t begin;
+		public size_t length;
+		public int first_line;
+		public uchar[] base_uuid;
+
+		// prefix directives before the chunk, as offsets in buffer
+		public size_t[] directive_begins;
+		public size_t[] directive_ends;
+
+		public string[] subjects = {};
+		public string[] predicates = {};
+		public string[] objects = {};
+		public bool[] object_is_uri = {};
+		public Sparql.Error error;
+
+		Mutex mutex = Mutex ();
+		Cond cond = Cond ();
+		bool done;
+
+		public void finish () {
+			mutex.lock ();
+			done = true;
+			cond.signal ();
+			mutex.unlock ();
+		}
+
+		public void wait () {
+			mutex.lock ();
+			while (!done) {
+				cond.wait (mutex);
+			}
+			mutex.unlock ();
+		}
+	}
+
+	/* Cuts a file in chunks ending at statement boundaries. Only IRIs,
+	 * strings, comments and brackets are told apart, which is enough
+	 * to know whether a dot ends a statement, and much cheaper than
+	 * tokenizing.
+	 */
+	class Splitter {
+		char* buffer;
+		size_t length;
+		size_t pos;
+		int line = 1;
+
+		size_t[] directive_begins = {};
+		size_t[] directive_ends = {};
+
+		public Splitter (char* buffer, size_t length) {
+			this.buffer = buffer;
+			this.length = length;
+		}
+
+		public bool at_end () {
+			return pos >= length;
+		}
+
+		size_t skip_string (size_t i) {
+			char quote = buffer[i];
+
+			if (i + 2 < length && buffer[i + 1] == quote && buffer[i + 2] == quote) {
+				// long string
+				i += 3;
+				while (i < length) {
+					if (buffer[i] == '\\') {
+						i += 2;
+						continue;
+					} else if (buffer[i] == quote && i + 2 < length && buffer[i + 1] == quote && buffer[i + 2] == quote) {
+						return i + 3;
+					} else if (buffer[i] == '\n') {
+						line++;
+					}
+					i++;
+				}
+			} else {
+				i++;
+				while (i < length) {
+					if (buffer[i] == '\\') {
+						i += 2;
+						continue;
+					} else if (buffer[i] == quote) {
+						return i + 1;
+					} else if (buffer[i] == '\n') {
+						// unterminated, left to the parser to report
+						line++;
+					}
+					i++;
+				}
+			}
+
+			return length;
+		}
+
+		// returns the end of the first statement boundary at least min_length bytes ahead
+		size_t next_boundary (size_t min_length) {
+			size_t start = pos;
+			size_t i = pos;
+			size_t statement_begin = 0;
+			bool in_statement = false;
+			int depth = 0;
+
+			while (i < length) {
+				char c = buffer[i];
+
+				if (c == '\n') {
+					line++;
+					i++;
+					continue;
+				} else if (c.isspace ()) {
+					i++;
+					continue;
+				} else if (c == '#') {
+					while (i < length && buffer[i] != '\n') {
+						i++;
+					}
+					continue;
+				}
+
+				if (!in_statement) {
+					in_statement = true;
+					statement_begin = i;
+				}
+
+				if (c == '<') {
+					while (i < length && buffer[i] != '>') {
+						i++;
+					}
+				} else if (c == '"' || c == '\'') {
+					i = skip_string (i);
+					continue;
+				} else if (c == '[' || c == '(') {
+					depth++;
+				} else if (c == ']' || c == ')') {
+					depth--;
+				} else if (c == '.' && depth == 0 &&
+				           (i + 1 == length || buffer[i + 1].isspace () || buffer[i + 1] == '#')) {
+					// end of statement
+					if (buffer[statement_begin] == '@') {
+						directive_begins += statement_begin;
+						directive_ends += i + 1;
+					}
+
+					in_statement = false;
+
+					if (i + 1 - start >= min_length) {
+						return i + 1;
+					}
+				}
+
+				i++;
+			}
+
+			return length;
+		}
+
+		public Chunk next_chunk (int index, uchar[] base_uuid) {
+			var chunk = new Chunk ();
+
+			chunk.index = index;
+			chunk.buffer = buffer;
+			chunk.begin = pos;
+			chunk.first_line = line;
+			chunk.base_uuid = base_uuid;
+			chunk.directive_begins = directive_begins;
+			chunk.directive_ends = directive_ends;
+
+			pos = next_boundary (get_chunk_size ());
+			chunk.length = pos - chunk.begin;
+
+			return chunk;
+		}
+	}
+
+	static void parse_chunk (owned Chunk chunk) {
+		try {
+			var prefix_map = new HashTable<string,string>.full (str_hash, str_equal, g_free, g_free);
+
+			for (int i = 0; i < chunk.directive_begins.length; i++) {
+				var directive = new TurtleReader.for_chunk (chunk.buffer + chunk.directive_begins[i],
+				                                            chunk.directive_ends[i] - chunk.directive_begins[i],
+				                                            1, chunk.base_uuid, ":", prefix_map);
+				while (directive.next ()) {
+				}
+			}
+
+			// anonymous blank nodes must not clash with other chunks
+			var reader = new TurtleReader.for_chunk (chunk.buffer + chunk.begin, chunk.length,
+			                                         chunk.first_line, chunk.base_uuid,
+			                                         ":%d-".printf (chunk.index), prefix_map);
+
+			while (reader.next ()) {
+				chunk.subjects += reader.subject;
+				chunk.predicates += reader.predicate;
+				chunk.objects += reader.object;
+				chunk.object_is_uri += reader.object_is_uri;
+			}
+		} catch (Sparql.Error e) {
+			chunk.error = e;
+		}
+
+		chunk.finish ();
+	}
+
+	static size_t get_chunk_size () {
+		if (chunk_size == 0) {
+			string? value = Environment.get_variable ("TRACKER_TURTLE_CHUNK_SIZE");
+			int64 size = (value != null) ? int64.parse (value) : 0;
+
+			chunk_size = (size > 0) ? (size_t) size : CHUNK_SIZE;
+		}
+
+		return chunk_size;
+	}
+
+	/* Chunks of the file are parsed in parallel, while the triples
+	 * of the chunks already parsed are inserted, in file order and
+	 * in a single transaction.
+	 */
 	public static void load (string path) throws FileError, Sparql.Error, DateError, DBInterfaceError {
+		var mapped_file = new MappedFile (path, false);
+		var splitter = new Splitter (mapped_file.get_contents (), mapped_file.get_length ());
+		var chunks = new Queue<Chunk> ();
+		ThreadPool<Chunk> pool;
+		uint n_workers = get_num_processors ();
+		int n_chunks = 0;
+		uint n_triples = 0;
+
+		var base_uuid = new uchar[16];
+		uuid_generate (base_uuid);
+
+		try {
+			pool = new ThreadPool<Chunk>.with_owned_data (parse_chunk, (int) n_workers, true);
+		} catch (ThreadError e) {
+			throw new Sparql.Error.INTERNAL ("Could not create parser threads: %s", e.message);
+		}
+
+		int64 start_time = get_monotonic_time ();
+
 		try {
 			Data.begin_transaction ();
 
-			var reader = new TurtleReader (path);
-			while (reader.next ()) {
-				if (reader.object_is_uri) {
-					Data.insert_statement_with_uri (reader.graph, reader.subject, reader.predicate, reader.object);
-				} else {
-					Data.insert_statement_with_string (reader.graph, reader.subject, reader.predicate, reader.object);
+			while (true) {
+				// keep the workers busy, without parsing too far ahead
+				while (chunks.get_length () < 2 * n_workers && !splitter.at_end ()) {
+					var chunk = splitter.next_chunk (n_chunks++, base_uuid);
+
+					chunks.push_tail (chunk);
+					try {
+						pool.push (chunk);
+					} catch (ThreadError e) {
+						// GLib may still have queued the chunk, parsing it here could
+						// parse it twice and waiting for it could hang, give up instead
+						throw new Sparql.Error.INTERNAL ("Could not queue chunk for parsing: %s", e.message);
+					}
 				}
-				Data.update_buffer_might_flush ();
+
+				var chunk = chunks.pop_head ();
+				if (chunk == null) {
+					break;
+				}
+
+				chunk.wait ();
+
+				if (chunk.error != null) {
+					throw chunk.error;
+				}
+
+				for (int i = 0; i < chunk.subjects.length; i++) {
+					if (chunk.object_is_uri[i]) {
+						Data.insert_statement_with_uri (null, chunk.subjects[i], chunk.predicates[i], chunk.objects[i]);
+					} else {
+						Data.insert_statement_with_string (null, chunk.subjects[i], chunk.predicates[i], chunk.objects[i]);
+					}
+					Data.update_buffer_might_flush ();
+				}
+
+				n_triples += chunk.subjects.length;
 			}
 
 			Data.commit_transaction ();
@@ -386,7 +680,15 @@ public class Tracker.TurtleReader : Object {
 		} catch (DBInterfaceError e) {
 			Data.rollback_transaction ();
 			throw e;
+		} finally {
+			// waits for the chunks still being parsed, which use the mapped file
+			pool = null;
 		}
+
+		double elapsed = (get_monotonic_time () - start_time) / (double) TimeSpan.SECOND;
+
+		message ("Loaded %u triples from '%s' in %.2f seconds (%.0f triples/s)",
+		         n_triples, path, elapsed, elapsed > 0 ? n_triples / elapsed : 0);
 	}
 
 	[CCode (cname = "uuid_generate")]
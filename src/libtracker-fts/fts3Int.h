@@ -170,6 +170,7 @@ int sqlite3Fts3Corrupt(void);
 
 typedef struct Fts3Table Fts3Table;
 typedef struct Fts3Cursor Fts3Cursor;
+typedef struct Fts3TokenCache Fts3TokenCache;
 typedef struct Fts3Expr Fts3Expr;
 typedef struct Fts3Phrase Fts3Phrase;
 typedef struct Fts3PhraseToken Fts3PhraseToken;
@@ -284,6 +285,7 @@ struct Fts3Cursor {
   u32 *aMatchinfo;                /* Information about most recent match */
   int nMatchinfo;                 /* Number of elements in aMatchinfo[] */
   char *zMatchinfo;               /* Matchinfo specification */
+  Fts3TokenCache *pTokenCache;    /* Token offsets of current row, or 0 */
 };
 
 #define FTS3_EVAL_FILTER    0
@@ -521,6 +523,7 @@ void sqlite3Fts3Snippet(sqlite3_context *, Fts3Cursor *, const char *,
   const char *, const char *, int, int
 );
 void sqlite3Fts3Matchinfo(sqlite3_context *, Fts3Cursor *, const char *);
+void sqlite3Fts3TokenCacheFree(Fts3Cursor *);
 
 /* fts3_expr.c */
 int sqlite3Fts3ExprParse(sqlite3_tokenizer *, int,
@@ -105,6 +105,40 @@ struct StrBuffer {
   int nAlloc;                     /* Allocated size of buffer z in bytes */
 };
 
+/*
+** Token offsets of the row a cursor points to. Both snippet() and offsets()
+** need the byte offsets of the tokens in a column, which are only available
+** by running the column text through the tokenizer. Columns are tokenized
+** incrementally, only as far as the functions need, and the offsets read
+** so far are kept until the cursor moves to another row. This way a column
+** goes through the tokenizer at most once per row, however many snippet()
+** and offsets() calls (and snippet fragments) are evaluated on it.
+*/
+typedef struct Fts3TokenOffset Fts3TokenOffset;
+typedef struct Fts3TokenColumn Fts3TokenColumn;
+
+struct Fts3TokenOffset {
+  int iPos;                       /* Token position */
+  int iStart;                     /* Byte offset of start of token */
+  int iEnd;                       /* Byte offset of end of token */
+};
+
+struct Fts3TokenColumn {
+  const char *zDoc;               /* Column text being tokenized */
+  int nDoc;                       /* Size of zDoc in bytes */
+  sqlite3_tokenizer_cursor *pC;   /* Tokenizer cursor, 0 once finished */
+  int rc;                         /* Tokenizer return code once finished */
+  int nToken;                     /* Number of tokens in aToken[] */
+  int nAlloc;                     /* Allocated size of aToken[] */
+  Fts3TokenOffset *aToken;        /* Offsets of the tokens read so far */
+};
+
+struct Fts3TokenCache {
+  sqlite3_int64 iDocid;           /* Row the columns below belong to */
+  int nColumn;                    /* Number of entries in aCol[] */
+  Fts3TokenColumn *aCol;          /* One entry for each table column */
+};
+
 
 /*
 ** This function is used to help iterate through a position-list. A position
@@ -476,6 +510,139 @@ static int fts3BestSnippet(
 }
 
 
+/*
+** Release the tokenizer cursor and token offsets held for a column.
+*/
+static void fts3TokenColumnReset(
+  sqlite3_tokenizer_module const *pMod,
+  Fts3TokenColumn *pCol
+){
+  if( pCol->pC ) pMod->xClose(pCol->pC);
+  sqlite3_free(pCol->aToken);
+  memset(pCol, 0, sizeof(Fts3TokenColumn));
+}
+
+/*
+** Free the token offsets cached for the current row of cursor pCsr, if any.
+*/
+void sqlite3Fts3TokenCacheFree(Fts3Cursor *pCsr){
+  Fts3TokenCache *pCache = pCsr->pTokenCache;
+  if( pCache ){
+    Fts3Table *pTab = (Fts3Table *)pCsr->base.pVtab;
+    int i;
+    for(i=0; i<pCache->nColumn; i++){
+      fts3TokenColumnReset(pTab->pTokenizer->pModule, &pCache->aCol[i]);
+    }
+    sqlite3_free(pCache);
+    pCsr->pTokenCache = 0;
+  }
+}
+
+/*
+** Set *ppCol to the token offsets of column iCol (text zDoc/nDoc) of the
+** row cursor pCsr currently points to. Offsets cached for a previous row
+** are discarded first.
+*/
+static int fts3TokenColumnGet(
+  Fts3Cursor *pCsr,               /* FTS3 Cursor */
+  int iCol,                       /* Table column (0 for the first one) */
+  const char *zDoc,               /* Column text */
+  int nDoc,                       /* Size of zDoc in bytes */
+  Fts3TokenColumn **ppCol         /* OUT: Token offsets of the column */
+){
+  Fts3Table *pTab = (Fts3Table *)pCsr->base.pVtab;
+  Fts3TokenCache *pCache = pCsr->pTokenCache;
+  Fts3TokenColumn *pCol;
+
+  if( pCache && pCache->iDocid!=pCsr->iPrevId ){
+    sqlite3Fts3TokenCacheFree(pCsr);
+    pCache = 0;
+  }
+
+  if( !pCache ){
+    int nByte = sizeof(Fts3TokenCache) + sizeof(Fts3TokenColumn)*pTab->nColumn;
+    pCache = (Fts3TokenCache *)sqlite3_malloc(nByte);
+    if( !pCache ) return SQLITE_NOMEM;
+    memset(pCache, 0, nByte);
+    pCache->iDocid = pCsr->iPrevId;
+    pCache->nColumn = pTab->nColumn;
+    pCache->aCol = (Fts3TokenColumn *)&pCache[1];
+    pCsr->pTokenCache = pCache;
+  }
+
+  assert( iCol>=0 && iCol<pCache->nColumn );
+  pCol = &pCache->aCol[iCol];
+
+  if( pCol->zDoc!=zDoc || pCol->nDoc!=nDoc ){
+    int rc;
+    fts3TokenColumnReset(pTab->pTokenizer->pModule, pCol);
+    rc = sqlite3Fts3OpenTokenizer(
+        pTab->pTokenizer, pCsr->iLangid, zDoc, nDoc, &pCol->pC
+    );
+    if( rc!=SQLITE_OK ){
+      pCol->pC = 0;
+      return rc;
+    }
+    pCol->zDoc = zDoc;
+    pCol->nDoc = nDoc;
+  }
+
+  *ppCol = pCol;
+  return SQLITE_OK;
+}
+
+/*
+** Read token *piToken of column pCol, running the tokenizer further if it
+** has not been reached yet. On success, the offsets and position of the
+** token are written to the output variables and *piToken is incremented.
+** SQLITE_DONE is returned if the column has no more tokens.
+*/
+static int fts3TokenColumnNext(
+  sqlite3_tokenizer_module const *pMod,
+  Fts3TokenColumn *pCol,          /* Column to read the token from */
+  int *piToken,                   /* IN/OUT: Index of token to read */
+  int *piStart,                   /* OUT: Byte offset of start of token */
+  int *piEnd,                     /* OUT: Byte offset of end of token */
+  int *piPos                      /* OUT: Token position */
+){
+  Fts3TokenOffset *pTok;
+
+  while( pCol->nToken<=*piToken ){
+    const char *ZDUMMY;           /* Dummy argument used with xNext() */
+    int NDUMMY = 0;               /* Dummy argument used with xNext() */
+    int rc;
+
+    if( pCol->pC==0 ) return pCol->rc;
+
+    if( pCol->nToken==pCol->nAlloc ){
+      int nNew = pCol->nAlloc ? pCol->nAlloc*2 : 64;
+      Fts3TokenOffset *aNew;
+      aNew = sqlite3_realloc(pCol->aToken, nNew*sizeof(Fts3TokenOffset));
+      if( !aNew ) return SQLITE_NOMEM;
+      pCol->aToken = aNew;
+      pCol->nAlloc = nNew;
+    }
+
+    pTok = &pCol->aToken[pCol->nToken];
+    rc = pMod->xNext(pCol->pC, &ZDUMMY, &NDUMMY,
+        &pTok->iStart, &pTok->iEnd, &pTok->iPos
+    );
+    if( rc!=SQLITE_OK ){
+      pMod->xClose(pCol->pC);
+      pCol->pC = 0;
+      pCol->rc = rc;
+      return rc;
+    }
+    pCol->nToken++;
+  }
+
+  pTok = &pCol->aToken[(*piToken)++];
+  *piStart = pTok->iStart;
+  *piEnd = pTok->iEnd;
+  *piPos = pTok->iPos;
+  return SQLITE_OK;
+}
+
 /*
 ** Append a string to the string-buffer passed as the first argument.
 **
@@ -534,11 +701,10 @@ static int fts3StringAppend(
 ** actually contains terms that follow the final highlighted term. 
 */
 static int fts3SnippetShift(
-  Fts3Table *pTab,                /* FTS3 table snippet comes from */
-  int iLangid,                    /* Language id to use in tokenizing */
+  sqlite3_tokenizer_module const *pMod,
+  Fts3TokenColumn *pCol,          /* Token offsets of the snippet column */
+  int iToken,                     /* Index in pCol of first token of snippet */
   int nSnippet,                   /* Number of tokens desired for snippet */
-  const char *zDoc,               /* Document text to extract snippet from */
-  int nDoc,                       /* Size of buffer zDoc in bytes */
   int *piPos,                     /* IN/OUT: First token of snippet */
   u64 *pHlmask                    /* IN/OUT: Mask of tokens to highlight */
 ){
@@ -563,23 +729,20 @@ static int fts3SnippetShift(
     if( nDesired>0 ){
       int nShift;                 /* Number of tokens to shift snippet by */
       int iCurrent = 0;           /* Token counter */
-      int rc;                     /* Return Code */
-      sqlite3_tokenizer_module *pMod;
-      sqlite3_tokenizer_cursor *pC;
-      pMod = (sqlite3_tokenizer_module *)pTab->pTokenizer->pModule;
+      int iBase;                  /* Position of first token of snippet */
+      int rc = SQLITE_OK;         /* Return Code */
+      int DUMMY1 = 0, DUMMY2 = 0;
 
-      /* Open a cursor on zDoc/nDoc. Check if there are (nSnippet+nDesired)
-      ** or more tokens in zDoc/nDoc.
+      /* Check if there are (nSnippet+nDesired) or more tokens in the column,
+      ** counting from the first token of the snippet.
       */
-      rc = sqlite3Fts3OpenTokenizer(pTab->pTokenizer, iLangid, zDoc, nDoc, &pC);
-      if( rc!=SQLITE_OK ){
-        return rc;
-      }
+      iBase = pCol->aToken[iToken].iPos;
       while( rc==SQLITE_OK && iCurrent<(nSnippet+nDesired) ){
-        const char *ZDUMMY; int DUMMY1 = 0, DUMMY2 = 0, DUMMY3 = 0;
-        rc = pMod->xNext(pC, &ZDUMMY, &DUMMY1, &DUMMY2, &DUMMY3, &iCurrent);
+        rc = fts3TokenColumnNext(pMod, pCol, &iToken, &DUMMY1, &DUMMY2,
+            &iCurrent
+        );
+        if( rc==SQLITE_OK ) iCurrent -= iBase;
       }
-      pMod->xClose(pC);
       if( rc!=SQLITE_OK && rc!=SQLITE_DONE ){ return rc; }
 
       nShift = (rc==SQLITE_DONE)+iCurrent-nSnippet;
@@ -618,8 +781,9 @@ static int fts3SnippetText(
   int iPos = pFragment->iPos;     /* First token of snippet */
   u64 hlmask = pFragment->hlmask; /* Highlight-mask for snippet */
   int iCol = pFragment->iCol+1;   /* Query column to extract text from */
+  int iToken = 0;                 /* Index of next token in pCol */
   sqlite3_tokenizer_module *pMod; /* Tokenizer module methods object */
-  sqlite3_tokenizer_cursor *pC;   /* Tokenizer cursor open on zDoc/nDoc */
+  Fts3TokenColumn *pCol;          /* Token offsets of zDoc/nDoc */
   
   zDoc = (const char *)sqlite3_column_text(pCsr->pStmt, iCol);
   if( zDoc==0 ){
@@ -630,32 +794,19 @@ static int fts3SnippetText(
   }
   nDoc = sqlite3_column_bytes(pCsr->pStmt, iCol);
 
-  /* Open a token cursor on the document. */
+  /* Get the (possibly partially) tokenized document. */
   pMod = (sqlite3_tokenizer_module *)pTab->pTokenizer->pModule;
-  rc = sqlite3Fts3OpenTokenizer(pTab->pTokenizer, pCsr->iLangid, zDoc,nDoc,&pC);
+  rc = fts3TokenColumnGet(pCsr, iCol-1, zDoc, nDoc, &pCol);
   if( rc!=SQLITE_OK ){
     return rc;
   }
 
   while( rc==SQLITE_OK ){
-    const char *ZDUMMY;           /* Dummy argument used with tokenizer */
-    int DUMMY1 = -1;              /* Dummy argument used with tokenizer */
     int iBegin = 0;               /* Offset in zDoc of start of token */
     int iFin = 0;                 /* Offset in zDoc of end of token */
     int isHighlight = 0;          /* True for highlighted terms */
 
-    /* Variable DUMMY1 is initialized to a negative value above. Elsewhere
-    ** in the FTS code the variable that the third argument to xNext points to
-    ** is initialized to zero before the first (*but not necessarily
-    ** subsequent*) call to xNext(). This is done for a particular application
-    ** that needs to know whether or not the tokenizer is being used for
-    ** snippet generation or for some other purpose.
-    **
-    ** Extreme care is required when writing code to depend on this
-    ** initialization. It is not a documented part of the tokenizer interface.
-    ** If a tokenizer is used directly by any code outside of FTS, this
-    ** convention might not be respected.  */
-    rc = pMod->xNext(pC, &ZDUMMY, &DUMMY1, &iBegin, &iFin, &iCurrent);
+    rc = fts3TokenColumnNext(pMod, pCol, &iToken, &iBegin, &iFin, &iCurrent);
     if( rc!=SQLITE_OK ){
       if( rc==SQLITE_DONE ){
         /* Special case - the last token of the snippet is also the last token
@@ -669,10 +820,7 @@ static int fts3SnippetText(
     if( iCurrent<iPos ){ continue; }
 
     if( !isShiftDone ){
-      int n = nDoc - iBegin;
-      rc = fts3SnippetShift(
-          pTab, pCsr->iLangid, nSnippet, &zDoc[iBegin], n, &iPos, &hlmask
-      );
+      rc = fts3SnippetShift(pMod, pCol, iToken-1, nSnippet, &iPos, &hlmask);
       isShiftDone = 1;
 
       /* Now that the shift has been done, check if the initial "..." are
@@ -703,7 +851,6 @@ static int fts3SnippetText(
     iEnd = iFin;
   }
 
-  pMod->xClose(pC);
   return rc;
 }
 
@@ -1375,9 +1522,8 @@ void sqlite3Fts3Offsets(
   ** string-buffer res for each column.
   */
   for(iCol=0; iCol<pTab->nColumn; iCol++){
-    sqlite3_tokenizer_cursor *pC; /* Tokenizer cursor */
-    const char *ZDUMMY;           /* Dummy argument used with xNext() */
-    int NDUMMY = 0;               /* Dummy argument used with xNext() */
+    Fts3TokenColumn *pCol;        /* Token offsets of the column */
+    int iToken = 0;               /* Index of next token in pCol */
     int iStart = 0;
     int iEnd = 0;
     int iCurrent = 0;
@@ -1408,13 +1554,11 @@ void sqlite3Fts3Offsets(
       goto offsets_out;
     }
 
-    /* Initialize a tokenizer iterator to iterate through column iCol. */
-    rc = sqlite3Fts3OpenTokenizer(pTab->pTokenizer, pCsr->iLangid,
-        zDoc, nDoc, &pC
-    );
+    /* Get the token offsets of column iCol. */
+    rc = fts3TokenColumnGet(pCsr, iCol, zDoc, nDoc, &pCol);
     if( rc!=SQLITE_OK ) goto offsets_out;
 
-    rc = pMod->xNext(pC, &ZDUMMY, &NDUMMY, &iStart, &iEnd, &iCurrent);
+    rc = fts3TokenColumnNext(pMod, pCol, &iToken, &iStart, &iEnd, &iCurrent);
     while( rc==SQLITE_OK ){
       int i;                      /* Used to loop through terms */
       int iMinPos = 0x7FFFFFFF;   /* Position of next token */
@@ -1439,7 +1583,9 @@ void sqlite3Fts3Offsets(
           fts3GetDeltaPosition(&pTerm->pList, &pTerm->iPos);
         }
         while( rc==SQLITE_OK && iCurrent<iMinPos ){
-          rc = pMod->xNext(pC, &ZDUMMY, &NDUMMY, &iStart, &iEnd, &iCurrent);
+          rc = fts3TokenColumnNext(pMod, pCol, &iToken,
+              &iStart, &iEnd, &iCurrent
+          );
         }
         if( rc==SQLITE_OK ){
           char aBuffer[64];
@@ -1456,7 +1602,6 @@ void sqlite3Fts3Offsets(
       rc = SQLITE_OK;
     }
 
-    pMod->xClose(pC);
     if( rc!=SQLITE_OK ) goto offsets_out;
   }
 
@@ -309,6 +309,38 @@ tracker_fts_config_get_max_words_to_index (TrackerFTSConfig *config)
 	return g_settings_get_int (G_SETTINGS (config), "max-words-to-index");
 }
 
+gchar *
+tracker_fts_config_get_prefix_indexes (TrackerFTSConfig *config)
+{
+	GString *str;
+	GVariant *value;
+	GVariantIter iter;
+	gint32 length;
+
+	g_return_val_if_fail (TRACKER_IS_FTS_CONFIG (config), NULL);
+
+	/* Returned in the format used by the fts4 prefix= option */
+	str = g_string_new (NULL);
+	value = g_settings_get_value (G_SETTINGS (config), "prefix-indexes");
+
+	g_variant_iter_init (&iter, value);
+	while (g_variant_iter_next (&iter, "i", &length)) {
+		if (length <= 0) {
+			continue;
+		}
+
+		if (str->len > 0) {
+			g_string_append_c (str, ',');
+		}
+
+		g_string_append_printf (str, "%d", length);
+	}
+
+	g_variant_unref (value);
+
+	return g_string_free (str, FALSE);
+}
+
 void
 tracker_fts_config_set_max_word_length (TrackerFTSConfig *config,
                                         gint              value)
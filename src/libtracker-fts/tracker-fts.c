@@ -20,7 +20,12 @@
  */
 
 #include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
 #include <sqlite3.h>
+
+#include "tracker-fts-config.h"
 #include "tracker-fts-tokenizer.h"
 #include "tracker-fts.h"
 
@@ -99,7 +104,15 @@ function_offsets (sqlite3_context *context,
 	names = sqlite3_value_blob (argv[1]);
 
 	while (offsets && *offsets) {
-		offset_values[i] = g_strtod (offsets, &offsets);
+		gchar *end;
+
+		offset_values[i] = strtol (offsets, &end, 10);
+
+		if (end == offsets) {
+			break;
+		}
+
+		offsets = end;
 
 		/* All 4 values from the quartet have been gathered */
 		if (i == 3) {
@@ -237,6 +250,25 @@ tracker_fts_init_db (sqlite3 *db,
 	return TRUE;
 }
 
+static gchar *
+tracker_fts_get_prefix_option (void)
+{
+	TrackerFTSConfig *config;
+	gchar *prefix, *option = NULL;
+
+	config = tracker_fts_config_new ();
+	prefix = tracker_fts_config_get_prefix_indexes (config);
+	g_object_unref (config);
+
+	if (prefix && *prefix) {
+		option = g_strdup_printf ("prefix=\"%s\"", prefix);
+	}
+
+	g_free (prefix);
+
+	return option;
+}
+
 gboolean
 tracker_fts_create_table (sqlite3    *db,
                           gchar      *table_name,
@@ -245,7 +277,7 @@ tracker_fts_create_table (sqlite3    *db,
 {
 	GString *str, *from, *fts;
 	GHashTableIter iter;
-	gchar *index_table;
+	gchar *index_table, *prefix;
 	GList *columns;
 	gint rc;
 
@@ -295,6 +327,13 @@ tracker_fts_create_table (sqlite3    *db,
 		return FALSE;
 	}
 
+	prefix = tracker_fts_get_prefix_option ();
+
+	if (prefix) {
+		g_string_append_printf (fts, "%s, ", prefix);
+		g_free (prefix);
+	}
+
 	g_string_append (fts, "tokenize=TrackerTokenizer)");
 	rc = sqlite3_exec(db, fts->str, NULL, 0, NULL);
 	g_string_free (fts, TRUE);
@@ -302,57 +341,104 @@ tracker_fts_create_table (sqlite3    *db,
 	return (rc == SQLITE_OK);
 }
 
+gboolean
+tracker_fts_merge (sqlite3     *db,
+                   const gchar *table_name,
+                   gint         n_pages,
+                   gint         min_segments)
+{
+	gchar *query;
+	gint rc, changes;
+
+	changes = sqlite3_total_changes (db);
+
+	query = g_strdup_printf ("INSERT INTO %s(%s) VALUES('merge=%d,%d')",
+				 table_name, table_name, n_pages, min_segments);
+	rc = sqlite3_exec (db, query, NULL, NULL, NULL);
+	g_free (query);
+
+	if (rc != SQLITE_OK) {
+		g_warning ("Could not merge FTS segments: %s", sqlite3_errmsg (db));
+		return FALSE;
+	}
+
+	/* The segment tables are only modified if there was
+	 * something to merge, see the fts4 documentation.
+	 */
+	return (sqlite3_total_changes (db) - changes >= 2);
+}
+
 gboolean
 tracker_fts_alter_table (sqlite3    *db,
 			 gchar      *table_name,
 			 GHashTable *tables,
 			 GHashTable *grouped_columns)
 {
-	gchar *query, *tmp_name;
+	gchar *query;
 	int rc;
 
-	tmp_name = g_strdup_printf ("%s_TMP", table_name);
-
-	query = g_strdup_printf ("DROP VIEW fts_view");
-	rc = sqlite3_prepare_v2 (db, query, -1, NULL, NULL);
+	rc = sqlite3_exec (db, "DROP VIEW IF EXISTS fts_view", NULL, NULL, NULL);
 
-	if (!tracker_fts_create_table (db, tmp_name, tables, grouped_columns)) {
-		g_free (tmp_name);
+	if (rc == SQLITE_OK) {
+		query = g_strdup_printf ("DROP TABLE IF EXISTS %s", table_name);
+		rc = sqlite3_exec (db, query, NULL, NULL, NULL);
 		g_free (query);
-		return FALSE;
 	}
 
-	query = g_strdup_printf ("INSERT INTO %s (docid) SELECT docid FROM %s",
-				 tmp_name, table_name);
-	rc = sqlite3_prepare_v2 (db, query, -1, NULL, NULL);
-	g_free (query);
-
-	if (rc != SQLITE_OK) {
-		g_free (tmp_name);
+	if (rc != SQLITE_OK ||
+	    !tracker_fts_create_table (db, table_name, tables, grouped_columns)) {
 		return FALSE;
 	}
 
+	/* The content is all in fts_view, so the new table
+	 * can be populated from there.
+	 */
 	query = g_strdup_printf ("INSERT INTO %s(%s) VALUES('rebuild')",
-				 tmp_name, tmp_name);
-	rc = sqlite3_prepare_v2 (db, query, -1, NULL, NULL);
+				 table_name, table_name);
+	rc = sqlite3_exec (db, query, NULL, NULL, NULL);
 	g_free (query);
 
+	return (rc == SQLITE_OK);
+}
+
+gboolean
+tracker_fts_table_is_outdated (sqlite3     *db,
+                               const gchar *table_name)
+{
+	sqlite3_stmt *stmt;
+	gchar *prefix;
+	gboolean outdated = FALSE;
+	int rc;
+
+	rc = sqlite3_prepare_v2 (db,
+	                         "SELECT sql FROM sqlite_master WHERE name = ?",
+	                         -1, &stmt, NULL);
+
 	if (rc != SQLITE_OK) {
-		g_free (tmp_name);
 		return FALSE;
 	}
 
-	query = g_strdup_printf ("ALTER TABLE %s RENAME TO %s",
-				 tmp_name, table_name);
-	rc = sqlite3_prepare_v2 (db, query, -1, NULL, NULL);
-	g_free (query);
-	g_free (tmp_name);
+	sqlite3_bind_text (stmt, 1, table_name, -1, SQLITE_STATIC);
 
+	if (sqlite3_step (stmt) == SQLITE_ROW) {
+		const gchar *sql;
 
-	if (rc != SQLITE_OK) {
-		g_free (tmp_name);
-		return FALSE;
+		/* Check whether the table was created with
+		 * the currently configured prefix indexes
+		 */
+		sql = (const gchar *) sqlite3_column_text (stmt, 0);
+		prefix = tracker_fts_get_prefix_option ();
+
+		if (prefix) {
+			outdated = (strstr (sql, prefix) == NULL);
+		} else {
+			outdated = (strstr (sql, "prefix=") != NULL);
+		}
+
+		g_free (prefix);
 	}
 
-	return TRUE;
+	sqlite3_finalize (stmt);
+
+	return outdated;
 }
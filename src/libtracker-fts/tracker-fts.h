@@ -27,17 +27,23 @@
 
 G_BEGIN_DECLS
 
-gboolean    tracker_fts_init             (void);
-gboolean    tracker_fts_init_db          (sqlite3    *db,
-                                          GHashTable *tables);
-gboolean    tracker_fts_create_table     (sqlite3    *db,
-                                          gchar      *table_name,
-                                          GHashTable *tables,
-                                          GHashTable *grouped_columns);
-gboolean    tracker_fts_alter_table      (sqlite3    *db,
-                                          gchar      *table_name,
-                                          GHashTable *tables,
-                                          GHashTable *grouped_columns);
+gboolean    tracker_fts_init              (void);
+gboolean    tracker_fts_init_db           (sqlite3     *db,
+                                           GHashTable  *tables);
+gboolean    tracker_fts_create_table      (sqlite3     *db,
+                                           gchar       *table_name,
+                                           GHashTable  *tables,
+                                           GHashTable  *grouped_columns);
+gboolean    tracker_fts_alter_table       (sqlite3     *db,
+                                           gchar       *table_name,
+                                           GHashTable  *tables,
+                                           GHashTable  *grouped_columns);
+gboolean    tracker_fts_table_is_outdated (sqlite3     *db,
+                                           const gchar *table_name);
+gboolean    tracker_fts_merge             (sqlite3     *db,
+                                           const gchar *table_name,
+                                           gint         n_pages,
+                                           gint         min_segments);
 
 
 G_END_DECLS
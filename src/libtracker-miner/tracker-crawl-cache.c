@@ -0,0 +1,500 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib/gstdio.h>
+
+#include "tracker-crawl-cache.h"
+
+/* On-disk layout, integers are in host byte order:
+ *
+ *   CacheHeader
+ *   CacheRecord[n_records], sorted by URI
+ *   nul-terminated URIs, records point to these by
+ *   offset from the start of the file.
+ *
+ * The file is mapped as is and looked up through binary
+ * search, so loading it costs the same for any size.
+ */
+#define CACHE_MAGIC      "TRKCRAWL"
+#define CACHE_VERSION    1
+#define CACHE_BYTE_ORDER 0x01020304
+
+typedef struct {
+	gchar magic[8];
+	guint32 byte_order;
+	guint32 version;
+	guint32 n_records;
+	guint32 reserved;
+} CacheHeader;
+
+typedef struct {
+	guint64 inode;
+	guint64 mtime;
+	guint64 children_mtime_sum;
+	guint32 n_children;
+	guint32 uri_offset;
+} CacheRecord;
+
+typedef struct {
+	const gchar *uri;
+	const TrackerCrawlCacheEntry *entry;
+	TrackerCrawlCacheEntry copy;
+} SaveItem;
+
+struct _TrackerCrawlCache {
+	gchar *path;
+
+	/* Snapshot from the last time the cache was saved */
+	GMappedFile *mapped;
+	const gchar *data;
+	const CacheRecord *records;
+	guint n_records;
+
+	/* Directories recorded since, URI -> TrackerCrawlCacheEntry */
+	GHashTable *entries;
+
+	/* URIs of the trees recorded since, their
+	 * snapshot contents are outdated.
+	 */
+	GPtrArray *trees;
+
+	guint dirty : 1;
+};
+
+static gboolean
+crawl_cache_map (TrackerCrawlCache *cache)
+{
+	const CacheHeader *header;
+	GError *error = NULL;
+	gsize size, strings_start;
+	guint i;
+
+	cache->mapped = g_mapped_file_new (cache->path, FALSE, &error);
+
+	if (!cache->mapped) {
+		if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
+			g_message ("Could not map crawl cache '%s': %s",
+			           cache->path, error->message);
+		}
+
+		g_error_free (error);
+		return FALSE;
+	}
+
+	cache->data = g_mapped_file_get_contents (cache->mapped);
+	size = g_mapped_file_get_length (cache->mapped);
+	header = (const CacheHeader *) cache->data;
+
+	if (size < sizeof (CacheHeader) ||
+	    memcmp (header->magic, CACHE_MAGIC, sizeof (header->magic)) != 0 ||
+	    header->byte_order != CACHE_BYTE_ORDER ||
+	    header->version != CACHE_VERSION ||
+	    header->n_records > (size - sizeof (CacheHeader)) / sizeof (CacheRecord)) {
+		goto invalid;
+	}
+
+	strings_start = sizeof (CacheHeader) + header->n_records * sizeof (CacheRecord);
+	cache->records = (const CacheRecord *) (cache->data + sizeof (CacheHeader));
+
+	/* A trailing nul ensures no URI runs past the mapping */
+	if (header->n_records > 0 && cache->data[size - 1] != '\0') {
+		goto invalid;
+	}
+
+	for (i = 0; i < header->n_records; i++) {
+		if (cache->records[i].uri_offset < strings_start ||
+		    cache->records[i].uri_offset >= size) {
+			goto invalid;
+		}
+	}
+
+	cache->n_records = header->n_records;
+
+	return TRUE;
+
+invalid:
+	g_message ("Crawl cache '%s' is invalid, ignoring", cache->path);
+
+	g_mapped_file_unref (cache->mapped);
+	cache->mapped = NULL;
+	cache->data = NULL;
+	cache->records = NULL;
+
+	return FALSE;
+}
+
+static const CacheRecord *
+crawl_cache_find_record (TrackerCrawlCache *cache,
+                         const gchar       *uri)
+{
+	guint lo, hi, mid;
+	gint cmp;
+
+	lo = 0;
+	hi = cache->n_records;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		cmp = strcmp (uri, cache->data + cache->records[mid].uri_offset);
+
+		if (cmp == 0) {
+			return &cache->records[mid];
+		} else if (cmp < 0) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
+	}
+
+	return NULL;
+}
+
+static gboolean
+uri_is_within (const gchar *uri,
+               const gchar *tree)
+{
+	gsize len;
+
+	len = strlen (tree);
+
+	return (strncmp (uri, tree, len) == 0 &&
+	        (uri[len] == '\0' || uri[len] == '/'));
+}
+
+static gboolean
+crawl_cache_uri_has_recorded (TrackerCrawlCache *cache,
+                              const gchar       *uri)
+{
+	guint i;
+
+	for (i = 0; i < cache->trees->len; i++) {
+		if (uri_is_within (uri, g_ptr_array_index (cache->trees, i))) {
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+TrackerCrawlCache *
+tracker_crawl_cache_new (const gchar *path)
+{
+	TrackerCrawlCache *cache;
+
+	g_return_val_if_fail (path != NULL, NULL);
+
+	cache = g_slice_new0 (TrackerCrawlCache);
+	cache->path = g_strdup (path);
+	cache->entries = g_hash_table_new_full (g_str_hash, g_str_equal,
+	                                        (GDestroyNotify) g_free,
+	                                        (GDestroyNotify) g_free);
+	cache->trees = g_ptr_array_new_with_free_func (g_free);
+
+	crawl_cache_map (cache);
+
+	return cache;
+}
+
+void
+tracker_crawl_cache_free (TrackerCrawlCache *cache)
+{
+	g_return_if_fail (cache != NULL);
+
+	if (cache->mapped) {
+		g_mapped_file_unref (cache->mapped);
+	}
+
+	g_hash_table_unref (cache->entries);
+	g_ptr_array_unref (cache->trees);
+	g_free (cache->path);
+
+	g_slice_free (TrackerCrawlCache, cache);
+}
+
+/**
+ * tracker_crawl_cache_lookup:
+ * @cache: a #TrackerCrawlCache
+ * @directory: a #GFile
+ * @entry: (out) (allow-none): return location for the state
+ *
+ * Looks up the state @directory had when the cache was last
+ * saved. Directories recorded afterwards are not taken into
+ * account.
+ *
+ * Returns: %TRUE if @directory was in the cache.
+ **/
+gboolean
+tracker_crawl_cache_lookup (TrackerCrawlCache      *cache,
+                            GFile                  *directory,
+                            TrackerCrawlCacheEntry *entry)
+{
+	const CacheRecord *record;
+	gchar *uri;
+
+	g_return_val_if_fail (cache != NULL, FALSE);
+	g_return_val_if_fail (G_IS_FILE (directory), FALSE);
+
+	if (cache->n_records == 0) {
+		return FALSE;
+	}
+
+	uri = g_file_get_uri (directory);
+	record = crawl_cache_find_record (cache, uri);
+	g_free (uri);
+
+	if (!record) {
+		return FALSE;
+	}
+
+	if (entry) {
+		entry->inode = record->inode;
+		entry->mtime = record->mtime;
+		entry->children_mtime_sum = record->children_mtime_sum;
+		entry->n_children = record->n_children;
+	}
+
+	return TRUE;
+}
+
+/**
+ * tracker_crawl_cache_begin_tree:
+ * @cache: a #TrackerCrawlCache
+ * @root: the root of the crawled directory tree
+ *
+ * Notifies that the tree at @root is about to be recorded
+ * again, so everything known within it gets replaced by the
+ * entries given to tracker_crawl_cache_record().
+ **/
+void
+tracker_crawl_cache_begin_tree (TrackerCrawlCache *cache,
+                                GFile             *root)
+{
+	GHashTableIter iter;
+	gchar *uri, *key;
+
+	g_return_if_fail (cache != NULL);
+	g_return_if_fail (G_IS_FILE (root));
+
+	uri = g_file_get_uri (root);
+
+	g_hash_table_iter_init (&iter, cache->entries);
+
+	while (g_hash_table_iter_next (&iter, (gpointer *) &key, NULL)) {
+		if (uri_is_within (key, uri)) {
+			g_hash_table_iter_remove (&iter);
+		}
+	}
+
+	if (!crawl_cache_uri_has_recorded (cache, uri)) {
+		g_ptr_array_add (cache->trees, uri);
+	} else {
+		g_free (uri);
+	}
+
+	cache->dirty = TRUE;
+}
+
+gboolean
+tracker_crawl_cache_has_recorded (TrackerCrawlCache *cache,
+                                  GFile             *directory)
+{
+	gboolean retval;
+	gchar *uri;
+
+	g_return_val_if_fail (cache != NULL, FALSE);
+	g_return_val_if_fail (G_IS_FILE (directory), FALSE);
+
+	uri = g_file_get_uri (directory);
+	retval = crawl_cache_uri_has_recorded (cache, uri);
+	g_free (uri);
+
+	return retval;
+}
+
+void
+tracker_crawl_cache_record (TrackerCrawlCache            *cache,
+                            GFile                        *directory,
+                            const TrackerCrawlCacheEntry *entry)
+{
+	g_return_if_fail (cache != NULL);
+	g_return_if_fail (G_IS_FILE (directory));
+	g_return_if_fail (entry != NULL);
+
+	g_hash_table_replace (cache->entries,
+	                      g_file_get_uri (directory),
+	                      g_memdup (entry, sizeof (TrackerCrawlCacheEntry)));
+	cache->dirty = TRUE;
+}
+
+static gint
+save_item_compare (gconstpointer a,
+                   gconstpointer b)
+{
+	const SaveItem *item_a = a, *item_b = b;
+
+	return strcmp (item_a->uri, item_b->uri);
+}
+
+/**
+ * tracker_crawl_cache_save:
+ * @cache: a #TrackerCrawlCache
+ * @error: return location for a #GError
+ *
+ * Writes the snapshot contents, updated with all directories
+ * recorded since, back to disk. Callers must only do this once
+ * the store reflects the recorded state.
+ *
+ * Returns: %TRUE on success.
+ **/
+gboolean
+tracker_crawl_cache_save (TrackerCrawlCache  *cache,
+                          GError            **error)
+{
+	GHashTableIter iter;
+	CacheHeader header = { { 0 } };
+	GArray *items;
+	GByteArray *contents;
+	gsize strings_start, strings_size;
+	gchar *uri, *dirname;
+	TrackerCrawlCacheEntry *entry;
+	gboolean retval;
+	guint i;
+
+	g_return_val_if_fail (cache != NULL, FALSE);
+
+	if (!cache->dirty) {
+		return TRUE;
+	}
+
+	items = g_array_new (FALSE, FALSE, sizeof (SaveItem));
+
+	for (i = 0; i < cache->n_records; i++) {
+		const CacheRecord *record = &cache->records[i];
+		SaveItem item;
+
+		item.uri = cache->data + record->uri_offset;
+
+		if (crawl_cache_uri_has_recorded (cache, item.uri)) {
+			continue;
+		}
+
+		item.copy.inode = record->inode;
+		item.copy.mtime = record->mtime;
+		item.copy.children_mtime_sum = record->children_mtime_sum;
+		item.copy.n_children = record->n_children;
+		item.entry = NULL;
+
+		g_array_append_val (items, item);
+	}
+
+	g_hash_table_iter_init (&iter, cache->entries);
+
+	while (g_hash_table_iter_next (&iter, (gpointer *) &uri, (gpointer *) &entry)) {
+		SaveItem item;
+
+		item.uri = uri;
+		item.entry = entry;
+		g_array_append_val (items, item);
+	}
+
+	g_array_sort (items, save_item_compare);
+
+	strings_start = sizeof (CacheHeader) + items->len * sizeof (CacheRecord);
+	strings_size = 0;
+
+	for (i = 0; i < items->len; i++) {
+		strings_size += strlen (g_array_index (items, SaveItem, i).uri) + 1;
+	}
+
+	if (strings_start + strings_size > G_MAXUINT32) {
+		g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_FBIG,
+		             "Crawl cache would exceed the maximum size");
+		g_array_free (items, TRUE);
+		return FALSE;
+	}
+
+	contents = g_byte_array_sized_new (strings_start + strings_size);
+
+	memcpy (header.magic, CACHE_MAGIC, sizeof (header.magic));
+	header.byte_order = CACHE_BYTE_ORDER;
+	header.version = CACHE_VERSION;
+	header.n_records = items->len;
+	g_byte_array_append (contents, (const guint8 *) &header, sizeof (header));
+
+	strings_size = 0;
+
+	for (i = 0; i < items->len; i++) {
+		SaveItem *item = &g_array_index (items, SaveItem, i);
+		const TrackerCrawlCacheEntry *item_entry;
+		CacheRecord record = { 0 };
+
+		item_entry = item->entry ? item->entry : &item->copy;
+
+		record.inode = item_entry->inode;
+		record.mtime = item_entry->mtime;
+		record.children_mtime_sum = item_entry->children_mtime_sum;
+		record.n_children = item_entry->n_children;
+		record.uri_offset = strings_start + strings_size;
+		g_byte_array_append (contents, (const guint8 *) &record, sizeof (record));
+
+		strings_size += strlen (item->uri) + 1;
+	}
+
+	for (i = 0; i < items->len; i++) {
+		const gchar *item_uri = g_array_index (items, SaveItem, i).uri;
+
+		g_byte_array_append (contents, (const guint8 *) item_uri,
+		                     strlen (item_uri) + 1);
+	}
+
+	dirname = g_path_get_dirname (cache->path);
+	g_mkdir_with_parents (dirname, 0700);
+	g_free (dirname);
+
+	/* The file is replaced atomically, so the mapped
+	 * snapshot stays valid until the cache is freed.
+	 */
+	retval = g_file_set_contents (cache->path,
+	                              (const gchar *) contents->data,
+	                              contents->len,
+	                              error);
+
+	if (retval) {
+		cache->dirty = FALSE;
+	}
+
+	g_byte_array_unref (contents);
+	g_array_free (items, TRUE);
+
+	return retval;
+}
+
+gboolean
+tracker_crawl_cache_entry_equal (const TrackerCrawlCacheEntry *a,
+                                 const TrackerCrawlCacheEntry *b)
+{
+	return (a->inode == b->inode &&
+	        a->mtime == b->mtime &&
+	        a->children_mtime_sum == b->children_mtime_sum &&
+	        a->n_children == b->n_children);
+}
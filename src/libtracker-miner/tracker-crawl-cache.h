@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __LIBTRACKER_MINER_CRAWL_CACHE_H__
+#define __LIBTRACKER_MINER_CRAWL_CACHE_H__
+
+#if !defined (__LIBTRACKER_MINER_H_INSIDE__) && !defined (TRACKER_COMPILATION)
+#error "Only <libtracker-miner/tracker-miner.h> can be included directly."
+#endif
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct _TrackerCrawlCache TrackerCrawlCache;
+typedef struct _TrackerCrawlCacheEntry TrackerCrawlCacheEntry;
+
+/* State of a crawled directory. Files modified in place keep
+ * the directory mtime, so the children mtimes are summed up
+ * to notice those too.
+ */
+struct _TrackerCrawlCacheEntry {
+	guint64 inode;
+	guint64 mtime;
+	guint64 children_mtime_sum;
+	guint32 n_children;
+};
+
+TrackerCrawlCache * tracker_crawl_cache_new          (const gchar                  *path);
+void                tracker_crawl_cache_free         (TrackerCrawlCache            *cache);
+
+gboolean            tracker_crawl_cache_lookup       (TrackerCrawlCache            *cache,
+                                                      GFile                        *directory,
+                                                      TrackerCrawlCacheEntry       *entry);
+
+void                tracker_crawl_cache_begin_tree   (TrackerCrawlCache            *cache,
+                                                      GFile                        *root);
+gboolean            tracker_crawl_cache_has_recorded (TrackerCrawlCache            *cache,
+                                                      GFile                        *directory);
+void                tracker_crawl_cache_record       (TrackerCrawlCache            *cache,
+                                                      GFile                        *directory,
+                                                      const TrackerCrawlCacheEntry *entry);
+
+gboolean            tracker_crawl_cache_save         (TrackerCrawlCache            *cache,
+                                                      GError                      **error);
+
+gboolean            tracker_crawl_cache_entry_equal  (const TrackerCrawlCacheEntry *a,
+                                                      const TrackerCrawlCacheEntry *b);
+
+G_END_DECLS
+
+#endif /* __LIBTRACKER_MINER_CRAWL_CACHE_H__ */
@@ -36,6 +36,13 @@
  */
 #define FILES_GROUP_SIZE             100
 
+/* This is the maximum number of directories being enumerated ahead
+ * of the one whose contents are being checked. Enumerations are
+ * run by GIO in its worker threads, so several of these will be in
+ * flight at a time, which hides the latency of slow filesystems.
+ */
+#define MAX_SIMULTANEOUS_ENUMERATIONS 8
+
 typedef struct DirectoryChildData DirectoryChildData;
 typedef struct DirectoryProcessingData DirectoryProcessingData;
 typedef struct DirectoryRootInfo DirectoryRootInfo;
@@ -50,6 +57,8 @@ struct DirectoryProcessingData {
 	GSList *children;
 	guint was_inspected : 1;
 	guint ignored_by_content : 1;
+	guint enumeration_started : 1;
+	guint enumeration_finished : 1;
 };
 
 struct DirectoryRootInfo {
@@ -59,6 +68,9 @@ struct DirectoryRootInfo {
 
 	GQueue *directory_processing_queue;
 
+	/* Directories in the processing queue waiting to be enumerated */
+	GQueue *directory_enumeration_queue;
+
 	/* Directory stats */
 	guint directories_found;
 	guint directories_ignored;
@@ -75,6 +87,9 @@ struct TrackerCrawlerPrivate {
 	/* Idle handler for processing found data */
 	guint           idle_id;
 
+	/* Directories being enumerated or waiting to be processed */
+	guint           n_enumerations;
+
 	gdouble         throttle;
 
 	gchar          *file_attributes;
@@ -382,6 +397,7 @@ directory_root_info_new (GFile    *file,
 	info->directory = g_object_ref (file);
 	info->recurse = recurse;
 	info->directory_processing_queue = g_queue_new ();
+	info->directory_enumeration_queue = g_queue_new ();
 
 	info->tree = g_node_new (g_object_ref (file));
 
@@ -431,10 +447,38 @@ directory_root_info_free (DirectoryRootInfo *info)
 			 (GFunc) directory_processing_data_free,
 			 NULL);
 	g_queue_free (info->directory_processing_queue);
+	g_queue_free (info->directory_enumeration_queue);
 
 	g_slice_free (DirectoryRootInfo, info);
 }
 
+static void
+directory_root_info_enumerate_ahead (TrackerCrawler    *crawler,
+                                     DirectoryRootInfo *info)
+{
+	TrackerCrawlerPrivate *priv;
+	DirectoryProcessingData *dir_data;
+
+	priv = crawler->priv;
+
+	/* Directories are enumerated in the same order they will
+	 * be processed, so the one at the head of the processing
+	 * queue is always the first one to get its children.
+	 */
+	while (priv->is_running &&
+	       priv->n_enumerations < MAX_SIMULTANEOUS_ENUMERATIONS) {
+		dir_data = g_queue_pop_head (info->directory_enumeration_queue);
+
+		if (!dir_data) {
+			break;
+		}
+
+		if (!dir_data->enumeration_started) {
+			file_enumerate_children (crawler, info, dir_data);
+		}
+	}
+}
+
 static gboolean
 process_func (gpointer data)
 {
@@ -479,15 +523,19 @@ process_func (gpointer data)
 			/* Crawler may have been already stopped while we were waiting for the
 			 *  check_directory return value, and thus we should check if it's
 			 *  running before going on with the iteration */
-			if (priv->is_running && iterate) {
-				/* Directory contents haven't been inspected yet,
-				 * stop this idle function while it's being iterated
-				 */
+			if (priv->is_running && iterate &&
+			    !dir_data->enumeration_started) {
 				file_enumerate_children (crawler, info, dir_data);
-				stop_idle = TRUE;
 			}
-		} else if (dir_data->was_inspected &&
-			   !dir_data->ignored_by_content &&
+		}
+
+		if (dir_data->enumeration_started &&
+		    !dir_data->enumeration_finished) {
+			/* Directory contents haven't been enumerated yet,
+			 * stop this idle function while it's being iterated
+			 */
+			stop_idle = TRUE;
+		} else if (!dir_data->ignored_by_content &&
 			   dir_data->children != NULL) {
 			DirectoryChildData *child_data;
 			GNode *child_node = NULL;
@@ -517,13 +565,23 @@ process_func (gpointer data)
 
 				child_dir_data = directory_processing_data_new (child_node);
 				g_queue_push_tail (info->directory_processing_queue, child_dir_data);
+				g_queue_push_tail (info->directory_enumeration_queue, child_dir_data);
+
+				directory_root_info_enumerate_ahead (crawler, info);
 			}
 
 			directory_child_data_free (child_data);
 		} else {
 			/* No (more) children, or directory ignored. stop processing. */
 			g_queue_pop_head (info->directory_processing_queue);
+
+			if (dir_data->enumeration_started) {
+				priv->n_enumerations--;
+			}
+
 			directory_processing_data_free (dir_data);
+
+			directory_root_info_enumerate_ahead (crawler, info);
 		}
 	} else if (!dir_data && info) {
 		/* Current directory being crawled doesn't have anything else
@@ -709,6 +767,7 @@ file_enumerate_next_cb (GObject      *object,
 		}
 
 		if (!cancelled) {
+			ed->dir_info->enumeration_finished = TRUE;
 			enumerator_data_process (ed);
 		}
 
@@ -798,6 +857,10 @@ file_enumerate_children_cb (GObject      *file,
 			g_free (path);
 		}
 
+		if (!cancelled) {
+			ed->dir_info->enumeration_finished = TRUE;
+		}
+
 		enumerator_data_free (ed);
 		process_func_start (crawler);
 		return;
@@ -817,6 +880,9 @@ file_enumerate_children (TrackerCrawler          *crawler,
 
 	ed = enumerator_data_new (crawler, info, dir_data);
 
+	dir_data->enumeration_started = TRUE;
+	crawler->priv->n_enumerations++;
+
 	if (crawler->priv->file_attributes) {
 		attrs = g_strconcat (FILE_ATTRIBUTES ",",
 		                     crawler->priv->file_attributes,
@@ -909,6 +975,7 @@ tracker_crawler_stop (TrackerCrawler *crawler)
 	/* Clean up queue */
 	g_queue_foreach (priv->directories, (GFunc) directory_root_info_free, NULL);
 	g_queue_clear (priv->directories);
+	priv->n_enumerations = 0;
 
 	g_signal_emit (crawler, signals[FINISHED], 0,
 	               !priv->is_finished);
@@ -27,13 +27,21 @@
 #include "tracker-file-notifier.h"
 #include "tracker-file-system.h"
 #include "tracker-crawler.h"
+#include "tracker-crawl-cache.h"
 #include "tracker-monitor.h"
 
+/* Changed directories queried one by one in incremental
+ * crawls, beyond this the whole tree is queried at once.
+ */
+#define MAX_DIRECTORY_QUERIES 500
+
 static GQuark quark_property_crawled = 0;
 static GQuark quark_property_queried = 0;
 static GQuark quark_property_iri = 0;
 static GQuark quark_property_store_mtime = 0;
 static GQuark quark_property_filesystem_mtime = 0;
+static GQuark quark_property_crawl_state = 0;
+static GQuark quark_property_crawl_pending = 0;
 
 enum {
 	PROP_0,
@@ -51,6 +59,12 @@ enum {
 	LAST_SIGNAL
 };
 
+/* Values of quark_property_crawl_state */
+enum {
+	CRAWL_STATE_CHANGED = 1,
+	CRAWL_STATE_UNCHANGED
+};
+
 static guint signals[LAST_SIGNAL] = { 0 };
 
 typedef struct {
@@ -71,7 +85,17 @@ typedef struct {
 	GList *pending_index_roots;
 	GFile *current_index_root;
 
+	/* State of the directories at the last crawl. If the current
+	 * root is crawled incrementally, only the directories that
+	 * changed since are queried and compared with the store.
+	 */
+	TrackerCrawlCache *crawl_cache;
+	GArray *crawl_records;
+	GQueue *directories_to_query;
+
 	guint stopped : 1;
+	guint querying : 1;
+	guint crawl_incremental : 1;
 } TrackerFileNotifierPrivate;
 
 typedef struct {
@@ -82,7 +106,22 @@ typedef struct {
 	GFile *cur_parent;
 } DirectoryCrawledData;
 
+typedef struct {
+	TrackerFileNotifier *notifier;
+	gboolean recurse;
+} CrawlStateData;
+
+typedef struct {
+	GFile *directory;
+	TrackerCrawlCacheEntry entry;
+} CrawlRecord;
+
 static gboolean crawl_directories_start (TrackerFileNotifier *notifier);
+static void     sparql_file_query_start (TrackerFileNotifier *notifier,
+                                         GFile               *file,
+                                         GFileType            file_type,
+                                         gboolean             recursive,
+                                         gboolean             sync);
 
 
 G_DEFINE_TYPE (TrackerFileNotifier, tracker_file_notifier, G_TYPE_OBJECT)
@@ -207,6 +246,171 @@ crawler_check_directory_contents_cb (TrackerCrawler *crawler,
 	return process;
 }
 
+static void
+crawl_record_clear (CrawlRecord *record)
+{
+	g_object_unref (record->directory);
+}
+
+static void
+file_notifier_crawl_state_reset (TrackerFileNotifier *notifier)
+{
+	TrackerFileNotifierPrivate *priv = notifier->priv;
+
+	priv->crawl_incremental = FALSE;
+	g_array_set_size (priv->crawl_records, 0);
+	g_queue_foreach (priv->directories_to_query,
+	                 (GFunc) g_object_unref, NULL);
+	g_queue_clear (priv->directories_to_query);
+}
+
+/* Whether @file was queried from the store in an incremental
+ * crawl, that is, it is a changed directory or a child of one.
+ */
+static gboolean
+file_notifier_crawl_state_is_queried (TrackerFileNotifier *notifier,
+                                      GFile               *file)
+{
+	TrackerFileNotifierPrivate *priv = notifier->priv;
+	GFile *parent;
+	guint state;
+
+	state = GPOINTER_TO_UINT (tracker_file_system_get_property (priv->file_system,
+	                                                            file,
+	                                                            quark_property_crawl_state));
+	if (state == CRAWL_STATE_CHANGED) {
+		return TRUE;
+	}
+
+	parent = tracker_file_system_peek_parent (priv->file_system, file);
+
+	if (!parent) {
+		return FALSE;
+	}
+
+	state = GPOINTER_TO_UINT (tracker_file_system_get_property (priv->file_system,
+	                                                            parent,
+	                                                            quark_property_crawl_state));
+	return state == CRAWL_STATE_CHANGED;
+}
+
+static void
+file_notifier_crawl_state_abort (TrackerFileNotifier *notifier)
+{
+	TrackerFileNotifierPrivate *priv = notifier->priv;
+	TrackerDirectoryFlags flags;
+
+	priv->crawl_incremental = FALSE;
+	g_queue_foreach (priv->directories_to_query,
+	                 (GFunc) g_object_unref, NULL);
+	g_queue_clear (priv->directories_to_query);
+
+	tracker_indexing_tree_get_root (priv->indexing_tree,
+	                                priv->current_index_root,
+	                                &flags);
+	sparql_file_query_start (notifier, priv->current_index_root,
+	                         G_FILE_TYPE_DIRECTORY,
+	                         (flags & TRACKER_DIRECTORY_FLAG_RECURSE) != 0,
+	                         FALSE);
+}
+
+/* Queries the next changed directory in an incremental crawl,
+ * returns FALSE if there's none left.
+ */
+static gboolean
+file_notifier_crawl_state_query_next (TrackerFileNotifier *notifier)
+{
+	TrackerFileNotifierPrivate *priv = notifier->priv;
+	GFile *directory;
+
+	if (g_queue_get_length (priv->directories_to_query) > MAX_DIRECTORY_QUERIES) {
+		/* Too much has changed, a single query
+		 * for the whole tree is cheaper.
+		 */
+		file_notifier_crawl_state_abort (notifier);
+		return TRUE;
+	}
+
+	directory = g_queue_pop_head (priv->directories_to_query);
+
+	if (!directory) {
+		return FALSE;
+	}
+
+	sparql_file_query_start (notifier, directory,
+	                         G_FILE_TYPE_DIRECTORY,
+	                         FALSE, FALSE);
+	g_object_unref (directory);
+
+	return TRUE;
+}
+
+/* Flags the parent directory of a notified file, the store
+ * doesn't match it yet, and processing the file may still fail.
+ */
+static void
+file_notifier_crawl_state_set_pending (TrackerFileNotifier *notifier,
+                                       GFile               *file)
+{
+	TrackerFileNotifierPrivate *priv = notifier->priv;
+	GFile *parent;
+
+	if (!priv->crawl_cache) {
+		return;
+	}
+
+	if (file == priv->current_index_root) {
+		return;
+	}
+
+	parent = tracker_file_system_peek_parent (priv->file_system, file);
+
+	if (parent) {
+		tracker_file_system_set_property (priv->file_system, parent,
+		                                  quark_property_crawl_pending,
+		                                  GUINT_TO_POINTER (TRUE));
+	}
+}
+
+static void
+file_notifier_crawl_state_commit (TrackerFileNotifier *notifier)
+{
+	TrackerFileNotifierPrivate *priv = notifier->priv;
+	guint i;
+
+	if (!priv->crawl_cache) {
+		return;
+	}
+
+	tracker_crawl_cache_begin_tree (priv->crawl_cache,
+	                                priv->current_index_root);
+
+	for (i = 0; i < priv->crawl_records->len; i++) {
+		CrawlRecord *record;
+
+		record = &g_array_index (priv->crawl_records, CrawlRecord, i);
+
+		if (tracker_file_system_get_property (priv->file_system,
+		                                      record->directory,
+		                                      quark_property_crawl_pending)) {
+			/* Left out, so the next crawl queries the
+			 * directory again and notices children that
+			 * failed to make it into the store.
+			 */
+			tracker_file_system_unset_property (priv->file_system,
+			                                    record->directory,
+			                                    quark_property_crawl_pending);
+			continue;
+		}
+
+		tracker_crawl_cache_record (priv->crawl_cache,
+		                            record->directory,
+		                            &record->entry);
+	}
+
+	g_array_set_size (priv->crawl_records, 0);
+}
+
 static gboolean
 file_notifier_traverse_tree_foreach (GFile    *file,
                                      gpointer  user_data)
@@ -218,6 +422,14 @@ file_notifier_traverse_tree_foreach (GFile    *file,
 	notifier = user_data;
 	priv = notifier->priv;
 
+	if (priv->crawl_incremental &&
+	    !file_notifier_crawl_state_is_queried (notifier, file)) {
+		/* Unchanged since the last crawl, which the
+		 * store is known to be up to date with.
+		 */
+		return FALSE;
+	}
+
 	store_mtime = tracker_file_system_get_property (priv->file_system, file,
 	                                                quark_property_store_mtime);
 	disk_mtime = tracker_file_system_get_property (priv->file_system, file,
@@ -225,15 +437,18 @@ file_notifier_traverse_tree_foreach (GFile    *file,
 
 	if (store_mtime && !disk_mtime) {
 		/* In store but not in disk, delete */
+		file_notifier_crawl_state_set_pending (notifier, file);
 		g_signal_emit (notifier, signals[FILE_DELETED], 0, file);
 
 		return TRUE;
 	} else if (disk_mtime && !store_mtime) {
 		/* In disk but not in store, create */
+		file_notifier_crawl_state_set_pending (notifier, file);
 		g_signal_emit (notifier, signals[FILE_CREATED], 0, file);
 	} else if (store_mtime && disk_mtime &&
 	           abs (*disk_mtime - *store_mtime) > 2) {
 		/* Mtime changed, update */
+		file_notifier_crawl_state_set_pending (notifier, file);
 		g_signal_emit (notifier, signals[FILE_UPDATED], 0, file, FALSE);
 	} else if (!store_mtime && !disk_mtime) {
 		/* what are we doing with such file? should happen rarely,
@@ -292,6 +507,11 @@ file_notifier_traverse_tree (TrackerFileNotifier *notifier)
 		                              G_LEVEL_ORDER,
 		                              file_notifier_traverse_tree_foreach,
 		                              notifier);
+
+		/* Directories with notified files are left out
+		 * until a crawl finds them matching the store.
+		 */
+		file_notifier_crawl_state_commit (notifier);
 	}
 
 	/* We dispose regular files here, only directories are cached once crawling
@@ -356,6 +576,81 @@ file_notifier_add_node_foreach (GNode    *node,
 	return FALSE;
 }
 
+static gboolean
+file_notifier_crawl_state_foreach (GNode    *node,
+                                   gpointer  user_data)
+{
+	CrawlStateData *data = user_data;
+	TrackerFileNotifierPrivate *priv;
+	TrackerCrawlCacheEntry entry, cached;
+	GFileInfo *file_info;
+	CrawlRecord record;
+	GFile *canonical;
+	GNode *child;
+
+	priv = data->notifier->priv;
+	file_info = tracker_crawler_get_file_info (priv->crawler, node->data);
+
+	/* Only directories whose contents were enumerated */
+	if (!file_info ||
+	    g_file_info_get_file_type (file_info) != G_FILE_TYPE_DIRECTORY ||
+	    (!G_NODE_IS_ROOT (node) && !data->recurse)) {
+		return FALSE;
+	}
+
+	canonical = tracker_file_system_peek_file (priv->file_system,
+	                                           node->data);
+	if (!canonical) {
+		return FALSE;
+	}
+
+	entry.inode = g_file_info_get_attribute_uint64 (file_info,
+	                                                G_FILE_ATTRIBUTE_UNIX_INODE);
+	entry.mtime = g_file_info_get_attribute_uint64 (file_info,
+	                                                G_FILE_ATTRIBUTE_TIME_MODIFIED);
+	entry.n_children = g_node_n_children (node);
+	entry.children_mtime_sum = 0;
+
+	for (child = node->children; child; child = child->next) {
+		GFileInfo *child_info;
+
+		child_info = tracker_crawler_get_file_info (priv->crawler,
+		                                            child->data);
+		if (child_info) {
+			entry.children_mtime_sum +=
+				g_file_info_get_attribute_uint64 (child_info,
+				                                  G_FILE_ATTRIBUTE_TIME_MODIFIED);
+		}
+	}
+
+	if (priv->crawl_incremental) {
+		guint state;
+
+		if (G_NODE_IS_ROOT (node)) {
+			/* Queried already, along with its children */
+			state = CRAWL_STATE_CHANGED;
+		} else if (tracker_crawl_cache_lookup (priv->crawl_cache,
+		                                       canonical, &cached) &&
+		           tracker_crawl_cache_entry_equal (&entry, &cached)) {
+			state = CRAWL_STATE_UNCHANGED;
+		} else {
+			state = CRAWL_STATE_CHANGED;
+			g_queue_push_tail (priv->directories_to_query,
+			                   g_object_ref (canonical));
+		}
+
+		tracker_file_system_set_property (priv->file_system, canonical,
+		                                  quark_property_crawl_state,
+		                                  GUINT_TO_POINTER (state));
+	}
+
+	record.directory = g_object_ref (canonical);
+	record.entry = entry;
+	g_array_append_val (priv->crawl_records, record);
+
+	return FALSE;
+}
+
 static void
 crawler_directory_crawled_cb (TrackerCrawler *crawler,
                               GFile          *directory,
@@ -377,6 +672,24 @@ crawler_directory_crawled_cb (TrackerCrawler *crawler,
 	                 file_notifier_add_node_foreach,
 	                 &data);
 
+	if (notifier->priv->crawl_cache) {
+		CrawlStateData state_data;
+		TrackerDirectoryFlags flags;
+
+		tracker_indexing_tree_get_root (notifier->priv->indexing_tree,
+		                                directory, &flags);
+
+		state_data.notifier = notifier;
+		state_data.recurse = (flags & TRACKER_DIRECTORY_FLAG_RECURSE) != 0;
+
+		g_node_traverse (tree,
+		                 G_PRE_ORDER,
+		                 G_TRAVERSE_ALL,
+		                 -1,
+		                 file_notifier_crawl_state_foreach,
+		                 &state_data);
+	}
+
 	g_signal_emit (notifier, signals[DIRECTORY_FINISHED], 0,
 	               directory,
 	               directories_found, directories_ignored,
@@ -464,6 +777,7 @@ sparql_query_cb (GObject      *object,
 	priv = notifier->priv;
 	cursor = tracker_sparql_connection_query_finish (TRACKER_SPARQL_CONNECTION (object),
 	                                                 result, &error);
+	priv->querying = FALSE;
 
 	if (!cursor || error) {
 		g_warning ("Could not query directory elements: %s\n", error->message);
@@ -472,6 +786,29 @@ sparql_query_cb (GObject      *object,
 	}
 
 	sparql_file_query_populate (notifier, cursor, TRUE);
+	g_object_unref (cursor);
+
+	if (priv->crawl_incremental) {
+		if (!tracker_file_system_get_property (priv->file_system,
+		                                       priv->current_index_root,
+		                                       quark_property_store_mtime)) {
+			/* The store doesn't know about the root, so
+			 * the crawl cache can't be trusted.
+			 */
+			file_notifier_crawl_state_abort (notifier);
+			return;
+		}
+
+		if (file_notifier_crawl_state_query_next (notifier) ||
+		    !tracker_file_system_get_property (priv->file_system,
+		                                       priv->current_index_root,
+		                                       quark_property_crawled)) {
+			/* Still changed directories to query, or
+			 * to be found by the crawler.
+			 */
+			return;
+		}
+	}
 
 	/* Mark the directory root as queried */
 	tracker_file_system_set_property (priv->file_system,
@@ -488,8 +825,6 @@ sparql_query_cb (GObject      *object,
 	                                      quark_property_crawled)) {
 		file_notifier_traverse_tree (notifier);
 	}
-
-	g_object_unref (cursor);
 }
 
 static void
@@ -505,23 +840,36 @@ sparql_file_query_start (TrackerFileNotifier *notifier,
 	priv = notifier->priv;
 	uri = g_file_get_uri (file);
 
+	/* Queries are split in UNIONs so each branch is answered
+	 * through the nie:url (or nfo:belongsToContainer) index,
+	 * a single FILTER with || ends up checking every DataObject.
+	 */
 	if (file_type == G_FILE_TYPE_DIRECTORY) {
 		if (recursive) {
 			sparql = g_strdup_printf ("select ?url ?u nfo:fileLastModified(?u) "
-			                          "where {"
-			                          "  ?u a nie:DataObject ; "
-			                          "     nie:url ?url . "
-			                          "  FILTER (?url = \"%s\" || "
-			                          "          fn:starts-with (?url, \"%s/\")) "
+			                          "where { "
+			                          "  { "
+			                          "    ?u a nie:DataObject ; "
+			                          "       nie:url ?url . "
+			                          "    FILTER (?url = \"%s\") "
+			                          "  } UNION { "
+			                          "    ?u a nie:DataObject ; "
+			                          "       nie:url ?url . "
+			                          "    FILTER (fn:starts-with (?url, \"%s/\")) "
+			                          "  } "
 			                          "}", uri, uri);
 		} else {
 			sparql = g_strdup_printf ("select ?url ?u nfo:fileLastModified(?u) "
 			                          "where { "
-			                          "  ?u a nie:DataObject ; "
-			                          "     nie:url ?url . "
-			                          "  OPTIONAL { ?u nfo:belongsToContainer ?p } . "
-			                          "  FILTER (?url = \"%s\" || "
-			                          "          nie:url(?p) = \"%s\") "
+			                          "  { "
+			                          "    ?u a nie:DataObject ; "
+			                          "       nie:url ?url . "
+			                          "    FILTER (?url = \"%s\") "
+			                          "  } UNION { "
+			                          "    ?p nie:url \"%s\" . "
+			                          "    ?u nfo:belongsToContainer ?p ; "
+			                          "       nie:url ?url . "
+			                          "  } "
 			                          "}", uri, uri);
 		}
 	} else {
@@ -544,6 +892,7 @@ sparql_file_query_start (TrackerFileNotifier *notifier,
 			g_object_unref (cursor);
 		}
 	} else {
+		priv->querying = TRUE;
 		tracker_sparql_connection_query_async (priv->connection,
 		                                       sparql,
 		                                       priv->cancellable,
@@ -555,6 +904,33 @@ sparql_file_query_start (TrackerFileNotifier *notifier,
 	g_free (uri);
 }
 
+static gboolean
+file_notifier_can_crawl_incrementally (TrackerFileNotifier   *notifier,
+                                       GFile                 *directory,
+                                       TrackerDirectoryFlags  flags)
+{
+	TrackerFileNotifierPrivate *priv = notifier->priv;
+
+	if (!priv->crawl_cache) {
+		return FALSE;
+	}
+
+	/* Only configured roots checked on startup, everything
+	 * else is a response to changes noticed while running.
+	 */
+	if ((flags & TRACKER_DIRECTORY_FLAG_RECURSE) == 0 ||
+	    (flags & TRACKER_DIRECTORY_FLAG_CHECK_MTIME) == 0 ||
+	    !tracker_indexing_tree_file_is_root (priv->indexing_tree, directory)) {
+		return FALSE;
+	}
+
+	/* Once recorded in this session, the cache contents
+	 * might be ahead of the store.
+	 */
+	return (tracker_crawl_cache_lookup (priv->crawl_cache, directory, NULL) &&
+	        !tracker_crawl_cache_has_recorded (priv->crawl_cache, directory));
+}
+
 static gboolean
 crawl_directories_start (TrackerFileNotifier *notifier)
 {
@@ -592,22 +968,34 @@ crawl_directories_start (TrackerFileNotifier *notifier)
 
 		g_cancellable_reset (priv->cancellable);
 
+		file_notifier_crawl_state_reset (notifier);
+		priv->crawl_incremental =
+			file_notifier_can_crawl_incrementally (notifier,
+			                                       directory,
+			                                       flags);
+
 		if ((flags & TRACKER_DIRECTORY_FLAG_IGNORE) == 0 &&
 		    tracker_crawler_start (priv->crawler,
 		                           directory,
 		                           (flags & TRACKER_DIRECTORY_FLAG_RECURSE) != 0)) {
 			gchar *uri;
 
+			/* If crawling incrementally, only the root and its
+			 * children are queried now, the changed directories
+			 * are queried as they are found.
+			 */
 			sparql_file_query_start (notifier, directory,
 			                         G_FILE_TYPE_DIRECTORY,
-			                         (flags & TRACKER_DIRECTORY_FLAG_RECURSE) != 0,
+			                         (flags & TRACKER_DIRECTORY_FLAG_RECURSE) != 0 &&
+			                         !priv->crawl_incremental,
 			                         FALSE);
 
 			g_timer_reset (priv->timer);
 			g_signal_emit (notifier, signals[DIRECTORY_STARTED], 0, directory);
 
 			uri = g_file_get_uri (directory);
-			tracker_info ("Started inspecting '%s'", uri);
+			tracker_info ("Started inspecting '%s'%s", uri,
+			              priv->crawl_incremental ? " (incremental)" : "");
 			g_free (uri);
 
 			return TRUE;
@@ -652,6 +1040,15 @@ crawler_finished_cb (TrackerCrawler *crawler,
 		                                  quark_property_crawled,
 		                                  GUINT_TO_POINTER (TRUE));
 
+		if (priv->crawl_incremental && !priv->querying &&
+		    !file_notifier_crawl_state_query_next (notifier)) {
+			/* Every changed directory was queried already */
+			tracker_file_system_set_property (priv->file_system,
+			                                  directory,
+			                                  quark_property_queried,
+			                                  GUINT_TO_POINTER (TRUE));
+		}
+
 		/* If it's also been queried, finish operation */
 		if (tracker_file_system_get_property (priv->file_system,
 		                                      directory,
@@ -877,6 +1274,47 @@ monitor_item_deleted_cb (TrackerMonitor *monitor,
 	                                  G_FILE_TYPE_UNKNOWN);
 }
 
+static void
+monitor_directory_rescan_cb (TrackerMonitor *monitor,
+                             GFile          *directory,
+                             gpointer        user_data)
+{
+	TrackerFileNotifier *notifier = user_data;
+	TrackerFileNotifierPrivate *priv = notifier->priv;
+	TrackerDirectoryFlags flags;
+	gboolean start_crawler;
+	GFile *canonical;
+
+	if (!tracker_indexing_tree_file_is_indexable (priv->indexing_tree,
+	                                              directory,
+	                                              G_FILE_TYPE_DIRECTORY)) {
+		return;
+	}
+
+	/* Changes in the directory may have gone unnoticed, crawl
+	 * it again, only the items whose mtime differs from the
+	 * one in the store will be notified.
+	 */
+	tracker_indexing_tree_get_root (priv->indexing_tree, directory, &flags);
+	canonical = tracker_file_system_get_file (priv->file_system, directory,
+	                                          G_FILE_TYPE_DIRECTORY, NULL);
+
+	if (canonical == priv->current_index_root ||
+	    g_list_find (priv->pending_index_roots, canonical)) {
+		return;
+	}
+
+	start_crawler = (!priv->stopped &&
+	                 !priv->pending_index_roots &&
+	                 !priv->current_index_root);
+
+	notifier_queue_file (notifier, canonical, flags);
+
+	if (start_crawler) {
+		crawl_directories_start (notifier);
+	}
+}
+
 static void
 monitor_item_moved_cb (TrackerMonitor *monitor,
                        GFile          *file,
@@ -1122,6 +1560,14 @@ tracker_file_notifier_finalize (GObject *object)
 	g_list_free (priv->pending_index_roots);
 	g_timer_destroy (priv->timer);
 
+	file_notifier_crawl_state_reset (TRACKER_FILE_NOTIFIER (object));
+	g_array_unref (priv->crawl_records);
+	g_queue_free (priv->directories_to_query);
+
+	if (priv->crawl_cache) {
+		tracker_crawl_cache_free (priv->crawl_cache);
+	}
+
 	G_OBJECT_CLASS (tracker_file_notifier_parent_class)->finalize (object);
 }
 
@@ -1250,6 +1696,12 @@ tracker_file_notifier_class_init (TrackerFileNotifierClass *klass)
 	quark_property_filesystem_mtime = g_quark_from_static_string ("tracker-property-filesystem-mtime");
 	tracker_file_system_register_property (quark_property_filesystem_mtime,
 	                                       g_free);
+
+	quark_property_crawl_state = g_quark_from_static_string ("tracker-property-crawl-state");
+	tracker_file_system_register_property (quark_property_crawl_state, NULL);
+
+	quark_property_crawl_pending = g_quark_from_static_string ("tracker-property-crawl-pending");
+	tracker_file_system_register_property (quark_property_crawl_pending, NULL);
 }
 
 static void
@@ -1280,11 +1732,17 @@ tracker_file_notifier_init (TrackerFileNotifier *notifier)
 	priv->timer = g_timer_new ();
 	priv->stopped = TRUE;
 
+	priv->crawl_records = g_array_new (FALSE, FALSE, sizeof (CrawlRecord));
+	g_array_set_clear_func (priv->crawl_records,
+	                        (GDestroyNotify) crawl_record_clear);
+	priv->directories_to_query = g_queue_new ();
+
 	/* Set up crawler */
 	priv->crawler = tracker_crawler_new ();
 	tracker_crawler_set_file_attributes (priv->crawler,
 	                                     G_FILE_ATTRIBUTE_TIME_MODIFIED ","
-	                                     G_FILE_ATTRIBUTE_STANDARD_TYPE);
+	                                     G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+	                                     G_FILE_ATTRIBUTE_UNIX_INODE);
 
 	g_signal_connect (priv->crawler, "check-file",
 	                  G_CALLBACK (crawler_check_file_cb),
@@ -1320,6 +1778,9 @@ tracker_file_notifier_init (TrackerFileNotifier *notifier)
 	g_signal_connect (priv->monitor, "item-moved",
 	                  G_CALLBACK (monitor_item_moved_cb),
 	                  notifier);
+	g_signal_connect (priv->monitor, "directory-rescan",
+	                  G_CALLBACK (monitor_directory_rescan_cb),
+	                  notifier);
 }
 
 TrackerFileNotifier *
@@ -1416,3 +1877,63 @@ tracker_file_notifier_get_file_iri (TrackerFileNotifier *notifier,
 
 	return iri;
 }
+
+/**
+ * tracker_file_notifier_set_crawl_cache:
+ * @notifier: a #TrackerFileNotifier
+ * @path: (allow-none): location of the crawl cache, or %NULL
+ *
+ * Sets the file keeping the state of the directories found by
+ * the last crawl. Directory trees with mtime checks are then
+ * crawled incrementally, only directories that changed since,
+ * or had files notified by the last crawl, are compared with
+ * the store contents.
+ **/
+void
+tracker_file_notifier_set_crawl_cache (TrackerFileNotifier *notifier,
+                                       const gchar         *path)
+{
+	TrackerFileNotifierPrivate *priv;
+
+	g_return_if_fail (TRACKER_IS_FILE_NOTIFIER (notifier));
+
+	priv = notifier->priv;
+
+	if (priv->crawl_cache) {
+		tracker_crawl_cache_free (priv->crawl_cache);
+		priv->crawl_cache = NULL;
+	}
+
+	if (path) {
+		priv->crawl_cache = tracker_crawl_cache_new (path);
+	}
+}
+
+/**
+ * tracker_file_notifier_save_crawl_cache:
+ * @notifier: a #TrackerFileNotifier
+ *
+ * Saves the state of the directories crawled so far. This
+ * must only be called once all notified files were processed,
+ * the crawl cache is expected to match the store contents.
+ **/
+void
+tracker_file_notifier_save_crawl_cache (TrackerFileNotifier *notifier)
+{
+	TrackerFileNotifierPrivate *priv;
+	GError *error = NULL;
+
+	g_return_if_fail (TRACKER_IS_FILE_NOTIFIER (notifier));
+
+	priv = notifier->priv;
+
+	if (!priv->crawl_cache ||
+	    tracker_file_notifier_is_active (notifier)) {
+		return;
+	}
+
+	if (!tracker_crawl_cache_save (priv->crawl_cache, &error)) {
+		g_warning ("Could not save crawl cache: %s", error->message);
+		g_error_free (error);
+	}
+}
@@ -40,13 +40,22 @@ struct _FileNodeProperty {
 	gpointer value;
 };
 
+/* Each node is a single allocation holding the GNode links, the
+ * node data and the uri suffix, node.data points back to the struct
+ * itself. The suffix is only moved to a separate allocation if the
+ * node gets reparented. Properties are kept in an exactly sized,
+ * sorted array which is not allocated at all for nodes without them.
+ */
 struct _FileNodeData {
+	GNode node;
 	GFile *file;
 	gchar *uri_suffix;
-	GArray *properties;
+	FileNodeProperty *properties;
+	guint n_properties;
 	guint shallow   : 1;
 	guint unowned : 1;
 	guint file_type : 4;
+	gchar inline_suffix[1];
 };
 
 struct _NodeLookupData {
@@ -83,6 +92,7 @@ file_node_data_free (FileNodeData *data,
                      GNode        *node)
 {
 	guint i;
+	gsize size;
 
 	if (data->file) {
 		if (!data->shallow) {
@@ -97,14 +107,12 @@ file_node_data_free (FileNodeData *data,
 	}
 
 	data->file = NULL;
-	g_free (data->uri_suffix);
 
-	for (i = 0; i < data->properties->len; i++) {
+	for (i = 0; i < data->n_properties; i++) {
 		FileNodeProperty *property;
 		GDestroyNotify destroy_notify;
 
-		property = &g_array_index (data->properties,
-		                           FileNodeProperty, i);
+		property = &data->properties[i];
 
 		destroy_notify = g_hash_table_lookup (properties,
 		                                      GUINT_TO_POINTER (property->prop_quark));
@@ -114,24 +122,48 @@ file_node_data_free (FileNodeData *data,
 		}
 	}
 
-	g_array_free (data->properties, TRUE);
-	g_slice_free (FileNodeData, data);
+	g_free (data->properties);
+
+	size = G_STRUCT_OFFSET (FileNodeData, inline_suffix) + 1 +
+		strlen (data->inline_suffix);
+
+	if (data->uri_suffix != data->inline_suffix) {
+		g_free (data->uri_suffix);
+	}
+
+	g_slice_free1 (size, data);
+}
+
+static FileNodeData *
+file_node_data_alloc (const gchar *uri_suffix)
+{
+	FileNodeData *data;
+	gsize len;
+
+	len = strlen (uri_suffix);
+	data = g_slice_alloc0 (G_STRUCT_OFFSET (FileNodeData, inline_suffix) + len + 1);
+	memcpy (data->inline_suffix, uri_suffix, len);
+	data->uri_suffix = data->inline_suffix;
+	data->node.data = data;
+
+	return data;
 }
 
 static FileNodeData *
 file_node_data_new (TrackerFileSystem *file_system,
                     GFile             *file,
                     GFileType          file_type,
-                    GNode             *node)
+                    const gchar       *uri_suffix)
 {
 	FileNodeData *data;
 	NodeLookupData lookup_data;
 	GArray *node_data;
+	GNode *node;
 
-	data = g_slice_new0 (FileNodeData);
+	data = file_node_data_alloc (uri_suffix);
+	node = &data->node;
 	data->file = g_object_ref (file);
 	data->file_type = file_type;
-	data->properties = g_array_new (FALSE, TRUE, sizeof (FileNodeProperty));
 
 	/* We use weak refs to keep track of files */
 	g_object_weak_ref (G_OBJECT (data->file), file_weak_ref_notify, node);
@@ -151,9 +183,6 @@ file_node_data_new (TrackerFileSystem *file_system,
 	lookup_data.node = node;
 	g_array_append_val (node_data, lookup_data);
 
-	g_assert (node->data == NULL);
-	node->data = data;
-
 	return data;
 }
 
@@ -162,10 +191,8 @@ file_node_data_root_new (void)
 {
 	FileNodeData *data;
 
-	data = g_slice_new0 (FileNodeData);
-	data->uri_suffix = g_strdup ("file:///");
+	data = file_node_data_alloc ("file:///");
 	data->file = g_file_new_for_uri (data->uri_suffix);
-	data->properties = g_array_new (FALSE, TRUE, sizeof (FileNodeProperty));
 	data->file_type = G_FILE_TYPE_DIRECTORY;
 	data->shallow = TRUE;
 
@@ -326,12 +353,23 @@ file_tree_lookup (GNode     *tree,
 	return node_found;
 }
 
-static gboolean
-file_tree_free_node_foreach (GNode    *node,
-                             gpointer  user_data)
+static void
+file_tree_free (GNode *node)
 {
+	GNode *child, *next;
+
+	/* Nodes are freed along with their data,
+	 * so g_node_destroy() can't be used here.
+	 */
+	child = g_node_first_child (node);
+
+	while (child) {
+		next = g_node_next_sibling (child);
+		file_tree_free (child);
+		child = next;
+	}
+
 	file_node_data_free (node->data, node);
-	return FALSE;
 }
 
 /* TrackerFileSystem implementation */
@@ -343,12 +381,7 @@ tracker_file_system_finalize (GObject *object)
 
 	priv = TRACKER_FILE_SYSTEM (object)->priv;
 
-	g_node_traverse (priv->file_tree,
-	                 G_POST_ORDER,
-	                 G_TRAVERSE_ALL, -1,
-	                 file_tree_free_node_foreach,
-	                 NULL);
-	g_node_destroy (priv->file_tree);
+	file_tree_free (priv->file_tree);
 
 	G_OBJECT_CLASS (tracker_file_system_parent_class)->finalize (object);
 }
@@ -378,7 +411,7 @@ tracker_file_system_init (TrackerFileSystem *file_system)
 		                             TrackerFileSystemPrivate);
 
 	root_data = file_node_data_root_new ();
-	priv->file_tree = g_node_new (root_data);
+	priv->file_tree = &root_data->node;
 }
 
 TrackerFileSystem *
@@ -414,7 +447,10 @@ reparent_child_nodes_to_parent (GNode *node)
 					      node_data->uri_suffix,
 					      data->uri_suffix);
 
-		g_free (data->uri_suffix);
+		if (data->uri_suffix != data->inline_suffix) {
+			g_free (data->uri_suffix);
+		}
+
 		data->uri_suffix = uri_suffix;
 
 		g_node_unlink (cur);
@@ -438,8 +474,8 @@ file_weak_ref_notify (gpointer  user_data,
 	reparent_child_nodes_to_parent (node);
 
 	/* Delete node tree here */
+	g_node_unlink (node);
 	file_node_data_free (data, NULL);
-	g_node_destroy (node);
 }
 
 static GNode *
@@ -513,14 +549,12 @@ tracker_file_system_get_file (TrackerFileSystem *file_system,
 			return NULL;
 		}
 
-		node = g_node_new (NULL);
-
 		/* Parent was found, add file as child */
 		data = file_node_data_new (file_system, file,
-		                           file_type, node);
-		data->uri_suffix = uri_suffix;
+		                           file_type, uri_suffix);
+		g_free (uri_suffix);
 
-		g_node_append (parent_node, node);
+		g_node_append (parent_node, &data->node);
 	} else {
 		data = node->data;
 		g_free (uri_suffix);
@@ -727,8 +761,8 @@ tracker_file_system_set_property (TrackerFileSystem *file_system,
 	data = node->data;
 
 	property.prop_quark = prop;
-	match = bsearch (&property, data->properties->data,
-	                 data->properties->len, sizeof (FileNodeProperty),
+	match = bsearch (&property, data->properties,
+	                 data->n_properties, sizeof (FileNodeProperty),
 	                 search_property_node);
 
 	if (match) {
@@ -738,26 +772,23 @@ tracker_file_system_set_property (TrackerFileSystem *file_system,
 
 		match->value = prop_data;
 	} else {
-		FileNodeProperty *item;
 		guint i;
 
 		/* No match, insert new element */
-		for (i = 0; i < data->properties->len; i++) {
-			item = &g_array_index (data->properties,
-			                       FileNodeProperty, i);
-
-			if (item->prop_quark > prop) {
+		for (i = 0; i < data->n_properties; i++) {
+			if (data->properties[i].prop_quark > prop) {
 				break;
 			}
 		}
 
-		property.value = prop_data;
+		data->properties = g_renew (FileNodeProperty, data->properties,
+		                            data->n_properties + 1);
+		memmove (&data->properties[i + 1], &data->properties[i],
+		         (data->n_properties - i) * sizeof (FileNodeProperty));
+		data->n_properties++;
 
-		if (i >= data->properties->len) {
-			g_array_append_val (data->properties, property);
-		} else {
-			g_array_insert_val (data->properties, i, property);
-		}
+		property.value = prop_data;
+		data->properties[i] = property;
 	}
 }
 
@@ -780,8 +811,8 @@ tracker_file_system_get_property (TrackerFileSystem *file_system,
 	data = node->data;
 	property.prop_quark = prop;
 
-	match = bsearch (&property, data->properties->data,
-	                 data->properties->len, sizeof (FileNodeProperty),
+	match = bsearch (&property, data->properties,
+	                 data->n_properties, sizeof (FileNodeProperty),
 	                 search_property_node);
 
 	return (match) ? match->value : NULL;
@@ -817,8 +848,8 @@ tracker_file_system_unset_property (TrackerFileSystem *file_system,
 	data = node->data;
 	property.prop_quark = prop;
 
-	match = bsearch (&property, data->properties->data,
-	                 data->properties->len, sizeof (FileNodeProperty),
+	match = bsearch (&property, data->properties,
+	                 data->n_properties, sizeof (FileNodeProperty),
 	                 search_property_node);
 
 	if (!match) {
@@ -830,11 +861,20 @@ tracker_file_system_unset_property (TrackerFileSystem *file_system,
 	}
 
 	/* Find out the index from memory positions */
-	index = (guint) ((FileNodeProperty *) match -
-	                 (FileNodeProperty *) data->properties->data);
-	g_assert (index < data->properties->len);
+	index = (guint) (match - data->properties);
+	g_assert (index < data->n_properties);
+
+	data->n_properties--;
 
-	g_array_remove_index (data->properties, index);
+	if (data->n_properties == 0) {
+		g_free (data->properties);
+		data->properties = NULL;
+	} else {
+		memmove (&data->properties[index], &data->properties[index + 1],
+		         (data->n_properties - index) * sizeof (FileNodeProperty));
+		data->properties = g_renew (FileNodeProperty, data->properties,
+		                            data->n_properties);
+	}
 }
 
 typedef struct {
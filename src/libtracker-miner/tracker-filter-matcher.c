@@ -0,0 +1,367 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <gio/gio.h>
+
+#include "tracker-filter-matcher.h"
+
+/* Glob patterns are sorted into the cheapest structure able to
+ * match them:
+ *
+ *   - "name" literals go into a hash set.
+ *   - "*suffix" patterns (extensions, backup files...) go into a
+ *     trie built on the reversed suffix.
+ *   - "prefix*" patterns go into a trie built on the prefix.
+ *   - Absolute paths go into a trie of paths, matching the path
+ *     itself and everything below it.
+ *   - Anything else is left to GPatternSpec.
+ *
+ * So matching a name costs one hash lookup and one walk over
+ * each trie, no matter how many patterns there are.
+ */
+
+typedef struct _TrieNode TrieNode;
+
+struct _TrieNode
+{
+	guint32 child;
+	guint32 sibling;
+	guint8 byte;
+	guint8 terminal;
+};
+
+struct _TrackerFilterMatcher
+{
+	GHashTable *literals;
+	GArray *suffixes;
+	GArray *prefixes;
+	GArray *paths;
+	GPtrArray *patterns;
+
+	guint n_patterns;
+};
+
+/* Tries are flat arrays of nodes, node 0 being the root, so
+ * 0 doubles as "no node" in child and sibling links.
+ */
+static GArray *
+trie_new (void)
+{
+	TrieNode root = { 0 };
+	GArray *trie;
+
+	trie = g_array_new (FALSE, FALSE, sizeof (TrieNode));
+	g_array_append_val (trie, root);
+
+	return trie;
+}
+
+static inline guint32
+trie_lookup_child (GArray *trie,
+                   guint32 node,
+                   guint8  byte)
+{
+	guint32 child;
+
+	child = g_array_index (trie, TrieNode, node).child;
+
+	while (child != 0) {
+		TrieNode *child_node = &g_array_index (trie, TrieNode, child);
+
+		if (child_node->byte == byte) {
+			return child;
+		}
+
+		child = child_node->sibling;
+	}
+
+	return 0;
+}
+
+static void
+trie_insert (GArray      *trie,
+             const gchar *str,
+             gsize        len,
+             gboolean     reversed)
+{
+	guint32 node = 0;
+	gsize i;
+
+	for (i = 0; i < len; i++) {
+		guint8 byte;
+		guint32 child;
+
+		byte = (guint8) str[reversed ? len - i - 1 : i];
+		child = trie_lookup_child (trie, node, byte);
+
+		if (child == 0) {
+			TrieNode new_node = { 0 };
+
+			new_node.byte = byte;
+			new_node.sibling = g_array_index (trie, TrieNode, node).child;
+			g_array_append_val (trie, new_node);
+
+			child = trie->len - 1;
+			g_array_index (trie, TrieNode, node).child = child;
+		}
+
+		node = child;
+	}
+
+	g_array_index (trie, TrieNode, node).terminal = TRUE;
+}
+
+static gboolean
+trie_match_prefix (GArray      *trie,
+                   const gchar *str)
+{
+	guint32 node = 0;
+
+	while (TRUE) {
+		if (g_array_index (trie, TrieNode, node).terminal) {
+			return TRUE;
+		}
+
+		if (*str == '\0') {
+			return FALSE;
+		}
+
+		node = trie_lookup_child (trie, node, (guint8) *str);
+
+		if (node == 0) {
+			return FALSE;
+		}
+
+		str++;
+	}
+}
+
+static gboolean
+trie_match_suffix (GArray      *trie,
+                   const gchar *str,
+                   gsize        len)
+{
+	guint32 node = 0;
+
+	while (TRUE) {
+		if (g_array_index (trie, TrieNode, node).terminal) {
+			return TRUE;
+		}
+
+		if (len == 0) {
+			return FALSE;
+		}
+
+		len--;
+		node = trie_lookup_child (trie, node, (guint8) str[len]);
+
+		if (node == 0) {
+			return FALSE;
+		}
+	}
+}
+
+static gboolean
+trie_match_path (GArray      *trie,
+                 const gchar *path)
+{
+	guint32 node = 0;
+	const gchar *p = path;
+
+	while (TRUE) {
+		/* Only match at component boundaries, so /a
+		 * doesn't match /ab, but both / and /a match
+		 * /a/b.
+		 */
+		if (g_array_index (trie, TrieNode, node).terminal &&
+		    (*p == '/' || *p == '\0' ||
+		     (p > path && p[-1] == '/'))) {
+			return TRUE;
+		}
+
+		if (*p == '\0') {
+			return FALSE;
+		}
+
+		node = trie_lookup_child (trie, node, (guint8) *p);
+
+		if (node == 0) {
+			return FALSE;
+		}
+
+		p++;
+	}
+}
+
+TrackerFilterMatcher *
+tracker_filter_matcher_new (void)
+{
+	TrackerFilterMatcher *matcher;
+
+	matcher = g_slice_new0 (TrackerFilterMatcher);
+	matcher->literals = g_hash_table_new_full (g_str_hash, g_str_equal,
+	                                           g_free, NULL);
+	matcher->suffixes = trie_new ();
+	matcher->prefixes = trie_new ();
+	matcher->paths = trie_new ();
+	matcher->patterns = g_ptr_array_new_with_free_func ((GDestroyNotify) g_pattern_spec_free);
+
+	return matcher;
+}
+
+void
+tracker_filter_matcher_free (TrackerFilterMatcher *matcher)
+{
+	g_return_if_fail (matcher != NULL);
+
+	g_hash_table_unref (matcher->literals);
+	g_array_unref (matcher->suffixes);
+	g_array_unref (matcher->prefixes);
+	g_array_unref (matcher->paths);
+	g_ptr_array_unref (matcher->patterns);
+
+	g_slice_free (TrackerFilterMatcher, matcher);
+}
+
+static void
+filter_matcher_add_path (TrackerFilterMatcher *matcher,
+                         const gchar          *path)
+{
+	gchar *canonical_path;
+	GFile *file;
+
+	/* Canonicalize the same way GFile does with
+	 * the files later given for matching.
+	 */
+	file = g_file_new_for_path (path);
+	canonical_path = g_file_get_path (file);
+	g_object_unref (file);
+
+	if (canonical_path) {
+		trie_insert (matcher->paths, canonical_path,
+		             strlen (canonical_path), FALSE);
+		g_free (canonical_path);
+	}
+}
+
+void
+tracker_filter_matcher_add (TrackerFilterMatcher *matcher,
+                            const gchar          *glob_string)
+{
+	const gchar *wildcard;
+	gsize len;
+
+	g_return_if_fail (matcher != NULL);
+	g_return_if_fail (glob_string != NULL);
+
+	matcher->n_patterns++;
+
+	if (g_path_is_absolute (glob_string)) {
+		/* Basenames never contain a slash, so the
+		 * pattern may only match as a path.
+		 */
+		filter_matcher_add_path (matcher, glob_string);
+		return;
+	}
+
+	len = strlen (glob_string);
+	wildcard = strpbrk (glob_string, "*?");
+
+	if (!wildcard) {
+		g_hash_table_add (matcher->literals, g_strdup (glob_string));
+	} else if (wildcard == glob_string &&
+	           *wildcard == '*' &&
+	           !strpbrk (glob_string + 1, "*?")) {
+		trie_insert (matcher->suffixes, glob_string + 1, len - 1, TRUE);
+	} else if (wildcard == &glob_string[len - 1] &&
+	           *wildcard == '*') {
+		trie_insert (matcher->prefixes, glob_string, len - 1, FALSE);
+	} else {
+		g_ptr_array_add (matcher->patterns,
+		                 g_pattern_spec_new (glob_string));
+	}
+}
+
+gboolean
+tracker_filter_matcher_is_empty (TrackerFilterMatcher *matcher)
+{
+	g_return_val_if_fail (matcher != NULL, TRUE);
+
+	return matcher->n_patterns == 0;
+}
+
+/**
+ * tracker_filter_matcher_match_name:
+ * @matcher: a #TrackerFilterMatcher
+ * @name: a file basename
+ *
+ * Returns: %TRUE if @name matches any of the added globs.
+ **/
+gboolean
+tracker_filter_matcher_match_name (TrackerFilterMatcher *matcher,
+                                   const gchar          *name)
+{
+	gsize len;
+	guint i;
+
+	g_return_val_if_fail (matcher != NULL, FALSE);
+	g_return_val_if_fail (name != NULL, FALSE);
+
+	if (g_hash_table_contains (matcher->literals, name)) {
+		return TRUE;
+	}
+
+	len = strlen (name);
+
+	if (trie_match_suffix (matcher->suffixes, name, len) ||
+	    trie_match_prefix (matcher->prefixes, name)) {
+		return TRUE;
+	}
+
+	for (i = 0; i < matcher->patterns->len; i++) {
+		if (g_pattern_match (g_ptr_array_index (matcher->patterns, i),
+		                     len, name, NULL)) {
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+/**
+ * tracker_filter_matcher_match_path:
+ * @matcher: a #TrackerFilterMatcher
+ * @path: a canonical absolute path
+ *
+ * Returns: %TRUE if @path is, or is contained in, any of
+ *          the absolute paths added.
+ **/
+gboolean
+tracker_filter_matcher_match_path (TrackerFilterMatcher *matcher,
+                                   const gchar          *path)
+{
+	g_return_val_if_fail (matcher != NULL, FALSE);
+	g_return_val_if_fail (path != NULL, FALSE);
+
+	return trie_match_path (matcher->paths, path);
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __LIBTRACKER_MINER_FILTER_MATCHER_H__
+#define __LIBTRACKER_MINER_FILTER_MATCHER_H__
+
+#if !defined (__LIBTRACKER_MINER_H_INSIDE__) && !defined (TRACKER_COMPILATION)
+#error "Only <libtracker-miner/tracker-miner.h> can be included directly."
+#endif
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _TrackerFilterMatcher TrackerFilterMatcher;
+
+TrackerFilterMatcher * tracker_filter_matcher_new        (void);
+void                   tracker_filter_matcher_free       (TrackerFilterMatcher *matcher);
+
+void                   tracker_filter_matcher_add        (TrackerFilterMatcher *matcher,
+                                                          const gchar          *glob_string);
+
+gboolean               tracker_filter_matcher_is_empty   (TrackerFilterMatcher *matcher);
+
+gboolean               tracker_filter_matcher_match_name (TrackerFilterMatcher *matcher,
+                                                          const gchar          *name);
+gboolean               tracker_filter_matcher_match_path (TrackerFilterMatcher *matcher,
+                                                          const gchar          *path);
+
+G_END_DECLS
+
+#endif /* __LIBTRACKER_MINER_FILTER_MATCHER_H__ */
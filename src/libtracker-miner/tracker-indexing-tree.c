@@ -19,8 +19,11 @@
  * Author: Carlos Garnacho  <carlos@lanedo.com>
  */
 
+#include <string.h>
+
 #include <libtracker-common/tracker-file-utils.h>
 #include "tracker-indexing-tree.h"
+#include "tracker-filter-matcher.h"
 
 /**
  * SECTION:tracker-indexing-tree
@@ -34,7 +37,6 @@ G_DEFINE_TYPE (TrackerIndexingTree, tracker_indexing_tree, G_TYPE_OBJECT)
 
 typedef struct _TrackerIndexingTreePrivate TrackerIndexingTreePrivate;
 typedef struct _NodeData NodeData;
-typedef struct _PatternData PatternData;
 typedef struct _FindNodeData FindNodeData;
 
 struct _NodeData
@@ -44,13 +46,6 @@ struct _NodeData
 	guint shallow : 1;
 };
 
-struct _PatternData
-{
-	GPatternSpec *pattern;
-	TrackerFilterType type;
-	GFile *file; /* Only filled in in absolute paths */
-};
-
 struct _FindNodeData
 {
 	GEqualFunc func;
@@ -61,7 +56,7 @@ struct _FindNodeData
 struct _TrackerIndexingTreePrivate
 {
 	GNode *config_tree;
-	GList *filter_patterns;
+	TrackerFilterMatcher *filters[TRACKER_FILTER_PARENT_DIRECTORY + 1];
 	TrackerFilterPolicy policies[TRACKER_FILTER_PARENT_DIRECTORY + 1];
 
 	guint filter_hidden : 1;
@@ -110,34 +105,6 @@ node_free (GNode    *node,
 	return FALSE;
 }
 
-static PatternData *
-pattern_data_new (const gchar *glob_string,
-                  guint        type)
-{
-	PatternData *data;
-
-	data = g_slice_new0 (PatternData);
-	data->pattern = g_pattern_spec_new (glob_string);
-	data->type = type;
-
-	if (g_path_is_absolute (glob_string)) {
-		data->file = g_file_new_for_path (glob_string);
-	}
-
-	return data;
-}
-
-static void
-pattern_data_free (PatternData *data)
-{
-	if (data->file) {
-		g_object_unref (data->file);
-	}
-
-	g_pattern_spec_free (data->pattern);
-	g_slice_free (PatternData, data);
-}
-
 static void
 tracker_indexing_tree_get_property (GObject    *object,
                                     guint       prop_id,
@@ -184,12 +151,14 @@ tracker_indexing_tree_finalize (GObject *object)
 {
 	TrackerIndexingTreePrivate *priv;
 	TrackerIndexingTree *tree;
+	gint i;
 
 	tree = TRACKER_INDEXING_TREE (object);
 	priv = tree->priv;
 
-	g_list_foreach (priv->filter_patterns, (GFunc) pattern_data_free, NULL);
-	g_list_free (priv->filter_patterns);
+	for (i = TRACKER_FILTER_FILE; i <= TRACKER_FILTER_PARENT_DIRECTORY; i++) {
+		tracker_filter_matcher_free (priv->filters[i]);
+	}
 
 	g_node_traverse (priv->config_tree,
 	                 G_POST_ORDER,
@@ -271,6 +240,7 @@ tracker_indexing_tree_init (TrackerIndexingTree *tree)
 
 	for (i = TRACKER_FILTER_FILE; i <= TRACKER_FILTER_PARENT_DIRECTORY; i++) {
 		priv->policies[i] = TRACKER_FILTER_POLICY_ACCEPT;
+		priv->filters[i] = tracker_filter_matcher_new ();
 	}
 }
 
@@ -502,15 +472,14 @@ tracker_indexing_tree_add_filter (TrackerIndexingTree *tree,
                                   const gchar         *glob_string)
 {
 	TrackerIndexingTreePrivate *priv;
-	PatternData *data;
 
 	g_return_if_fail (TRACKER_IS_INDEXING_TREE (tree));
+	g_return_if_fail (filter >= TRACKER_FILTER_FILE && filter <= TRACKER_FILTER_PARENT_DIRECTORY);
 	g_return_if_fail (glob_string != NULL);
 
 	priv = tree->priv;
 
-	data = pattern_data_new (glob_string, filter);
-	priv->filter_patterns = g_list_prepend (priv->filter_patterns, data);
+	tracker_filter_matcher_add (priv->filters[filter], glob_string);
 }
 
 /**
@@ -525,24 +494,14 @@ tracker_indexing_tree_clear_filters (TrackerIndexingTree *tree,
                                      TrackerFilterType    type)
 {
 	TrackerIndexingTreePrivate *priv;
-	GList *l;
 
 	g_return_if_fail (TRACKER_IS_INDEXING_TREE (tree));
+	g_return_if_fail (type >= TRACKER_FILTER_FILE && type <= TRACKER_FILTER_PARENT_DIRECTORY);
 
 	priv = tree->priv;
 
-	for (l = priv->filter_patterns; l; l = l->next) {
-		PatternData *data = l->data;
-
-		if (data->type == type) {
-			/* When we delete the link 'l', we point back
-			 * to the beginning of the list to make sure
-			 * we don't miss anything.
-			 */
-			l = priv->filter_patterns = g_list_delete_link (priv->filter_patterns, l);
-			pattern_data_free (data);
-		}
-	}
+	tracker_filter_matcher_free (priv->filters[type]);
+	priv->filters[type] = tracker_filter_matcher_new ();
 }
 
 /**
@@ -561,39 +520,42 @@ tracker_indexing_tree_file_matches_filter (TrackerIndexingTree *tree,
                                            GFile               *file)
 {
 	TrackerIndexingTreePrivate *priv;
-	GList *filters;
-	gchar *basename;
+	TrackerFilterMatcher *matcher;
+	const gchar *basename;
+	gchar *path, *str;
+	gboolean match;
 
 	g_return_val_if_fail (TRACKER_IS_INDEXING_TREE (tree), FALSE);
+	g_return_val_if_fail (type >= TRACKER_FILTER_FILE && type <= TRACKER_FILTER_PARENT_DIRECTORY, FALSE);
 	g_return_val_if_fail (G_IS_FILE (file), FALSE);
 
 	priv = tree->priv;
-	filters = priv->filter_patterns;
-	basename = g_file_get_basename (file);
+	matcher = priv->filters[type];
 
-	while (filters) {
-		PatternData *data = filters->data;
+	if (tracker_filter_matcher_is_empty (matcher)) {
+		return FALSE;
+	}
 
-		filters = filters->next;
+	/* Both the path and the basename are taken from a
+	 * single string, non-native files have no path.
+	 */
+	path = g_file_get_path (file);
 
-		if (data->type != type)
-			continue;
+	if (path) {
+		str = NULL;
+		basename = strrchr (path, G_DIR_SEPARATOR);
+		basename = (basename && basename[1]) ? basename + 1 : path;
+	} else {
+		basename = str = g_file_get_basename (file);
+	}
 
-		if (data->file &&
-		    (g_file_equal (file, data->file) ||
-		     g_file_has_prefix (file, data->file))) {
-			g_free (basename);
-			return TRUE;
-		}
+	match = ((basename && tracker_filter_matcher_match_name (matcher, basename)) ||
+	         (path && tracker_filter_matcher_match_path (matcher, path)));
 
-		if (g_pattern_match_string (data->pattern, basename)) {
-			g_free (basename);
-			return TRUE;
-		}
-	}
+	g_free (path);
+	g_free (str);
 
-	g_free (basename);
-	return FALSE;
+	return match;
 }
 
 static gboolean
@@ -269,6 +269,8 @@ static ItemMovedData *item_moved_data_new                 (GFile
                                                            GFile                *source_file);
 static void           item_moved_data_free                (ItemMovedData        *data);
 static void           item_writeback_data_free            (ItemWritebackData    *data);
+static gpointer       item_moved_data_get_file            (ItemMovedData        *data);
+static gpointer       item_writeback_data_get_file        (ItemWritebackData    *data);
 
 static void           indexing_tree_directory_removed     (TrackerIndexingTree  *indexing_tree,
                                                            GFile                *directory,
@@ -554,11 +556,23 @@ tracker_miner_fs_init (TrackerMinerFS *object)
 	priv->timer_stopped = TRUE;
 	priv->extraction_timer_stopped = TRUE;
 
-	priv->items_created = tracker_priority_queue_new ();
-	priv->items_updated = tracker_priority_queue_new ();
+	/* Queues checked on every new event are indexed by file,
+	 * GFiles given by monitors and the crawler aren't always
+	 * the canonical ones, so these hash by URI.
+	 */
+	priv->items_created = tracker_priority_queue_new_indexed ((GHashFunc) g_file_hash,
+	                                                          (GEqualFunc) g_file_equal,
+	                                                          NULL);
+	priv->items_updated = tracker_priority_queue_new_indexed ((GHashFunc) g_file_hash,
+	                                                          (GEqualFunc) g_file_equal,
+	                                                          NULL);
 	priv->items_deleted = tracker_priority_queue_new ();
-	priv->items_moved = tracker_priority_queue_new ();
-	priv->items_writeback = tracker_priority_queue_new ();
+	priv->items_moved = tracker_priority_queue_new_indexed ((GHashFunc) g_file_hash,
+	                                                        (GEqualFunc) g_file_equal,
+	                                                        (TrackerPriorityQueueKeyFunc) item_moved_data_get_file);
+	priv->items_writeback = tracker_priority_queue_new_indexed ((GHashFunc) g_file_hash,
+	                                                            (GEqualFunc) g_file_equal,
+	                                                            (TrackerPriorityQueueKeyFunc) item_writeback_data_get_file);
 
 #ifdef EVENT_QUEUE_ENABLE_TRACE
 	priv->queue_status_timeout_id = g_timeout_add_seconds (EVENT_QUEUE_STATUS_TIMEOUT_SECS,
@@ -625,6 +639,7 @@ miner_fs_initable_init (GInitable     *initable,
                         GError       **error)
 {
 	TrackerMinerFSPrivate *priv;
+	gchar *name, *path;
 	guint limit;
 
 	if (!miner_fs_initable_parent_iface->init (initable, cancellable, error)) {
@@ -633,6 +648,14 @@ miner_fs_initable_init (GInitable     *initable,
 
 	priv = TRACKER_MINER_FS_GET_PRIVATE (initable);
 
+	/* Keep the state of the last crawl next to the database */
+	g_object_get (initable, "name", &name, NULL);
+	path = g_build_filename (g_get_user_cache_dir (), "tracker",
+	                         "crawl-cache", name, NULL);
+	tracker_file_notifier_set_crawl_cache (priv->file_notifier, path);
+	g_free (path);
+	g_free (name);
+
 	g_object_get (initable, "processing-pool-ready-limit", &limit, NULL);
 	priv->sparql_buffer = tracker_sparql_buffer_new (tracker_miner_get_connection (TRACKER_MINER (initable)),
 	                                                 limit);
@@ -892,6 +915,34 @@ miner_ignore_next_update (TrackerMiner *miner, const GStrv urls)
 	item_queue_handlers_set_up (fs);
 }
 
+static void
+process_print_batch_sizes (TrackerMinerFS *fs)
+{
+	const guint *histogram;
+	GString *str;
+	guint i, n_buckets;
+
+	histogram = tracker_sparql_buffer_get_batch_size_histogram (fs->priv->sparql_buffer,
+	                                                            &n_buckets);
+	str = g_string_new (NULL);
+
+	for (i = 0; i < n_buckets; i++) {
+		if (histogram[i] == 0) {
+			continue;
+		}
+
+		g_string_append_printf (str, "%s%u-%u: %u",
+		                        str->len > 0 ? ", " : "",
+		                        1 << i, (2 << i) - 1,
+		                        histogram[i]);
+	}
+
+	tracker_info ("SPARQL batches    : %s (now %u)",
+	              str->len > 0 ? str->str : "none",
+	              tracker_sparql_buffer_get_batch_size (fs->priv->sparql_buffer));
+	g_string_free (str, TRUE);
+}
+
 static void
 process_print_stats (TrackerMinerFS *fs)
 {
@@ -917,6 +968,7 @@ process_print_stats (TrackerMinerFS *fs)
 		              fs->priv->total_files_processed,
 		              fs->priv->total_files_notified,
 		              fs->priv->total_files_notified_error);
+		process_print_batch_sizes (fs);
 		tracker_info ("--------------------------------------------------\n");
 	}
 }
@@ -927,6 +979,14 @@ process_stop (TrackerMinerFS *fs)
 	/* Now we have finished crawling, print stats and enable monitor events */
 	process_print_stats (fs);
 
+	/* The crawl cache may only be saved once everything
+	 * the crawl found made it to the store.
+	 */
+	if (tracker_task_pool_get_size (fs->priv->task_pool) == 0 &&
+	    tracker_task_pool_get_size (TRACKER_TASK_POOL (fs->priv->sparql_buffer)) == 0) {
+		tracker_file_notifier_save_crawl_cache (fs->priv->file_notifier);
+	}
+
 	g_timer_stop (fs->priv->timer);
 	g_timer_stop (fs->priv->extraction_timer);
 
@@ -2129,9 +2189,8 @@ item_queue_get_progress (TrackerMinerFS *fs,
 }
 
 static gboolean
-item_queue_handlers_cb (gpointer user_data)
+item_queue_handlers_process (TrackerMinerFS *fs)
 {
-	TrackerMinerFS *fs = user_data;
 	GFile *file = NULL;
 	GFile *source_file = NULL;
 	GFile *parent;
@@ -2148,7 +2207,6 @@ item_queue_handlers_cb (gpointer user_data)
 
 	if (tracker_task_pool_limit_reached (TRACKER_TASK_POOL (fs->priv->sparql_buffer))) {
 		/* Task pool is full, give it a break */
-		fs->priv->item_queues_handler_id = 0;
 		return FALSE;
 	}
 
@@ -2159,7 +2217,6 @@ item_queue_handlers_cb (gpointer user_data)
 		 * the processing pool is cleared before starting with
 		 * the next directories batch.
 		 */
-		fs->priv->item_queues_handler_id = 0;
 
 		/* We should flush the processing pool buffer here, because
 		 * if there was a previous task on the same file we want to
@@ -2361,12 +2418,49 @@ item_queue_handlers_cb (gpointer user_data)
 		g_object_unref (source_file);
 	}
 
-	if (!keep_processing) {
-		fs->priv->item_queues_handler_id = 0;
-		return FALSE;
+	return keep_processing;
+}
+
+static gboolean
+item_queue_handlers_cb (gpointer user_data)
+{
+	TrackerMinerFS *fs = user_data;
+	guint handler_id, n_items, i;
+
+	handler_id = fs->priv->item_queues_handler_id;
+
+	/* When not throttled, fill the processing pool in a
+	 * single go, so there are as many process-file
+	 * operations in flight as the pool allows without
+	 * waiting for a main loop iteration per item.
+	 * Throttling still goes one item per timeout.
+	 */
+	if (fs->priv->throttle == 0) {
+		n_items = MAX (tracker_task_pool_get_limit (fs->priv->task_pool), 1);
 	} else {
-		return TRUE;
+		n_items = 1;
+	}
+
+	for (i = 0; i < n_items; i++) {
+		if (!item_queue_handlers_process (fs)) {
+			if (fs->priv->item_queues_handler_id == handler_id) {
+				fs->priv->item_queues_handler_id = 0;
+			}
+
+			return FALSE;
+		}
+
+		/* Stop early if the pool got full, or if the
+		 * handler got paused or rescheduled meanwhile.
+		 */
+		if (fs->priv->item_queues_handler_id != handler_id ||
+		    fs->priv->is_paused ||
+		    tracker_task_pool_limit_reached (fs->priv->task_pool)) {
+			break;
+		}
 	}
+
+	return TRUE;
 }
 
 static guint
@@ -2459,26 +2553,17 @@ should_check_file (TrackerMinerFS *fs,
 	                                                file, file_type);
 }
 
-static gboolean
-moved_files_equal (gconstpointer a,
-                   gconstpointer b)
+static gpointer
+item_moved_data_get_file (ItemMovedData *data)
 {
-	const ItemMovedData *data = a;
-	GFile *file = G_FILE (b);
-
-	/* Compare with dest file */
-	return g_file_equal (data->file, file);
+	/* Index by dest file */
+	return data->file;
 }
 
-static gboolean
-writeback_files_equal (gconstpointer a,
-                       gconstpointer b)
+static gpointer
+item_writeback_data_get_file (ItemWritebackData *data)
 {
-	const ItemWritebackData *data = a;
-	GFile *file = G_FILE (b);
-
-	/* Compare with dest file */
-	return g_file_equal (data->file, file);
+	return data->file;
 }
 
 static gboolean
@@ -2558,6 +2643,7 @@ check_item_queues (TrackerMinerFS *fs,
                    GFile          *other_file)
 {
 	ItemMovedData *move_data;
+	GList *node;
 
 	if (!fs->priv->been_crawled) {
 		/* Only do this after initial crawling, so
@@ -2593,17 +2679,14 @@ check_item_queues (TrackerMinerFS *fs,
 		return TRUE;
 	case QUEUE_UPDATED:
 		/* No further updates after a previous created/updated event */
-		if (tracker_priority_queue_find (fs->priv->items_created, NULL,
-		                                 (GEqualFunc) g_file_equal, file) ||
-		    tracker_priority_queue_find (fs->priv->items_updated, NULL,
-		                                 (GEqualFunc) g_file_equal, file)) {
+		if (tracker_priority_queue_lookup (fs->priv->items_created, file, NULL) ||
+		    tracker_priority_queue_lookup (fs->priv->items_updated, file, NULL)) {
 			g_debug ("  Found previous unhandled CREATED/UPDATED event");
 			return FALSE;
 		}
 	case QUEUE_WRITEBACK:
 		/* No consecutive writebacks for the same file */
-		if (tracker_priority_queue_find (fs->priv->items_writeback, NULL,
-		                                 writeback_files_equal, file)) {
+		if (tracker_priority_queue_lookup (fs->priv->items_writeback, file, NULL)) {
 			g_debug ("  Found previous unhandled WRITEBACK event");
 			return FALSE;
 		}
@@ -2616,17 +2699,13 @@ check_item_queues (TrackerMinerFS *fs,
 		}
 
 		/* Remove all previous updates */
-		if (tracker_priority_queue_foreach_remove (fs->priv->items_updated,
-		                                           (GEqualFunc) g_file_equal,
-		                                           file,
-		                                           (GDestroyNotify) g_object_unref)) {
+		if (tracker_priority_queue_remove_all (fs->priv->items_updated, file,
+		                                       (GDestroyNotify) g_object_unref)) {
 			g_debug ("  Deleting previous unhandled UPDATED event");
 		}
 
-		if (tracker_priority_queue_foreach_remove (fs->priv->items_created,
-		                                           (GEqualFunc) g_file_equal,
-		                                           file,
-		                                           (GDestroyNotify) g_object_unref)) {
+		if (tracker_priority_queue_remove_all (fs->priv->items_created, file,
+		                                       (GDestroyNotify) g_object_unref)) {
 			/* Created event was still in the queue,
 			 * remove it and ignore the current event
 			 */
@@ -2644,25 +2723,19 @@ check_item_queues (TrackerMinerFS *fs,
 		}
 
 		/* Kill any events on other_file (The dest one), since it will be rewritten anyway */
-		if (tracker_priority_queue_foreach_remove (fs->priv->items_created,
-		                                           (GEqualFunc) g_file_equal,
-		                                           other_file,
-		                                           (GDestroyNotify) g_object_unref)) {
+		if (tracker_priority_queue_remove_all (fs->priv->items_created, other_file,
+		                                       (GDestroyNotify) g_object_unref)) {
 			g_debug ("  Removing previous unhandled CREATED event for dest file, will be rewritten anyway");
 		}
 
-		if (tracker_priority_queue_foreach_remove (fs->priv->items_updated,
-		                                           (GEqualFunc) g_file_equal,
-		                                           other_file,
-		                                           (GDestroyNotify) g_object_unref)) {
+		if (tracker_priority_queue_remove_all (fs->priv->items_updated, other_file,
+		                                       (GDestroyNotify) g_object_unref)) {
 			g_debug ("  Removing previous unhandled UPDATED event for dest file, will be rewritten anyway");
 		}
 
 		/* Now check file (Origin one) */
-		if (tracker_priority_queue_foreach_remove (fs->priv->items_created,
-		                                           (GEqualFunc) g_file_equal,
-		                                           file,
-		                                           (GDestroyNotify) g_object_unref)) {
+		if (tracker_priority_queue_remove_all (fs->priv->items_created, file,
+		                                       (GDestroyNotify) g_object_unref)) {
 			/* If source file was created, replace it with
 			 * a create event for the destination file, and
 			 * discard this event.
@@ -2678,16 +2751,18 @@ check_item_queues (TrackerMinerFS *fs,
 			return FALSE;
 		}
 
-		move_data = tracker_priority_queue_find (fs->priv->items_moved, NULL,
-		                                         (GEqualFunc) moved_files_equal, file);
-		if (move_data) {
+		node = tracker_priority_queue_lookup_node (fs->priv->items_moved, file, NULL);
+		if (node) {
 			/* Origin file was the dest of a previous
 			 * move operation, merge these together.
 			 */
 			g_debug ("  Source file is the destination of a previous "
 			         "unhandled MOVED event, merging both events together");
-			g_object_unref (move_data->file);
-			move_data->file = g_object_ref (other_file);
+			move_data = node->data;
+			move_data = tracker_priority_queue_replace_data (fs->priv->items_moved, node,
+			                                                 item_moved_data_new (other_file,
+			                                                                      move_data->source_file));
+			item_moved_data_free (move_data);
 			return FALSE;
 		}
 
@@ -22,6 +22,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <gio/gio.h>
+#include <glib/gstdio.h>
 
 #if defined (__OpenBSD__) || defined (__FreeBSD__) || defined (__NetBSD__) || defined (__APPLE__)
 #include <sys/types.h>
@@ -30,6 +31,14 @@
 #define TRACKER_MONITOR_KQUEUE
 #endif
 
+#ifdef __linux__
+#include <errno.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <glib-unix.h>
+#define TRACKER_MONITOR_INOTIFY
+#endif
+
 #include "tracker-monitor.h"
 
 #define TRACKER_MONITOR_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), TRACKER_TYPE_MONITOR, TrackerMonitorPrivate))
@@ -49,8 +58,15 @@
 #warning Assuming GLib/GIO always sends CHANGES_DONE_HINT after CREATED...
 #endif /* GIO_ALWAYS_SENDS_CHANGES_DONE_HINT_AFTER_CREATED */
 
-/* The life time of an item in the cache */
-#define CACHE_LIFETIME_SECONDS 1
+/* Default time (in milliseconds) an event is kept in the cache
+ * waiting to be merged with later events on the same item.
+ */
+#define DEFAULT_COALESCE_WINDOW      2000
+
+/* Default maximum number of events in the cache, beyond that
+ * events are flushed without waiting for the window to expire.
+ */
+#define DEFAULT_COALESCE_MAX_EVENTS  4096
 
 /* When we receive IO monitor events, we pause sending information to
  * the indexer for a few seconds before continuing. We have to receive
@@ -63,6 +79,31 @@
  */
 #undef  PAUSE_ON_IO
 
+/* Directories beyond the monitor limit are polled for mtime
+ * changes, up to POLL_BATCH_SIZE of them every POLL_INTERVAL_SECONDS.
+ */
+#define POLL_INTERVAL_SECONDS  10
+#define POLL_BATCH_SIZE        200
+
+#ifdef TRACKER_MONITOR_INOTIFY
+
+/* Size of the buffer used to read inotify events, one read() will
+ * usually bring in a few hundred events at once.
+ */
+#define INOTIFY_BUFFER_SIZE    (64 * 1024)
+
+/* Maximum number of read() calls per main loop iteration, so an
+ * event storm doesn't starve everything else.
+ */
+#define INOTIFY_MAX_READS      16
+
+#define INOTIFY_WATCH_MASK     (IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE |  \
+                                IN_MOVED_FROM | IN_MOVED_TO | IN_CREATE | \
+                                IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF | \
+                                IN_UNMOUNT | IN_ONLYDIR)
+
+#endif /* TRACKER_MONITOR_INOTIFY */
+
 struct TrackerMonitorPrivate {
 	GHashTable    *monitors;
 
@@ -88,32 +129,83 @@ struct TrackerMonitorPrivate {
 	GHashTable    *pre_delete;
 	guint          event_pairs_timeout_id;
 
+	guint          coalesce_window;
+	guint          coalesce_max_events;
+
+	/* Raw events received vs. signals emitted */
+	guint          n_events_received;
+	guint          n_events_emitted;
+
+	/* Directories that could not get a monitor, the queue
+	 * is sorted so the most recently changed are checked
+	 * first, the hashtable maps GFiles to queue links.
+	 */
+	GQueue        *poll_queue;
+	GHashTable    *polled;
+	guint          poll_timeout_id;
+	guint          poll_interval;
+
 	TrackerIndexingTree *tree;
+
+#ifdef TRACKER_MONITOR_INOTIFY
+	/* Native inotify backend, if available all directories
+	 * are watched through this fd instead of having one
+	 * GFileMonitor each.
+	 */
+	gint           inotify_fd;
+	guint          inotify_source_id;
+	GHashTable    *inotify_watches;
+	gchar         *inotify_buffer;
+
+	/* IN_MOVED_FROM waiting for its IN_MOVED_TO pair */
+	GFile         *inotify_move_file;
+	guint32        inotify_move_cookie;
+	gboolean       inotify_move_is_directory;
+#endif /* TRACKER_MONITOR_INOTIFY */
 };
 
+#ifdef TRACKER_MONITOR_INOTIFY
+
+typedef struct {
+	TrackerMonitorPrivate *priv;
+	GFile                 *file;
+	gint                   wd;
+	gint                   ref_count;
+} InotifyWatch;
+
+#endif /* TRACKER_MONITOR_INOTIFY */
+
 typedef struct {
 	GFile    *file;
 	gchar    *file_uri;
 	GFile    *other_file;
 	gchar    *other_file_uri;
 	gboolean  is_directory;
-	GTimeVal  start_time;
+	gint64    start_time;
 	guint32   event_type;
 	gboolean  expirable;
 } EventData;
 
+typedef struct {
+	GFile    *file;
+	guint64   mtime;
+} PollData;
+
 enum {
 	ITEM_CREATED,
 	ITEM_UPDATED,
 	ITEM_ATTRIBUTE_UPDATED,
 	ITEM_DELETED,
 	ITEM_MOVED,
+	DIRECTORY_RESCAN,
 	LAST_SIGNAL
 };
 
 enum {
 	PROP_0,
-	PROP_ENABLED
+	PROP_ENABLED,
+	PROP_COALESCE_WINDOW,
+	PROP_COALESCE_MAX_EVENTS
 };
 
 static void           tracker_monitor_finalize     (GObject        *object);
@@ -127,12 +219,20 @@ static void           tracker_monitor_get_property (GObject        *object,
                                                     GParamSpec     *pspec);
 static guint          get_kqueue_limit             (void);
 static guint          get_inotify_limit            (void);
-static GFileMonitor * directory_monitor_new        (TrackerMonitor *monitor,
+static gpointer       directory_monitor_new        (TrackerMonitor *monitor,
                                                     GFile          *file);
 static void           directory_monitor_cancel     (GFileMonitor     *dir_monitor);
+#ifdef TRACKER_MONITOR_INOTIFY
+static gboolean       inotify_backend_init         (TrackerMonitor *monitor);
+static void           inotify_watch_unref          (InotifyWatch   *watch);
+#endif /* TRACKER_MONITOR_INOTIFY */
 
 
 static void           event_data_free              (gpointer        data);
+static void           poll_data_free               (PollData       *data);
+static gboolean       poll_add                     (TrackerMonitor *monitor,
+                                                    GFile          *file);
+static void           poll_promote                 (TrackerMonitor *monitor);
 static void           emit_signal_for_event        (TrackerMonitor *monitor,
                                                     EventData      *event_data);
 static gboolean       monitor_cancel_recursively   (TrackerMonitor *monitor,
@@ -211,6 +311,21 @@ tracker_monitor_class_init (TrackerMonitorClass *klass)
 		              G_TYPE_BOOLEAN,
 		              G_TYPE_BOOLEAN);
 
+	/* Emitted when changes within a directory might have been
+	 * missed (polled directories, or inotify queue overflows),
+	 * so its contents should be checked again.
+	 */
+	signals[DIRECTORY_RESCAN] =
+		g_signal_new ("directory-rescan",
+		              G_TYPE_FROM_CLASS (klass),
+		              G_SIGNAL_RUN_LAST,
+		              0,
+		              NULL, NULL,
+		              NULL,
+		              G_TYPE_NONE,
+		              1,
+		              G_TYPE_OBJECT);
+
 	g_object_class_install_property (object_class,
 	                                 PROP_ENABLED,
 	                                 g_param_spec_boolean ("enabled",
@@ -218,10 +333,45 @@ tracker_monitor_class_init (TrackerMonitorClass *klass)
 	                                                       "Enabled",
 	                                                       TRUE,
 	                                                       G_PARAM_READWRITE | G_PARAM_CONSTRUCT));
+	g_object_class_install_property (object_class,
+	                                 PROP_COALESCE_WINDOW,
+	                                 g_param_spec_uint ("coalesce-window",
+	                                                    "Coalesce window",
+	                                                    "Time in milliseconds events are held to be merged with later ones",
+	                                                    1, G_MAXUINT,
+	                                                    DEFAULT_COALESCE_WINDOW,
+	                                                    G_PARAM_READWRITE));
+	g_object_class_install_property (object_class,
+	                                 PROP_COALESCE_MAX_EVENTS,
+	                                 g_param_spec_uint ("coalesce-max-events",
+	                                                    "Coalesce max events",
+	                                                    "Maximum number of events held before flushing them",
+	                                                    1, G_MAXUINT,
+	                                                    DEFAULT_COALESCE_MAX_EVENTS,
+	                                                    G_PARAM_READWRITE));
 
 	g_type_class_add_private (object_class, sizeof (TrackerMonitorPrivate));
 }
 
+/* Mostly meant for tests, so the polling fallback can be
+ * exercised without running out of real monitors.
+ */
+static void
+monitor_limits_apply_env (TrackerMonitorPrivate *priv)
+{
+	const gchar *value;
+
+	value = g_getenv ("TRACKER_MONITOR_LIMIT");
+	if (G_UNLIKELY (value)) {
+		priv->monitor_limit = MAX (atoi (value), 0);
+	}
+
+	value = g_getenv ("TRACKER_MONITOR_POLL_INTERVAL");
+	if (G_UNLIKELY (value)) {
+		priv->poll_interval = MAX (atoi (value), 1);
+	}
+}
+
 static void
 tracker_monitor_init (TrackerMonitor *object)
 {
@@ -238,12 +388,8 @@ tracker_monitor_init (TrackerMonitor *object)
 	/* By default we enable monitoring */
 	priv->enabled = TRUE;
 
-	/* Create monitors table for this module */
-	priv->monitors =
-		g_hash_table_new_full (g_file_hash,
-		                       (GEqualFunc) g_file_equal,
-		                       (GDestroyNotify) g_object_unref,
-		                       (GDestroyNotify) directory_monitor_cancel);
+	priv->coalesce_window = DEFAULT_COALESCE_WINDOW;
+	priv->coalesce_max_events = DEFAULT_COALESCE_MAX_EVENTS;
 
 	priv->pre_update =
 		g_hash_table_new_full (g_file_hash,
@@ -256,6 +402,41 @@ tracker_monitor_init (TrackerMonitor *object)
 		                       (GDestroyNotify) g_object_unref,
 		                       event_data_free);
 
+	priv->poll_interval = POLL_INTERVAL_SECONDS;
+	priv->poll_queue = g_queue_new ();
+	priv->polled = g_hash_table_new (g_file_hash,
+	                                 (GEqualFunc) g_file_equal);
+
+#ifdef TRACKER_MONITOR_INOTIFY
+	if (inotify_backend_init (object)) {
+		g_message ("Monitor backend is Inotify (native)");
+
+		priv->monitors =
+			g_hash_table_new_full (g_file_hash,
+			                       (GEqualFunc) g_file_equal,
+			                       (GDestroyNotify) g_object_unref,
+			                       (GDestroyNotify) inotify_watch_unref);
+
+		/* Same limits as for the GIO inotify backend below,
+		 * watches are still a user shared resource.
+		 */
+		priv->monitor_limit = get_inotify_limit ();
+		priv->monitor_limit -= 500;
+		priv->monitor_limit = MAX (priv->monitor_limit, 0);
+
+		monitor_limits_apply_env (priv);
+		g_message ("Monitor limit is %d", priv->monitor_limit);
+		return;
+	}
+#endif /* TRACKER_MONITOR_INOTIFY */
+
+	/* Create monitors table for this module */
+	priv->monitors =
+		g_hash_table_new_full (g_file_hash,
+		                       (GEqualFunc) g_file_equal,
+		                       (GDestroyNotify) g_object_unref,
+		                       (GDestroyNotify) directory_monitor_cancel);
+
 	/* For the first monitor we get the type and find out if we
 	 * are using inotify, FAM, polling, etc.
 	 */
@@ -348,6 +529,8 @@ tracker_monitor_init (TrackerMonitor *object)
 	}
 
 	g_object_unref (file);
+
+	monitor_limits_apply_env (priv);
 	g_message ("Monitor limit is %d", priv->monitor_limit);
 }
 
@@ -368,10 +551,31 @@ tracker_monitor_finalize (GObject *object)
 		g_source_remove (priv->event_pairs_timeout_id);
 	}
 
+	if (priv->poll_timeout_id) {
+		g_source_remove (priv->poll_timeout_id);
+	}
+
+	g_queue_free_full (priv->poll_queue, (GDestroyNotify) poll_data_free);
+	g_hash_table_unref (priv->polled);
+
 	g_hash_table_unref (priv->pre_update);
 	g_hash_table_unref (priv->pre_delete);
 	g_hash_table_unref (priv->monitors);
 
+#ifdef TRACKER_MONITOR_INOTIFY
+	if (priv->inotify_fd >= 0) {
+		g_source_remove (priv->inotify_source_id);
+		close (priv->inotify_fd);
+
+		if (priv->inotify_move_file) {
+			g_object_unref (priv->inotify_move_file);
+		}
+
+		g_hash_table_unref (priv->inotify_watches);
+		g_free (priv->inotify_buffer);
+	}
+#endif /* TRACKER_MONITOR_INOTIFY */
+
 	G_OBJECT_CLASS (tracker_monitor_parent_class)->finalize (object);
 }
 
@@ -386,6 +590,14 @@ tracker_monitor_set_property (GObject      *object,
 		tracker_monitor_set_enabled (TRACKER_MONITOR (object),
 		                             g_value_get_boolean (value));
 		break;
+	case PROP_COALESCE_WINDOW:
+		TRACKER_MONITOR (object)->priv->coalesce_window =
+			g_value_get_uint (value);
+		break;
+	case PROP_COALESCE_MAX_EVENTS:
+		TRACKER_MONITOR (object)->priv->coalesce_max_events =
+			g_value_get_uint (value);
+		break;
 
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -406,6 +618,12 @@ tracker_monitor_get_property (GObject      *object,
 	case PROP_ENABLED:
 		g_value_set_boolean (value, priv->enabled);
 		break;
+	case PROP_COALESCE_WINDOW:
+		g_value_set_uint (value, priv->coalesce_window);
+		break;
+	case PROP_COALESCE_MAX_EVENTS:
+		g_value_set_uint (value, priv->coalesce_max_events);
+		break;
 
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -512,10 +730,8 @@ event_data_new (GFile    *file,
                 guint32   event_type)
 {
 	EventData *event;
-	GTimeVal now;
 
 	event = g_slice_new0 (EventData);
-	g_get_current_time (&now);
 
 	event->file = g_object_ref (file);
 	event->file_uri = g_file_get_uri (file);
@@ -527,7 +743,7 @@ event_data_new (GFile    *file,
 		event->other_file_uri = NULL;
 	}
 	event->is_directory = is_directory;
-	event->start_time = now;
+	event->start_time = g_get_monotonic_time ();
 	event->event_type = event_type;
 	/* Always expirable when created */
 	event->expirable = TRUE;
@@ -558,6 +774,7 @@ tracker_monitor_move (TrackerMonitor *monitor,
 {
 	GHashTableIter iter;
 	GHashTable *new_monitors;
+	GList *new_polled = NULL, *l;
 	gchar *old_prefix;
 	gpointer iter_file, iter_file_monitor;
 	guint items_moved = 0;
@@ -635,9 +852,31 @@ tracker_monitor_move (TrackerMonitor *monitor,
 		g_hash_table_iter_remove (&iter);
 	}
 
+	/* Find out which polled subdirectories should be moved */
+	g_hash_table_iter_init (&iter, monitor->priv->polled);
+	while (g_hash_table_iter_next (&iter, &iter_file, NULL)) {
+		gchar *relative_path;
+
+		relative_path = g_file_get_relative_path (old_file, iter_file);
+
+		if (relative_path) {
+			new_polled = g_list_prepend (new_polled,
+			                             g_file_resolve_relative_path (new_file,
+			                                                           relative_path));
+			g_free (relative_path);
+			items_moved++;
+		}
+	}
+
 	/* Remove the monitor for the old top level directory hierarchy */
 	tracker_monitor_remove_recursively (monitor, old_file);
 
+	for (l = new_polled; l; l = l->next) {
+		poll_add (monitor, l->data);
+	}
+
+	g_list_free_full (new_polled, g_object_unref);
+
 	g_hash_table_unref (new_monitors);
 	g_free (old_prefix);
 
@@ -673,6 +912,8 @@ static void
 emit_signal_for_event (TrackerMonitor *monitor,
                        EventData      *event_data)
 {
+	monitor->priv->n_events_emitted++;
+
 	switch (event_data->event_type) {
 	case G_FILE_MONITOR_EVENT_CREATED:
 		g_debug ("Emitting ITEM_CREATED for (%s) '%s'",
@@ -783,15 +1024,28 @@ emit_signal_for_event (TrackerMonitor *monitor,
 	}
 }
 
+static gint
+event_data_compare (gconstpointer a,
+                    gconstpointer b)
+{
+	const EventData *event_a = a, *event_b = b;
+
+	return strcmp (event_a->file_uri, event_b->file_uri);
+}
+
 static void
 event_pairs_process_in_ht (TrackerMonitor *monitor,
                            GHashTable     *ht,
-                           GTimeVal       *now)
+                           gint64          now,
+                           gboolean        force)
 {
 	GHashTableIter iter;
 	gpointer key, value;
 	GList *expired_events = NULL;
 	GList *l;
+	gint64 window;
+
+	window = (gint64) monitor->priv->coalesce_window * 1000;
 
 	/* Start iterating the HT of events, and see if any of them was expired.
 	 * If so, STEAL the item from the HT, add it in an auxiliary list, and
@@ -802,30 +1056,35 @@ event_pairs_process_in_ht (TrackerMonitor *monitor,
 	g_hash_table_iter_init (&iter, ht);
 	while (g_hash_table_iter_next (&iter, &key, &value)) {
 		EventData *event_data = value;
-		glong seconds;
 
 		/* If event is not yet expirable, keep it */
 		if (!event_data->expirable)
 			continue;
 
-		/* If event is expirable, but didn't expire yet, keep it */
-		seconds = now->tv_sec - event_data->start_time.tv_sec;
-		if (seconds < 2)
+		/* If event is expirable, but didn't expire yet, keep it,
+		 * unless we are flushing because the cache is full.
+		 */
+		if (!force && now - event_data->start_time < window)
 			continue;
 
-		g_debug ("Event '%s' for URI '%s' has timed out (%ld seconds have elapsed)",
+		g_debug ("Event '%s' for URI '%s' has timed out (%" G_GINT64_FORMAT " ms have elapsed)",
 		         monitor_event_to_string (event_data->event_type),
 		         event_data->file_uri,
-		         seconds);
+		         (now - event_data->start_time) / 1000);
 		/* STEAL the item from the HT, so that disposal methods
 		 * for key and value are not called. */
 		g_hash_table_iter_steal (&iter);
 		/* Unref the key, as no longer needed */
 		g_object_unref (key);
 		/* Add the expired event to our temp list */
-		expired_events = g_list_append (expired_events, event_data);
+		expired_events = g_list_prepend (expired_events, event_data);
 	}
 
+	/* Emit the batch sorted by URI, so directories go
+	 * before their contents.
+	 */
+	expired_events = g_list_sort (expired_events, event_data_compare);
+
 	for (l = expired_events; l; l = g_list_next (l)) {
 		/* Emit signal for the expired event */
 		emit_signal_for_event (monitor, l->data);
@@ -835,20 +1094,38 @@ event_pairs_process_in_ht (TrackerMonitor *monitor,
 	g_list_free (expired_events);
 }
 
+static void
+event_pairs_flush (TrackerMonitor *monitor,
+                   gboolean        force)
+{
+	gint64 now;
+
+	now = g_get_monotonic_time ();
+
+	/* Process PRE-DELETE hash table first, so items are
+	 * deleted or moved away before anything new shows up
+	 * in their place.
+	 */
+	event_pairs_process_in_ht (monitor, monitor->priv->pre_delete, now, force);
+
+	/* Process PRE-UPDATE hash table */
+	event_pairs_process_in_ht (monitor, monitor->priv->pre_update, now, force);
+
+	if (monitor->priv->n_events_received > monitor->priv->n_events_emitted) {
+		g_debug ("%u out of %u monitor events folded so far",
+		         monitor->priv->n_events_received - monitor->priv->n_events_emitted,
+		         monitor->priv->n_events_received);
+	}
+}
+
 static gboolean
 event_pairs_timeout_cb (gpointer user_data)
 {
 	TrackerMonitor *monitor;
-	GTimeVal now;
 
 	monitor = user_data;
-	g_get_current_time (&now);
 
-	/* Process PRE-UPDATE hash table */
-	event_pairs_process_in_ht (monitor, monitor->priv->pre_update, &now);
-
-	/* Process PRE-DELETE hash table */
-	event_pairs_process_in_ht (monitor, monitor->priv->pre_delete, &now);
+	event_pairs_flush (monitor, FALSE);
 
 	if (g_hash_table_size (monitor->priv->pre_update) > 0 ||
 	    g_hash_table_size (monitor->priv->pre_delete) > 0) {
@@ -860,11 +1137,65 @@ event_pairs_timeout_cb (gpointer user_data)
 	return FALSE;
 }
 
+static void
+event_pairs_fold_children (TrackerMonitor *monitor,
+                           GHashTable     *ht,
+                           GFile          *dir)
+{
+	GHashTableIter iter;
+	gpointer key, value;
+
+	/* Drop cached events on items inside a deleted directory,
+	 * the directory DELETED will take care of those. Moves are
+	 * kept, as their destination is elsewhere.
+	 */
+	g_hash_table_iter_init (&iter, ht);
+	while (g_hash_table_iter_next (&iter, &key, &value)) {
+		EventData *event_data = value;
+
+		if (event_data->event_type == G_FILE_MONITOR_EVENT_MOVED ||
+		    !g_file_has_prefix (key, dir)) {
+			continue;
+		}
+
+		g_debug ("Folding event '%s' for URI '%s' into its parent directory DELETED",
+		         monitor_event_to_string (event_data->event_type),
+		         event_data->file_uri);
+		g_hash_table_iter_remove (&iter);
+	}
+}
+
 static void
 monitor_event_file_created (TrackerMonitor *monitor,
                             GFile          *file)
 {
 	EventData *new_event;
+	EventData *previous_delete_event_data;
+
+	previous_delete_event_data = g_hash_table_lookup (monitor->priv->pre_delete, file);
+
+	if (previous_delete_event_data) {
+		if (!previous_delete_event_data->is_directory &&
+		    previous_delete_event_data->event_type == G_FILE_MONITOR_EVENT_DELETED) {
+			/* DELETED(A) + CREATED(A) = UPDATED(A)
+			 *
+			 * The file was replaced, as in most build systems
+			 * or tarball extractions, so just update it.
+			 */
+			g_hash_table_remove (monitor->priv->pre_delete, file);
+			g_hash_table_replace (monitor->priv->pre_update,
+			                      g_object_ref (file),
+			                      event_data_new (file,
+			                                      NULL,
+			                                      FALSE,
+			                                      G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT));
+			return;
+		}
+
+		/* Something else was there before, notify it first */
+		emit_signal_for_event (monitor, previous_delete_event_data);
+		g_hash_table_remove (monitor->priv->pre_delete, file);
+	}
 
 	/*  - When a G_FILE_MONITOR_EVENT_CREATED(A) is received,
 	 *    -- Add it to the cache, replacing any previous element
@@ -943,7 +1274,7 @@ monitor_event_file_changed (TrackerMonitor *monitor,
 		                                      G_FILE_MONITOR_EVENT_CHANGED));
 	} else {
 		/* Update the start_time of the previous one */
-		g_get_current_time (&(previous_update_event_data->start_time));
+		previous_update_event_data->start_time = g_get_monotonic_time ();
 	}
 }
 
@@ -969,7 +1300,7 @@ monitor_event_file_attribute_changed (TrackerMonitor *monitor,
 	if (previous_update_event_data->event_type == G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED) {
 		/* Update the start_time of the previous one, if it is an ATTRIBUTE_CHANGED
 		 * event. */
-		g_get_current_time (&(previous_update_event_data->start_time));
+		previous_update_event_data->start_time = g_get_monotonic_time ();
 
 		/* No need to update event time in CREATED, as these events
 		 * only expire when there is a CHANGES_DONE_HINT.
@@ -997,7 +1328,7 @@ monitor_event_file_changes_done (TrackerMonitor *monitor,
 	}
 
 	/* Refresh event timer, and make sure the event is now set as expirable */
-	g_get_current_time (&(previous_update_event_data->start_time));
+	previous_update_event_data->start_time = g_get_monotonic_time ();
 	previous_update_event_data->expirable = TRUE;
 }
 
@@ -1005,7 +1336,6 @@ static void
 monitor_event_file_deleted (TrackerMonitor *monitor,
                             GFile          *file)
 {
-	EventData *new_event;
 	EventData *previous_update_event_data;
 
 	/* Get previous event data, if any */
@@ -1026,12 +1356,16 @@ monitor_event_file_deleted (TrackerMonitor *monitor,
 		/* else, keep on notifying the event */
 	}
 
-	new_event = event_data_new (file,
-	                            NULL,
-	                            FALSE,
-	                            G_FILE_MONITOR_EVENT_DELETED);
-	emit_signal_for_event (monitor, new_event);
-	event_data_free (new_event);
+	/* Keep the DELETED in the cache too, if the file is created
+	 * again it turns into an UPDATED, and if the parent directory
+	 * is deleted it gets merged into the directory DELETED.
+	 */
+	g_hash_table_replace (monitor->priv->pre_delete,
+	                      g_object_ref (file),
+	                      event_data_new (file,
+	                                      NULL,
+	                                      FALSE,
+	                                      G_FILE_MONITOR_EVENT_DELETED));
 }
 
 static void
@@ -1041,6 +1375,16 @@ monitor_event_file_moved (TrackerMonitor *monitor,
 {
 	EventData *new_event;
 	EventData *previous_update_event_data;
+	EventData *previous_delete_event_data;
+
+	/* If the destination was deleted before, notify it now,
+	 * so the moved file doesn't get deleted afterwards.
+	 */
+	previous_delete_event_data = g_hash_table_lookup (monitor->priv->pre_delete, dst_file);
+	if (previous_delete_event_data) {
+		emit_signal_for_event (monitor, previous_delete_event_data);
+		g_hash_table_remove (monitor->priv->pre_delete, dst_file);
+	}
 
 	/* Get previous event data, if any */
 	previous_update_event_data = g_hash_table_lookup (monitor->priv->pre_update, src_file);
@@ -1168,6 +1512,10 @@ monitor_event_directory_deleted (TrackerMonitor *monitor,
 		return;
 	}
 
+	/* Merge any pending event on the directory contents */
+	event_pairs_fold_children (monitor, monitor->priv->pre_update, dir);
+	event_pairs_fold_children (monitor, monitor->priv->pre_delete, dir);
+
 	/* If no previous, add to HT */
 	g_hash_table_replace (monitor->priv->pre_delete,
 	                      g_object_ref (dir),
@@ -1224,30 +1572,19 @@ monitor_event_directory_moved (TrackerMonitor *monitor,
 }
 
 static void
-monitor_event_cb (GFileMonitor      *file_monitor,
-                  GFile             *file,
-                  GFile             *other_file,
-                  GFileMonitorEvent  event_type,
-                  gpointer           user_data)
+monitor_event_handle (TrackerMonitor    *monitor,
+                      GFile             *file,
+                      GFile             *other_file,
+                      gboolean           is_directory,
+                      GFileMonitorEvent  event_type)
 {
-	TrackerMonitor *monitor;
 	gchar *file_uri;
 	gchar *other_file_uri;
-	gboolean is_directory;
-
-	monitor = user_data;
-
-	if (G_UNLIKELY (!monitor->priv->enabled)) {
-		g_debug ("Silently dropping monitor event, monitor disabled for now");
-		return;
-	}
 
 	/* Get URIs as paths may not be in UTF-8 */
 	file_uri = g_file_get_uri (file);
 
 	if (!other_file) {
-		is_directory = check_is_directory (monitor, file);
-
 		/* Avoid non-indexable-files */
 		if (monitor->priv->tree &&
 		    !tracker_indexing_tree_file_is_indexable (monitor->priv->tree,
@@ -1266,11 +1603,6 @@ monitor_event_cb (GFileMonitor      *file_monitor,
 		         is_directory ? "directory" : "file",
 		         file_uri);
 	} else {
-		/* If we have other_file, it means an item was moved from file to other_file;
-		 * so, it makes sense to check if the other_file is directory instead of
-		 * the origin file, as this one will not exist any more */
-		is_directory = check_is_directory (monitor, other_file);
-
 		/* Avoid doing anything of both
 		 * file/other_file are non-indexable
 		 */
@@ -1297,6 +1629,8 @@ monitor_event_cb (GFileMonitor      *file_monitor,
 		         other_file_uri);
 	}
 
+	monitor->priv->n_events_received++;
+
 #ifdef PAUSE_ON_IO
 	if (monitor->priv->unpause_timeout_id != 0) {
 		g_source_remove (monitor->priv->unpause_timeout_id);
@@ -1362,14 +1696,20 @@ monitor_event_cb (GFileMonitor      *file_monitor,
 		}
 	}
 
+	if (g_hash_table_size (monitor->priv->pre_update) +
+	    g_hash_table_size (monitor->priv->pre_delete) >= monitor->priv->coalesce_max_events) {
+		g_debug ("Too many events waiting, flushing");
+		event_pairs_flush (monitor, TRUE);
+	}
+
 	if (g_hash_table_size (monitor->priv->pre_update) > 0 ||
 	    g_hash_table_size (monitor->priv->pre_delete) > 0) {
 		if (monitor->priv->event_pairs_timeout_id == 0) {
 			g_debug ("Waiting for event pairs");
 			monitor->priv->event_pairs_timeout_id =
-				g_timeout_add_seconds (CACHE_LIFETIME_SECONDS,
-				                       event_pairs_timeout_cb,
-				                       monitor);
+				g_timeout_add (MAX (monitor->priv->coalesce_window / 2, 1),
+				               event_pairs_timeout_cb,
+				               monitor);
 		}
 	} else {
 		if (monitor->priv->event_pairs_timeout_id != 0) {
@@ -1383,48 +1723,645 @@ monitor_event_cb (GFileMonitor      *file_monitor,
 	g_free (other_file_uri);
 }
 
-static GFileMonitor *
-directory_monitor_new (TrackerMonitor *monitor,
-                       GFile          *file)
+static void
+monitor_event_cb (GFileMonitor      *file_monitor,
+                  GFile             *file,
+                  GFile             *other_file,
+                  GFileMonitorEvent  event_type,
+                  gpointer           user_data)
 {
-	GFileMonitor *file_monitor;
-	GError *error = NULL;
+	TrackerMonitor *monitor;
+	gboolean is_directory;
 
-	file_monitor = g_file_monitor_directory (file,
-	                                         G_FILE_MONITOR_SEND_MOVED | G_FILE_MONITOR_WATCH_MOUNTS,
-	                                         NULL,
-	                                         &error);
+	monitor = user_data;
 
-	if (error) {
-		gchar *uri;
+	if (G_UNLIKELY (!monitor->priv->enabled)) {
+		g_debug ("Silently dropping monitor event, monitor disabled for now");
+		return;
+	}
 
-		uri = g_file_get_uri (file);
-		g_warning ("Could not add monitor for path:'%s', %s",
-		           uri, error->message);
+	if (!other_file) {
+		is_directory = check_is_directory (monitor, file);
+	} else {
+		/* If we have other_file, it means an item was moved from file to other_file;
+		 * so, it makes sense to check if the other_file is directory instead of
+		 * the origin file, as this one will not exist any more */
+		is_directory = check_is_directory (monitor, other_file);
+	}
 
-		g_error_free (error);
-		g_free (uri);
+	monitor_event_handle (monitor, file, other_file, is_directory, event_type);
+}
 
-		return NULL;
+#ifdef TRACKER_MONITOR_INOTIFY
+
+static void
+monitor_rescan_topmost (TrackerMonitor *monitor)
+{
+	GHashTableIter iter;
+	gpointer iter_file;
+	GList *files = NULL, *l;
+
+	/* There is no telling which directories lost events,
+	 * so ask for a rescan of the topmost monitored ones,
+	 * which cover all others. Directories that are being
+	 * polled are not affected.
+	 */
+	g_hash_table_iter_init (&iter, monitor->priv->monitors);
+	while (g_hash_table_iter_next (&iter, &iter_file, NULL)) {
+		GFile *parent;
+
+		parent = g_file_get_parent (iter_file);
+
+		if (!parent ||
+		    !g_hash_table_lookup_extended (monitor->priv->monitors,
+		                                   parent, NULL, NULL)) {
+			files = g_list_prepend (files, g_object_ref (iter_file));
+		}
+
+		if (parent) {
+			g_object_unref (parent);
+		}
 	}
 
-	g_signal_connect (file_monitor, "changed",
-	                  G_CALLBACK (monitor_event_cb),
-	                  monitor);
+	for (l = files; l; l = l->next) {
+		g_signal_emit (monitor, signals[DIRECTORY_RESCAN], 0, l->data);
+	}
 
-	return file_monitor;
+	g_list_free_full (files, g_object_unref);
 }
 
 static void
-directory_monitor_cancel (GFileMonitor *monitor)
+inotify_move_flush (TrackerMonitor *monitor)
 {
-	if (monitor) {
-		g_file_monitor_cancel (G_FILE_MONITOR (monitor));
-		g_object_unref (monitor);
+	TrackerMonitorPrivate *priv;
+	GFile *file;
+
+	priv = monitor->priv;
+
+	if (!priv->inotify_move_file) {
+		return;
 	}
-}
 
-TrackerMonitor *
+	/* No IN_MOVED_TO arrived for this IN_MOVED_FROM, so the
+	 * item was moved somewhere we are not watching.
+	 */
+	file = priv->inotify_move_file;
+	priv->inotify_move_file = NULL;
+
+	monitor_event_handle (monitor, file, NULL,
+	                      priv->inotify_move_is_directory,
+	                      G_FILE_MONITOR_EVENT_DELETED);
+	g_object_unref (file);
+}
+
+static void
+inotify_watch_forget (TrackerMonitor *monitor,
+                      InotifyWatch   *watch)
+{
+	GHashTableIter iter;
+	gpointer value;
+	gboolean removed = FALSE;
+
+	/* The same watch may back several paths to one inode.
+	 * Removing the monitors drops their references on it, it
+	 * is only compared by pointer from then on.
+	 */
+	g_hash_table_iter_init (&iter, monitor->priv->monitors);
+
+	while (g_hash_table_iter_next (&iter, NULL, &value)) {
+		if (value == watch) {
+			g_hash_table_iter_remove (&iter);
+			removed = TRUE;
+		}
+	}
+
+	if (removed) {
+		poll_promote (monitor);
+	}
+}
+
+static void
+inotify_event_process (TrackerMonitor       *monitor,
+                       struct inotify_event *event)
+{
+	TrackerMonitorPrivate *priv;
+	GFileMonitorEvent event_type;
+	InotifyWatch *watch;
+	gboolean is_directory;
+	GFile *file;
+
+	priv = monitor->priv;
+
+	if (event->mask & IN_Q_OVERFLOW) {
+		g_warning ("Inotify event queue overflowed, some events were lost");
+		inotify_move_flush (monitor);
+		monitor_rescan_topmost (monitor);
+		return;
+	}
+
+	watch = g_hash_table_lookup (priv->inotify_watches,
+	                             GINT_TO_POINTER (event->wd));
+
+	if (event->mask & IN_IGNORED) {
+		/* The watch is gone. Watches we removed ourselves are
+		 * not in the table anymore, so the directory itself is
+		 * gone or was unmounted. Drop the monitors it backed so
+		 * they don't look alive, freeing room for polled ones.
+		 */
+		if (watch) {
+			g_hash_table_remove (priv->inotify_watches,
+			                     GINT_TO_POINTER (event->wd));
+			watch->wd = -1;
+			inotify_watch_forget (monitor, watch);
+		}
+
+		return;
+	}
+
+	if (!watch) {
+		return;
+	}
+
+	if (event->len > 0) {
+		file = g_file_get_child (watch->file, event->name);
+		is_directory = (event->mask & IN_ISDIR) != 0;
+	} else {
+		/* Event on the watched directory itself */
+		file = g_object_ref (watch->file);
+		is_directory = TRUE;
+	}
+
+	if (event->mask & IN_MOVED_FROM) {
+		inotify_move_flush (monitor);
+
+		priv->inotify_move_file = file;
+		priv->inotify_move_cookie = event->cookie;
+		priv->inotify_move_is_directory = is_directory;
+		return;
+	}
+
+	if (event->mask & IN_MOVED_TO) {
+		if (priv->inotify_move_file &&
+		    priv->inotify_move_cookie == event->cookie) {
+			GFile *source;
+
+			source = priv->inotify_move_file;
+			priv->inotify_move_file = NULL;
+
+			monitor_event_handle (monitor, source, file, is_directory,
+			                      G_FILE_MONITOR_EVENT_MOVED);
+			g_object_unref (source);
+		} else {
+			/* Moved in from somewhere we are not watching */
+			inotify_move_flush (monitor);
+			monitor_event_handle (monitor, file, NULL, is_directory,
+			                      G_FILE_MONITOR_EVENT_CREATED);
+		}
+
+		g_object_unref (file);
+		return;
+	}
+
+	inotify_move_flush (monitor);
+
+	if (event->mask & IN_CREATE) {
+		event_type = G_FILE_MONITOR_EVENT_CREATED;
+	} else if (event->mask & IN_MODIFY) {
+		event_type = G_FILE_MONITOR_EVENT_CHANGED;
+	} else if (event->mask & IN_CLOSE_WRITE) {
+		event_type = G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT;
+	} else if (event->mask & IN_ATTRIB) {
+		event_type = G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED;
+	} else if (event->mask & (IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF)) {
+		/* Same as GIO does, a moved watched directory is
+		 * reported as deleted, the parent directory watch
+		 * (if any) provides the actual move.
+		 */
+		event_type = G_FILE_MONITOR_EVENT_DELETED;
+	} else if (event->mask & IN_UNMOUNT) {
+		event_type = G_FILE_MONITOR_EVENT_UNMOUNTED;
+	} else {
+		g_object_unref (file);
+		return;
+	}
+
+	monitor_event_handle (monitor, file, NULL, is_directory, event_type);
+	g_object_unref (file);
+}
+
+static gboolean
+inotify_read_cb (gint         fd,
+                 GIOCondition condition,
+                 gpointer     user_data)
+{
+	TrackerMonitor *monitor;
+	TrackerMonitorPrivate *priv;
+	gboolean drained = FALSE;
+	gint n_reads;
+
+	monitor = user_data;
+	priv = monitor->priv;
+
+	for (n_reads = 0; n_reads < INOTIFY_MAX_READS; n_reads++) {
+		gssize len;
+		gchar *p;
+
+		len = read (fd, priv->inotify_buffer, INOTIFY_BUFFER_SIZE);
+
+		if (len < 0 && errno == EINTR) {
+			continue;
+		} else if (len <= 0) {
+			if (len < 0 && errno != EAGAIN) {
+				g_warning ("Could not read inotify events: %s",
+				           g_strerror (errno));
+			}
+
+			drained = TRUE;
+			break;
+		}
+
+		if (G_UNLIKELY (!priv->enabled)) {
+			g_debug ("Silently dropping monitor events, monitor disabled for now");
+			continue;
+		}
+
+		p = priv->inotify_buffer;
+
+		while (p < priv->inotify_buffer + len) {
+			struct inotify_event *event;
+
+			event = (struct inotify_event *) p;
+			inotify_event_process (monitor, event);
+			p += sizeof (struct inotify_event) + event->len;
+		}
+	}
+
+	/* Both halves of a rename are queued together, so once
+	 * the queue is drained, a pending IN_MOVED_FROM won't
+	 * get its IN_MOVED_TO pair.
+	 */
+	if (drained) {
+		inotify_move_flush (monitor);
+	}
+
+	return TRUE;
+}
+
+static gboolean
+inotify_backend_init (TrackerMonitor *monitor)
+{
+	TrackerMonitorPrivate *priv;
+
+	priv = monitor->priv;
+	priv->inotify_fd = -1;
+
+	if (G_UNLIKELY (g_getenv ("TRACKER_USE_GIO_MONITORS"))) {
+		return FALSE;
+	}
+
+	priv->inotify_fd = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+
+	if (priv->inotify_fd < 0) {
+		g_message ("Could not initialize inotify, using GIO monitors: %s",
+		           g_strerror (errno));
+		return FALSE;
+	}
+
+	priv->inotify_watches = g_hash_table_new (NULL, NULL);
+	priv->inotify_buffer = g_malloc (INOTIFY_BUFFER_SIZE);
+	priv->inotify_source_id =
+		g_unix_fd_add (priv->inotify_fd, G_IO_IN,
+		               inotify_read_cb, monitor);
+
+	return TRUE;
+}
+
+static InotifyWatch *
+inotify_watch_new (TrackerMonitor *monitor,
+                   GFile          *file)
+{
+	TrackerMonitorPrivate *priv;
+	InotifyWatch *watch;
+	gchar *path;
+	gint wd;
+
+	priv = monitor->priv;
+	path = g_file_get_path (file);
+
+	if (!path) {
+		gchar *uri;
+
+		uri = g_file_get_uri (file);
+		g_warning ("Could not add monitor for path:'%s', not a local file",
+		           uri);
+		g_free (uri);
+
+		return NULL;
+	}
+
+	wd = inotify_add_watch (priv->inotify_fd, path, INOTIFY_WATCH_MASK);
+
+	if (wd < 0) {
+		g_warning ("Could not add monitor for path:'%s', %s",
+		           path, g_strerror (errno));
+		g_free (path);
+
+		return NULL;
+	}
+
+	g_free (path);
+
+	/* Watches are per inode, the same wd is returned if
+	 * the directory is already watched through another
+	 * path (eg. it was moved and the new location is being
+	 * added before the old one is removed).
+	 */
+	watch = g_hash_table_lookup (priv->inotify_watches,
+	                             GINT_TO_POINTER (wd));
+
+	if (watch) {
+		g_object_unref (watch->file);
+		watch->file = g_object_ref (file);
+		watch->ref_count++;
+
+		return watch;
+	}
+
+	watch = g_slice_new0 (InotifyWatch);
+	watch->priv = priv;
+	watch->file = g_object_ref (file);
+	watch->wd = wd;
+	watch->ref_count = 1;
+
+	g_hash_table_insert (priv->inotify_watches,
+	                     GINT_TO_POINTER (wd), watch);
+
+	return watch;
+}
+
+static void
+inotify_watch_cancel (InotifyWatch *watch)
+{
+	if (!watch || watch->wd < 0) {
+		return;
+	}
+
+	g_hash_table_remove (watch->priv->inotify_watches,
+	                     GINT_TO_POINTER (watch->wd));
+	inotify_rm_watch (watch->priv->inotify_fd, watch->wd);
+	watch->wd = -1;
+}
+
+static void
+inotify_watch_unref (InotifyWatch *watch)
+{
+	if (!watch || --watch->ref_count > 0) {
+		return;
+	}
+
+	inotify_watch_cancel (watch);
+	g_object_unref (watch->file);
+	g_slice_free (InotifyWatch, watch);
+}
+
+#endif /* TRACKER_MONITOR_INOTIFY */
+
+static gpointer
+directory_monitor_new (TrackerMonitor *monitor,
+                       GFile          *file)
+{
+	GFileMonitor *file_monitor;
+	GError *error = NULL;
+
+#ifdef TRACKER_MONITOR_INOTIFY
+	if (monitor->priv->inotify_fd >= 0) {
+		return inotify_watch_new (monitor, file);
+	}
+#endif /* TRACKER_MONITOR_INOTIFY */
+
+	file_monitor = g_file_monitor_directory (file,
+	                                         G_FILE_MONITOR_SEND_MOVED | G_FILE_MONITOR_WATCH_MOUNTS,
+	                                         NULL,
+	                                         &error);
+
+	if (error) {
+		gchar *uri;
+
+		uri = g_file_get_uri (file);
+		g_warning ("Could not add monitor for path:'%s', %s",
+		           uri, error->message);
+
+		g_error_free (error);
+		g_free (uri);
+
+		return NULL;
+	}
+
+	g_signal_connect (file_monitor, "changed",
+	                  G_CALLBACK (monitor_event_cb),
+	                  monitor);
+
+	return file_monitor;
+}
+
+static void
+directory_monitor_cancel (GFileMonitor *monitor)
+{
+	if (monitor) {
+		g_file_monitor_cancel (G_FILE_MONITOR (monitor));
+		g_object_unref (monitor);
+	}
+}
+
+static gboolean
+poll_get_mtime (GFile   *file,
+                guint64 *mtime)
+{
+	GStatBuf st;
+	gchar *path;
+	gint retval;
+
+	path = g_file_get_path (file);
+
+	if (!path) {
+		return FALSE;
+	}
+
+	retval = g_stat (path, &st);
+	g_free (path);
+
+	if (retval != 0 || !S_ISDIR (st.st_mode)) {
+		return FALSE;
+	}
+
+	*mtime = (guint64) st.st_mtime;
+
+	return TRUE;
+}
+
+static void
+poll_data_free (PollData *data)
+{
+	g_object_unref (data->file);
+	g_slice_free (PollData, data);
+}
+
+static gboolean
+poll_remove (TrackerMonitor *monitor,
+             GFile          *file)
+{
+	GList *link;
+
+	link = g_hash_table_lookup (monitor->priv->polled, file);
+
+	if (!link) {
+		return FALSE;
+	}
+
+	g_hash_table_remove (monitor->priv->polled, file);
+	poll_data_free (link->data);
+	g_queue_delete_link (monitor->priv->poll_queue, link);
+
+	return TRUE;
+}
+
+static gboolean
+poll_timeout_cb (gpointer user_data)
+{
+	TrackerMonitor *monitor;
+	TrackerMonitorPrivate *priv;
+	GQueue recent = G_QUEUE_INIT;
+	GList *changed = NULL, *l, *link;
+	guint i, n_items;
+
+	monitor = user_data;
+	priv = monitor->priv;
+
+	if (g_queue_is_empty (priv->poll_queue)) {
+		priv->poll_timeout_id = 0;
+		return FALSE;
+	}
+
+	if (!priv->enabled) {
+		return TRUE;
+	}
+
+	n_items = MIN (POLL_BATCH_SIZE, g_queue_get_length (priv->poll_queue));
+
+	for (i = 0; i < n_items; i++) {
+		PollData *data;
+		guint64 mtime;
+
+		link = g_queue_pop_head_link (priv->poll_queue);
+		data = link->data;
+
+		if (!poll_get_mtime (data->file, &mtime)) {
+			/* Gone, the parent directory will notice */
+			g_hash_table_remove (priv->polled, data->file);
+			poll_data_free (data);
+			g_list_free_1 (link);
+			continue;
+		}
+
+		if (mtime == data->mtime) {
+			g_queue_push_tail_link (priv->poll_queue, link);
+			continue;
+		}
+
+		data->mtime = mtime;
+		changed = g_list_prepend (changed, g_object_ref (data->file));
+
+		/* Recently changed directories are likely to change
+		 * again, check them first on the next run, but leave
+		 * room in the batch for the others. They are only put
+		 * back at the head once this batch is done, or they
+		 * would be popped again right away.
+		 */
+		if (recent.length < POLL_BATCH_SIZE / 2) {
+			g_queue_push_tail_link (&recent, link);
+		} else {
+			g_queue_push_tail_link (priv->poll_queue, link);
+		}
+	}
+
+	while ((link = g_queue_pop_tail_link (&recent)) != NULL) {
+		g_queue_push_head_link (priv->poll_queue, link);
+	}
+
+	for (l = changed; l; l = l->next) {
+		gchar *uri;
+
+		uri = g_file_get_uri (l->data);
+		g_debug ("Polled directory '%s' changed, requesting rescan", uri);
+		g_free (uri);
+
+		g_signal_emit (monitor, signals[DIRECTORY_RESCAN], 0, l->data);
+	}
+
+	g_list_free_full (changed, g_object_unref);
+
+	return TRUE;
+}
+
+static gboolean
+poll_add (TrackerMonitor *monitor,
+          GFile          *file)
+{
+	TrackerMonitorPrivate *priv;
+	PollData *data;
+	guint64 mtime;
+
+	priv = monitor->priv;
+
+	if (g_hash_table_lookup (priv->polled, file)) {
+		return TRUE;
+	}
+
+	if (!poll_get_mtime (file, &mtime)) {
+		return FALSE;
+	}
+
+	data = g_slice_new0 (PollData);
+	data->file = g_object_ref (file);
+	data->mtime = mtime;
+
+	g_queue_push_tail (priv->poll_queue, data);
+	g_hash_table_insert (priv->polled, data->file,
+	                     g_queue_peek_tail_link (priv->poll_queue));
+
+	if (priv->poll_timeout_id == 0) {
+		priv->poll_timeout_id =
+			g_timeout_add_seconds_full (G_PRIORITY_LOW,
+			                            priv->poll_interval,
+			                            poll_timeout_cb,
+			                            monitor, NULL);
+	}
+
+	return TRUE;
+}
+
+static void
+poll_promote (TrackerMonitor *monitor)
+{
+	TrackerMonitorPrivate *priv;
+
+	priv = monitor->priv;
+
+	/* Monitors got freed, hand them over to the most
+	 * recently changed polled directories.
+	 */
+	while (!g_queue_is_empty (priv->poll_queue) &&
+	       g_hash_table_size (priv->monitors) < priv->monitor_limit) {
+		GFile *file;
+
+		file = g_object_ref (((PollData *) g_queue_peek_head (priv->poll_queue))->file);
+		poll_remove (monitor, file);
+		tracker_monitor_add (monitor, file);
+		g_object_unref (file);
+	}
+}
+
+TrackerMonitor *
 tracker_monitor_new (void)
 {
 	return g_object_new (TRACKER_TYPE_MONITOR, NULL);
@@ -1490,7 +2427,7 @@ tracker_monitor_set_enabled (TrackerMonitor *monitor,
 		file = k->data;
 
 		if (enabled) {
-			GFileMonitor *dir_monitor;
+			gpointer dir_monitor;
 
 			dir_monitor = directory_monitor_new (monitor, file);
 			g_hash_table_replace (monitor->priv->monitors,
@@ -1509,7 +2446,7 @@ gboolean
 tracker_monitor_add (TrackerMonitor *monitor,
                      GFile          *file)
 {
-	GFileMonitor *dir_monitor = NULL;
+	gpointer dir_monitor = NULL;
 	gchar *uri;
 
 	g_return_val_if_fail (TRACKER_IS_MONITOR (monitor), FALSE);
@@ -1525,11 +2462,13 @@ tracker_monitor_add (TrackerMonitor *monitor,
 
 		if (!monitor->priv->monitor_limit_warned) {
 			g_warning ("The maximum number of monitors to set (%d) "
-			           "has been reached, not adding any new ones",
+			           "has been reached, polling new directories instead",
 			           monitor->priv->monitor_limit);
 			monitor->priv->monitor_limit_warned = TRUE;
 		}
 
+		poll_add (monitor, file);
+
 		return FALSE;
 	}
 
@@ -1588,6 +2527,10 @@ tracker_monitor_remove (TrackerMonitor *monitor,
 		         g_hash_table_size (monitor->priv->monitors));
 
 		g_free (uri);
+
+		poll_promote (monitor);
+	} else {
+		removed = poll_remove (monitor, file);
 	}
 
 	return removed;
@@ -1616,6 +2559,23 @@ tracker_monitor_remove_recursively (TrackerMonitor *monitor,
 		items_removed++;
 	}
 
+	g_hash_table_iter_init (&iter, monitor->priv->polled);
+	while (g_hash_table_iter_next (&iter, &iter_file, &iter_file_monitor)) {
+		GList *link = iter_file_monitor;
+
+		if (!g_file_has_prefix (iter_file, file) &&
+		    !g_file_equal (iter_file, file)) {
+			continue;
+		}
+
+		g_hash_table_iter_remove (&iter);
+		poll_data_free (link->data);
+		g_queue_delete_link (monitor->priv->poll_queue, link);
+		items_removed++;
+	}
+
+	poll_promote (monitor);
+
 	uri = g_file_get_uri (file);
 	g_debug ("Removed all monitors recursively for path:'%s', total monitors:%d",
 	         uri, g_hash_table_size (monitor->priv->monitors));
@@ -1648,7 +2608,15 @@ monitor_cancel_recursively (TrackerMonitor *monitor,
 		}
 
 		uri = g_file_get_uri (iter_file);
+#ifdef TRACKER_MONITOR_INOTIFY
+		if (monitor->priv->inotify_fd >= 0) {
+			inotify_watch_cancel (iter_file_monitor);
+		} else {
+			g_file_monitor_cancel (G_FILE_MONITOR (iter_file_monitor));
+		}
+#else  /* TRACKER_MONITOR_INOTIFY */
 		g_file_monitor_cancel (G_FILE_MONITOR (iter_file_monitor));
+#endif /* TRACKER_MONITOR_INOTIFY */
 		g_debug ("Cancelled monitor for path:'%s'", uri);
 		g_free (uri);
 
@@ -1700,3 +2668,36 @@ tracker_monitor_get_ignored (TrackerMonitor *monitor)
 
 	return monitor->priv->monitors_ignored;
 }
+
+/* Returns the polled directories in the order they will be
+ * checked, free the list (but not the files) with g_list_free().
+ */
+GList *
+tracker_monitor_get_polled (TrackerMonitor *monitor)
+{
+	GList *polled = NULL, *l;
+
+	g_return_val_if_fail (TRACKER_IS_MONITOR (monitor), NULL);
+
+	for (l = g_queue_peek_tail_link (monitor->priv->poll_queue); l; l = l->prev) {
+		polled = g_list_prepend (polled, ((PollData *) l->data)->file);
+	}
+
+	return polled;
+}
+
+guint
+tracker_monitor_get_folded_events (TrackerMonitor *monitor)
+{
+	TrackerMonitorPrivate *priv;
+
+	g_return_val_if_fail (TRACKER_IS_MONITOR (monitor), 0);
+
+	priv = monitor->priv;
+
+	if (priv->n_events_received < priv->n_events_emitted) {
+		return 0;
+	}
+
+	return priv->n_events_received - priv->n_events_emitted;
+}
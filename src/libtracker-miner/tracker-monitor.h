@@ -75,6 +75,8 @@ gboolean        tracker_monitor_is_watched_by_string (TrackerMonitor *monitor,
                                                       const gchar    *path);
 guint           tracker_monitor_get_count            (TrackerMonitor *monitor);
 guint           tracker_monitor_get_ignored          (TrackerMonitor *monitor);
+GList *         tracker_monitor_get_polled           (TrackerMonitor *monitor);
+guint           tracker_monitor_get_folded_events    (TrackerMonitor *monitor);
 
 G_END_DECLS
 
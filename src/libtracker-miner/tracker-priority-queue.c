@@ -24,6 +24,7 @@
 #include "tracker-priority-queue.h"
 
 typedef struct PrioritySegment PrioritySegment;
+typedef struct IndexEntry IndexEntry;
 
 struct PrioritySegment
 {
@@ -32,20 +33,125 @@ struct PrioritySegment
 	GList *last_elem;
 };
 
+/* Entries in the index, elements with equal keys are
+ * chained in the order they were added.
+ */
+struct IndexEntry
+{
+	GList *node;
+	gint priority;
+	IndexEntry *next;
+};
+
 struct _TrackerPriorityQueue
 {
 	GQueue queue;
 	GArray *segments;
 
+	/* Key -> IndexEntry, only on indexed queues */
+	GHashTable *index;
+	TrackerPriorityQueueKeyFunc key_func;
+
 	gint ref_count;
 };
 
+static void
+index_entry_free_chain (IndexEntry *entry)
+{
+	IndexEntry *next;
+
+	while (entry) {
+		next = entry->next;
+		g_slice_free (IndexEntry, entry);
+		entry = next;
+	}
+}
+
+static inline gpointer
+index_get_key (TrackerPriorityQueue *queue,
+               gpointer              data)
+{
+	return queue->key_func ? (queue->key_func) (data) : data;
+}
+
+static void
+index_add (TrackerPriorityQueue *queue,
+           GList                *node,
+           gint                  priority)
+{
+	IndexEntry *entry, *head;
+	gpointer key;
+
+	if (!queue->index) {
+		return;
+	}
+
+	entry = g_slice_new (IndexEntry);
+	entry->node = node;
+	entry->priority = priority;
+	entry->next = NULL;
+
+	key = index_get_key (queue, node->data);
+	head = g_hash_table_lookup (queue->index, key);
+
+	if (head) {
+		while (head->next) {
+			head = head->next;
+		}
+
+		head->next = entry;
+	} else {
+		g_hash_table_insert (queue->index, key, entry);
+	}
+}
+
+static void
+index_remove (TrackerPriorityQueue *queue,
+              GList                *node)
+{
+	IndexEntry *entry, *head, *prev = NULL;
+	gpointer key;
+
+	if (!queue->index) {
+		return;
+	}
+
+	key = index_get_key (queue, node->data);
+	head = g_hash_table_lookup (queue->index, key);
+
+	for (entry = head; entry; entry = entry->next) {
+		if (entry->node == node) {
+			break;
+		}
+
+		prev = entry;
+	}
+
+	g_assert (entry != NULL);
+
+	if (prev) {
+		prev->next = entry->next;
+	} else if (entry->next) {
+		/* The hash table key may belong to the element
+		 * being removed, replace it with the next one's.
+		 */
+		g_hash_table_steal (queue->index, key);
+		g_hash_table_insert (queue->index,
+		                     index_get_key (queue, entry->next->node->data),
+		                     entry->next);
+	} else {
+		g_hash_table_remove (queue->index, key);
+	}
+
+	g_slice_free (IndexEntry, entry);
+}
+
 TrackerPriorityQueue *
 tracker_priority_queue_new (void)
 {
 	TrackerPriorityQueue *queue;
 
-	queue = g_slice_new (TrackerPriorityQueue);
+	queue = g_slice_new0 (TrackerPriorityQueue);
 	g_queue_init (&queue->queue);
 	queue->segments = g_array_new (FALSE, FALSE,
 	                               sizeof (PrioritySegment));
@@ -55,6 +161,39 @@ tracker_priority_queue_new (void)
 	return queue;
 }
 
+/**
+ * tracker_priority_queue_new_indexed:
+ * @hash_func: hash function for the element keys
+ * @key_equal_func: equality function for the element keys
+ * @key_func: (allow-none): function returning the key of an
+ *            element, or %NULL to use elements as their own keys.
+ *
+ * Creates a priority queue that keeps a hash table index of
+ * its elements, so tracker_priority_queue_lookup() and
+ * tracker_priority_queue_remove_all() take constant time.
+ * Element keys must not change while in the queue, see
+ * tracker_priority_queue_replace_data().
+ *
+ * Returns: a new #TrackerPriorityQueue
+ **/
+TrackerPriorityQueue *
+tracker_priority_queue_new_indexed (GHashFunc                   hash_func,
+                                    GEqualFunc                  key_equal_func,
+                                    TrackerPriorityQueueKeyFunc key_func)
+{
+	TrackerPriorityQueue *queue;
+
+	g_return_val_if_fail (hash_func != NULL, NULL);
+	g_return_val_if_fail (key_equal_func != NULL, NULL);
+
+	queue = tracker_priority_queue_new ();
+	queue->index = g_hash_table_new_full (hash_func, key_equal_func, NULL,
+	                                      (GDestroyNotify) index_entry_free_chain);
+	queue->key_func = key_func;
+
+	return queue;
+}
+
 TrackerPriorityQueue *
 tracker_priority_queue_ref (TrackerPriorityQueue *queue)
 {
@@ -66,6 +205,10 @@ void
 tracker_priority_queue_unref (TrackerPriorityQueue *queue)
 {
 	if (g_atomic_int_dec_and_test (&queue->ref_count)) {
+		if (queue->index) {
+			g_hash_table_unref (queue->index);
+		}
+
 		g_queue_clear (&queue->queue);
 		g_array_free (queue->segments, TRUE);
 		g_slice_free (TrackerPriorityQueue, queue);
@@ -174,6 +317,8 @@ insert_node (TrackerPriorityQueue *queue,
 			g_array_append_val (queue->segments, new_segment);
 		}
 	}
+
+	index_add (queue, node, priority);
 }
 
 void
@@ -236,6 +381,8 @@ tracker_priority_queue_foreach_remove (TrackerPriorityQueue *queue,
 				segment->last_elem = elem->prev;
 			}
 
+			index_remove (queue, elem);
+
 			if (destroy_notify) {
 				(destroy_notify) (elem->data);
 			}
@@ -311,6 +458,8 @@ tracker_priority_queue_remove_node (TrackerPriorityQueue *queue,
 
 	g_return_if_fail (queue != NULL);
 
+	index_remove (queue, node);
+
 	/* Check if it is the first or last of a segment */
 	for (i = 0; i < queue->segments->len; i++) {
 		PrioritySegment *segment;
@@ -442,6 +591,8 @@ tracker_priority_queue_pop_node (TrackerPriorityQueue *queue,
 		segment->first_elem = segment->first_elem->next;
 	}
 
+	index_remove (queue, node);
+
 	return g_queue_pop_head_link (&queue->queue);
 }
 
@@ -452,3 +603,134 @@ tracker_priority_queue_get_head (TrackerPriorityQueue *queue)
 
 	return queue->queue.head;
 }
+
+/**
+ * tracker_priority_queue_lookup_node:
+ * @queue: an indexed #TrackerPriorityQueue
+ * @key: key to look up
+ * @priority_out: (out) (allow-none): return location for the priority
+ *
+ * Looks up the first queued element whose key equals @key.
+ *
+ * Returns: the #GList node holding the element, or %NULL
+ **/
+GList *
+tracker_priority_queue_lookup_node (TrackerPriorityQueue *queue,
+                                    gconstpointer         key,
+                                    gint                 *priority_out)
+{
+	IndexEntry *entry;
+
+	g_return_val_if_fail (queue != NULL, NULL);
+	g_return_val_if_fail (queue->index != NULL, NULL);
+
+	entry = g_hash_table_lookup (queue->index, key);
+
+	if (!entry) {
+		return NULL;
+	}
+
+	if (priority_out) {
+		*priority_out = entry->priority;
+	}
+
+	return entry->node;
+}
+
+gpointer
+tracker_priority_queue_lookup (TrackerPriorityQueue *queue,
+                               gconstpointer         key,
+                               gint                 *priority_out)
+{
+	GList *node;
+
+	node = tracker_priority_queue_lookup_node (queue, key, priority_out);
+
+	return node ? node->data : NULL;
+}
+
+/**
+ * tracker_priority_queue_remove_all:
+ * @queue: an indexed #TrackerPriorityQueue
+ * @key: key of the elements to remove
+ * @destroy_notify: (allow-none): function to free removed elements
+ *
+ * Removes every queued element whose key equals @key.
+ *
+ * Returns: %TRUE if any element was removed
+ **/
+gboolean
+tracker_priority_queue_remove_all (TrackerPriorityQueue *queue,
+                                   gconstpointer         key,
+                                   GDestroyNotify        destroy_notify)
+{
+	GList *node;
+	gboolean removed = FALSE;
+
+	g_return_val_if_fail (queue != NULL, FALSE);
+	g_return_val_if_fail (queue->index != NULL, FALSE);
+
+	while ((node = tracker_priority_queue_lookup_node (queue, key, NULL)) != NULL) {
+		gpointer data;
+
+		data = node->data;
+		tracker_priority_queue_remove_node (queue, node);
+
+		if (destroy_notify) {
+			(destroy_notify) (data);
+		}
+
+		removed = TRUE;
+	}
+
+	return removed;
+}
+
+/**
+ * tracker_priority_queue_replace_data:
+ * @queue: a #TrackerPriorityQueue
+ * @node: a node in @queue
+ * @data: the new element
+ *
+ * Replaces the element in @node, keeping its place in the
+ * queue. Indexed queues must use this if the element key
+ * changes.
+ *
+ * Returns: the replaced element
+ **/
+gpointer
+tracker_priority_queue_replace_data (TrackerPriorityQueue *queue,
+                                     GList                *node,
+                                     gpointer              data)
+{
+	gpointer old_data;
+	gint priority = 0;
+
+	g_return_val_if_fail (queue != NULL, NULL);
+	g_return_val_if_fail (node != NULL, NULL);
+	g_return_val_if_fail (data != NULL, NULL);
+
+	if (queue->index) {
+		IndexEntry *entry;
+
+		entry = g_hash_table_lookup (queue->index,
+		                             index_get_key (queue, node->data));
+
+		while (entry && entry->node != node) {
+			entry = entry->next;
+		}
+
+		g_assert (entry != NULL);
+		priority = entry->priority;
+		index_remove (queue, node);
+	}
+
+	old_data = node->data;
+	node->data = data;
+
+	if (queue->index) {
+		index_add (queue, node, priority);
+	}
+
+	return old_data;
+}
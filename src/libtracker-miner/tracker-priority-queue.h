@@ -28,7 +28,12 @@ G_BEGIN_DECLS
 
 typedef struct _TrackerPriorityQueue TrackerPriorityQueue;
 
+typedef gpointer (* TrackerPriorityQueueKeyFunc) (gpointer data);
+
 TrackerPriorityQueue *tracker_priority_queue_new   (void);
+TrackerPriorityQueue *tracker_priority_queue_new_indexed (GHashFunc                   hash_func,
+                                                          GEqualFunc                  key_equal_func,
+                                                          TrackerPriorityQueueKeyFunc key_func);
 
 TrackerPriorityQueue *tracker_priority_queue_ref   (TrackerPriorityQueue *queue);
 void                  tracker_priority_queue_unref (TrackerPriorityQueue *queue);
@@ -68,6 +73,21 @@ void     tracker_priority_queue_remove_node (TrackerPriorityQueue  *queue,
 GList *  tracker_priority_queue_pop_node    (TrackerPriorityQueue *queue,
                                              gint                 *priority_out);
 
+/* Only for indexed queues */
+gpointer tracker_priority_queue_lookup      (TrackerPriorityQueue *queue,
+                                             gconstpointer         key,
+                                             gint                 *priority_out);
+GList *  tracker_priority_queue_lookup_node (TrackerPriorityQueue *queue,
+                                             gconstpointer         key,
+                                             gint                 *priority_out);
+gboolean tracker_priority_queue_remove_all  (TrackerPriorityQueue *queue,
+                                             gconstpointer         key,
+                                             GDestroyNotify        destroy_notify);
+
+gpointer tracker_priority_queue_replace_data (TrackerPriorityQueue *queue,
+                                              GList                *node,
+                                              gpointer              data);
+
 
 G_END_DECLS
 
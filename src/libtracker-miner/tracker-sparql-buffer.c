@@ -28,6 +28,17 @@
 /* Maximum time (seconds) before forcing a sparql buffer flush */
 #define MAX_SPARQL_BUFFER_TIME  15
 
+/* Batches are sized so an array-update takes about this
+ * long (usecs) to come back from the store, including the
+ * time spent waiting in its queue.
+ */
+#define TARGET_UPDATE_TIME      (G_USEC_PER_SEC / 2)
+
+/* Batch size histogram buckets, bucket n holds
+ * batches of 2^n to 2^(n+1) - 1 tasks.
+ */
+#define N_BATCH_SIZE_BUCKETS    16
+
 typedef struct _TrackerSparqlBufferPrivate TrackerSparqlBufferPrivate;
 typedef struct _SparqlTaskData SparqlTaskData;
 typedef struct _UpdateArrayData UpdateArrayData;
@@ -51,6 +62,15 @@ struct _TrackerSparqlBufferPrivate
 	guint flush_timeout_id;
 	GPtrArray *tasks;
 	gint n_updates;
+
+	/* Number of tasks that triggers a flush, adapted to
+	 * how long the last array-updates took.
+	 */
+	guint batch_size;
+	gint n_high_priority_updates;
+	gboolean high_priority_seen;
+
+	guint batch_size_histogram[N_BATCH_SIZE_BUCKETS];
 };
 
 struct _SparqlTaskData
@@ -82,6 +102,8 @@ struct _UpdateArrayData {
 	GArray *error_map;
 	GPtrArray *bulk_ops;
 	gint n_bulk_operations;
+	gint64 start_time;
+	gboolean full;
 };
 
 struct _BulkOperationMerge {
@@ -207,6 +229,86 @@ tracker_sparql_buffer_init (TrackerSparqlBuffer *buffer)
 	                                            TrackerSparqlBufferPrivate);
 }
 
+static guint
+get_batch_size (TrackerSparqlBuffer *buffer)
+{
+	TrackerSparqlBufferPrivate *priv;
+	guint limit;
+
+	priv = buffer->priv;
+	limit = tracker_task_pool_get_limit (TRACKER_TASK_POOL (buffer));
+
+	/* Start off flushing at half the limit, as the
+	 * buffer always did before adapting batch sizes.
+	 */
+	if (priv->batch_size == 0) {
+		priv->batch_size = MAX (limit / 2, 1);
+	}
+
+	return CLAMP (priv->batch_size, 1, MAX (limit, 1));
+}
+
+static void
+adapt_batch_size (TrackerSparqlBuffer *buffer,
+                  UpdateArrayData     *update_data,
+                  gboolean             failed)
+{
+	TrackerSparqlBufferPrivate *priv;
+	guint batch_size, old_batch_size;
+	gint64 elapsed;
+
+	priv = buffer->priv;
+	old_batch_size = batch_size = get_batch_size (buffer);
+	elapsed = g_get_monotonic_time () - update_data->start_time;
+
+	/* Additive increase, multiplicative decrease: batches
+	 * shrink quickly as soon as the store is slow to answer,
+	 * or high priority updates had to wait behind one, and
+	 * only grow back gradually while commits are cheap.
+	 */
+	if (failed ||
+	    priv->high_priority_seen ||
+	    elapsed > TARGET_UPDATE_TIME) {
+		batch_size = MAX (batch_size / 2, 1);
+	} else if (update_data->full &&
+	           priv->n_high_priority_updates == 0 &&
+	           elapsed < TARGET_UPDATE_TIME / 2) {
+		/* Only grow if the batch was full, small
+		 * batches flushed on timeout say nothing
+		 * about how big batches would behave.
+		 */
+		batch_size += MAX (batch_size / 4, 1);
+	}
+
+	priv->high_priority_seen = FALSE;
+	priv->batch_size = batch_size;
+	batch_size = get_batch_size (buffer);
+
+	if (batch_size != old_batch_size) {
+		g_debug ("(Sparql buffer) Array-update of %u tasks took %" G_GINT64_FORMAT "ms, "
+		         "batch size changed from %u to %u",
+		         update_data->tasks->len, elapsed / 1000,
+		         old_batch_size, batch_size);
+	}
+}
+
+static void
+record_batch_size (TrackerSparqlBuffer *buffer,
+                   guint                n_tasks)
+{
+	TrackerSparqlBufferPrivate *priv;
+	guint bucket = 0;
+
+	priv = buffer->priv;
+
+	while (n_tasks > 1 && bucket < N_BATCH_SIZE_BUCKETS - 1) {
+		n_tasks >>= 1;
+		bucket++;
+	}
+
+	priv->batch_size_histogram[bucket]++;
+}
+
 TrackerSparqlBuffer *
 tracker_sparql_buffer_new (TrackerSparqlConnection *connection,
                            guint                    limit)
@@ -367,6 +469,8 @@ tracker_sparql_buffer_update_array_cb (GObject      *object,
 		 * unref-ing the UpdateArrayData below */
 	}
 
+	adapt_batch_size (update_data->buffer, update_data, global_error != NULL);
+
 	/* Unref the arrays of errors and queries */
 	if (sparql_array_errors) {
 		g_ptr_array_unref (sparql_array_errors);
@@ -599,6 +703,10 @@ tracker_sparql_buffer_flush (TrackerSparqlBuffer *buffer,
 	update_data->n_bulk_operations = bulk_ops ? bulk_ops->len : 0;
 	update_data->error_map = error_map;
 	update_data->sparql_array = sparql_array;
+	update_data->full = priv->tasks->len >= get_batch_size (buffer);
+	update_data->start_time = g_get_monotonic_time ();
+
+	record_batch_size (buffer, priv->tasks->len);
 
 	/* Empty pool, update_data will keep
 	 * references to the tasks to keep
@@ -620,15 +728,59 @@ tracker_sparql_buffer_flush (TrackerSparqlBuffer *buffer,
 	return TRUE;
 }
 
+/**
+ * tracker_sparql_buffer_get_batch_size:
+ * @buffer: a #TrackerSparqlBuffer
+ *
+ * Returns: the number of buffered tasks currently triggering a flush.
+ **/
+guint
+tracker_sparql_buffer_get_batch_size (TrackerSparqlBuffer *buffer)
+{
+	g_return_val_if_fail (TRACKER_IS_SPARQL_BUFFER (buffer), 0);
+
+	return get_batch_size (buffer);
+}
+
+/**
+ * tracker_sparql_buffer_get_batch_size_histogram:
+ * @buffer: a #TrackerSparqlBuffer
+ * @n_buckets: return location for the number of buckets
+ *
+ * Returns the number of flushed batches by size, bucket n
+ * counting batches of 2^n to 2^(n+1) - 1 tasks, the last
+ * bucket also counting all bigger batches.
+ *
+ * Returns: an array of @n_buckets counts, owned by @buffer.
+ **/
+const guint *
+tracker_sparql_buffer_get_batch_size_histogram (TrackerSparqlBuffer *buffer,
+                                                guint               *n_buckets)
+{
+	TrackerSparqlBufferPrivate *priv;
+
+	g_return_val_if_fail (TRACKER_IS_SPARQL_BUFFER (buffer), NULL);
+	g_return_val_if_fail (n_buckets != NULL, NULL);
+
+	priv = buffer->priv;
+	*n_buckets = N_BATCH_SIZE_BUCKETS;
+
+	return priv->batch_size_histogram;
+}
+
 static void
 tracker_sparql_buffer_update_cb (GObject      *object,
                                  GAsyncResult *result,
                                  gpointer      user_data)
 {
 	UpdateData *update_data = user_data;
+	TrackerSparqlBufferPrivate *priv;
 	SparqlTaskData *task_data;
 	GError *error = NULL;
 
+	priv = update_data->buffer->priv;
+	priv->n_high_priority_updates--;
+
 	tracker_sparql_connection_update_finish (TRACKER_SPARQL_CONNECTION (object),
 	                                         result, &error);
 
@@ -685,6 +837,15 @@ tracker_sparql_buffer_push (TrackerSparqlBuffer *buffer,
 			sparql = tracker_sparql_builder_get_result (data->data.builder);
 		}
 
+		/* Batches in flight are delaying this one,
+		 * so make the next ones smaller.
+		 */
+		if (priv->n_updates > 0) {
+			priv->high_priority_seen = TRUE;
+		}
+
+		priv->n_high_priority_updates++;
+
 		tracker_task_pool_add (TRACKER_TASK_POOL (buffer), task);
 		tracker_sparql_connection_update_async (priv->connection,
 		                                        sparql,
@@ -707,9 +868,9 @@ tracker_sparql_buffer_push (TrackerSparqlBuffer *buffer,
 
 		if (tracker_task_pool_limit_reached (TRACKER_TASK_POOL (buffer))) {
 			tracker_sparql_buffer_flush (buffer, "SPARQL buffer limit reached");
-		} else if (priv->tasks->len > tracker_task_pool_get_limit (TRACKER_TASK_POOL (buffer)) / 2) {
-			/* We've filled half of the buffer, flush it as we receive more tasks */
-			tracker_sparql_buffer_flush (buffer, "SPARQL buffer half-full");
+		} else if (priv->tasks->len >= get_batch_size (buffer)) {
+			/* We've got a batch worth of tasks, flush it as we receive more tasks */
+			tracker_sparql_buffer_flush (buffer, "SPARQL buffer batch size reached");
 		}
 	}
 }
@@ -73,6 +73,10 @@ void                 tracker_sparql_buffer_push  (TrackerSparqlBuffer *buffer,
                                                   GAsyncReadyCallback  cb,
                                                   gpointer             user_data);
 
+guint                tracker_sparql_buffer_get_batch_size           (TrackerSparqlBuffer *buffer);
+const guint *        tracker_sparql_buffer_get_batch_size_histogram (TrackerSparqlBuffer *buffer,
+                                                                     guint               *n_buckets);
+
 TrackerTask *        tracker_sparql_task_new_take_sparql_str (GFile                *file,
                                                               gchar                *sparql_str);
 TrackerTask *        tracker_sparql_task_new_with_sparql_str (GFile                *file,
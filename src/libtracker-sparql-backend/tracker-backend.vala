@@ -89,6 +89,17 @@ class Tracker.Sparql.Backend : Connection {
 		}
 	}
 
+	public async override Cursor query_snapshot_async (string sparql, Cancellable? cancellable = null) throws Sparql.Error, IOError, DBusError {
+		debug ("%s(): '%s'", Log.METHOD, sparql);
+		// direct access would hold the read transaction for as long
+		// as the cursor is used, tracker-store doesn't
+		if (bus != null) {
+			return yield bus.query_snapshot_async (sparql, cancellable);
+		} else {
+			return yield direct.query_snapshot_async (sparql, cancellable);
+		}
+	}
+
 	public override void update (string sparql, int priority = GLib.Priority.DEFAULT, Cancellable? cancellable = null) throws Sparql.Error, IOError, DBusError {
 		debug ("%s(priority:%d): '%s'", Log.METHOD, priority, sparql);
 		if (bus == null) {
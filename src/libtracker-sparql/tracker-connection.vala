@@ -256,6 +256,42 @@ public abstract class Tracker.Sparql.Connection : Object {
 	 */
 	public async abstract Cursor query_async (string sparql, Cancellable? cancellable = null) throws Sparql.Error, IOError, DBusError;
 
+	/**
+	 * tracker_sparql_connection_query_snapshot_async:
+	 * @self: a #TrackerSparqlConnection
+	 * @sparql: string containing the SPARQL query
+	 * @cancellable: a #GCancellable used to cancel the operation
+	 * @_callback_: user-defined #GAsyncReadyCallback to be called when
+	 *              asynchronous operation is finished.
+	 * @_user_data_: user-defined data to be passed to @_callback_
+	 *
+	 * Executes asynchronously a SPARQL query whose results are kept in a
+	 * temporary file rather than in the database. Unlike with
+	 * tracker_sparql_connection_query_async(), the database isn't kept
+	 * from being written out however long the cursor is used, which
+	 * makes this suited to exporting large results.
+	 *
+	 * Since: 0.18
+	 */
+
+	/**
+	 * tracker_sparql_connection_query_snapshot_finish:
+	 * @self: a #TrackerSparqlConnection
+	 * @_res_: a #GAsyncResult with the result of the operation
+	 * @error: #GError for error reporting.
+	 *
+	 * Finishes the asynchronous snapshot query operation.
+	 *
+	 * Returns: a #TrackerSparqlCursor if results were found, #NULL otherwise.
+	 * On error, #NULL is returned and the @error is set accordingly.
+	 * Call g_object_unref() on the returned cursor when no longer needed.
+	 *
+	 * Since: 0.18
+	 */
+	public async virtual Cursor query_snapshot_async (string sparql, Cancellable? cancellable = null) throws Sparql.Error, IOError, DBusError {
+		return yield query_async (sparql, cancellable);
+	}
+
 	/**
 	 * tracker_sparql_connection_update:
 	 * @self: a #TrackerSparqlConnection
@@ -368,6 +404,37 @@ public abstract class Tracker.Sparql.Connection : Object {
 		return null;
 	}
 
+	/**
+	 * tracker_sparql_connection_update_statements_async:
+	 * @self: a #TrackerSparqlConnection
+	 * @statements: a #TrackerSparqlStatements
+	 * @priority: the priority for the asynchronous operation
+	 * @cancellable: a #GCancellable used to cancel the operation
+	 * @_callback_: user-defined #GAsyncReadyCallback to be called when
+	 *              asynchronous operation is finished.
+	 * @_user_data_: user-defined data to be passed to @_callback_
+	 *
+	 * Applies asynchronously all statements added to @statements in a
+	 * single transaction, without going through SPARQL. @statements is
+	 * emptied, so it can be reused for the next batch.
+	 *
+	 * Since: 0.18
+	 */
+
+	/**
+	 * tracker_sparql_connection_update_statements_finish:
+	 * @self: a #TrackerSparqlConnection
+	 * @_res_: a #GAsyncResult with the result of the operation
+	 * @error: #GError for error reporting.
+	 *
+	 * Finishes the asynchronous statements update operation.
+	 *
+	 * Since: 0.18
+	 */
+	public async virtual void update_statements_async (Statements statements, int priority = GLib.Priority.DEFAULT, Cancellable? cancellable = null) throws Sparql.Error, IOError, DBusError {
+		warning ("Interface 'update_statements_async' not implemented");
+	}
+
 	/**
 	 * tracker_sparql_connection_update_blank:
 	 * @self: a #TrackerSparqlConnection
@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+/**
+ * SECTION: tracker-sparql-statements
+ * @short_description: Batches of statements to insert or delete
+ * @title: TrackerSparqlStatements
+ * @stability: Unstable
+ * @include: tracker-sparql.h
+ *
+ * <para>
+ * #TrackerSparqlStatements gathers subject/predicate/object triples to
+ * insert, delete or update. Unlike #TrackerSparqlBuilder, no SPARQL is
+ * generated: the triples are sent to tracker-store as they are, and
+ * applied there without being parsed again. Use
+ * tracker_sparql_connection_update_statements_async() to apply them.
+ * </para>
+ *
+ * <para>
+ * Subjects, predicates and resource objects are full IRIs, without
+ * surrounding angle brackets. Literal objects are given in the format
+ * tracker-store returns them in, typed helpers are provided for the
+ * common types.
+ * </para>
+ */
+
+/**
+ * TrackerSparqlStatements:
+ *
+ * The <structname>TrackerSparqlStatements</structname> object represents
+ * a batch of statements to apply in one transaction.
+ *
+ * Since: 0.18
+ */
+public class Tracker.Sparql.Statements : Object {
+
+	/**
+	 * TrackerSparqlStatementsOperation:
+	 * @TRACKER_SPARQL_STATEMENTS_OPERATION_INSERT: Insert the statement
+	 * @TRACKER_SPARQL_STATEMENTS_OPERATION_DELETE: Delete the statement
+	 * @TRACKER_SPARQL_STATEMENTS_OPERATION_UPDATE: Replace the values of
+	 * the predicate with the object, or delete them all if there is no object
+	 *
+	 * Enumeration with the operations done on each statement.
+	 */
+	public enum Operation {
+		INSERT,
+		DELETE,
+		UPDATE
+	}
+
+	/**
+	 * tracker_sparql_statements_get_length:
+	 * @self: a #TrackerSparqlStatements
+	 *
+	 * Returns the number of statements added to @self.
+	 *
+	 * Returns: the number of statements.
+	 *
+	 * Since: 0.18
+	 */
+
+	/**
+	 * TrackerSparqlStatements:length:
+	 *
+	 * Number of statements added to the #TrackerSparqlStatements.
+	 *
+	 * Since: 0.18
+	 */
+	public int length {
+		get;
+		private set;
+	}
+
+	VariantBuilder builder = new VariantBuilder ((VariantType) "a(ymsssms)");
+
+	/**
+	 * tracker_sparql_statements_new:
+	 *
+	 * Creates an empty #TrackerSparqlStatements.
+	 *
+	 * Returns: a newly created #TrackerSparqlStatements. Free with g_object_unref() when done
+	 *
+	 * Since: 0.18
+	 */
+	public Statements () {
+	}
+
+	/**
+	 * tracker_sparql_statements_add:
+	 * @self: a #TrackerSparqlStatements
+	 * @operation: operation to do with the statement
+	 * @graph: graph IRI, or %NULL for the default graph
+	 * @subject: subject IRI
+	 * @predicate: predicate IRI
+	 * @object: object, IRI or literal depending on the predicate range. May
+	 * only be %NULL for %TRACKER_SPARQL_STATEMENTS_OPERATION_UPDATE.
+	 *
+	 * Appends a statement.
+	 *
+	 * Since: 0.18
+	 */
+	public void add (Operation operation, string? graph, string subject, string predicate, string? object)
+		requires (object != null || operation == Operation.UPDATE)
+	{
+		builder.add ("(ymsssms)", (uchar) operation, graph, subject, predicate, object);
+
+		length++;
+	}
+
+	/**
+	 * tracker_sparql_statements_insert:
+	 * @self: a #TrackerSparqlStatements
+	 * @graph: graph IRI, or %NULL for the default graph
+	 * @subject: subject IRI
+	 * @predicate: predicate IRI
+	 * @object: object, IRI or literal depending on the predicate range
+	 *
+	 * Appends a statement to insert.
+	 *
+	 * Since: 0.18
+	 */
+	public void insert (string? graph, string subject, string predicate, string object) {
+		add (Operation.INSERT, graph, subject, predicate, object);
+	}
+
+	/**
+	 * tracker_sparql_statements_insert_boolean:
+	 * @self: a #TrackerSparqlStatements
+	 * @graph: graph IRI, or %NULL for the default graph
+	 * @subject: subject IRI
+	 * @predicate: predicate IRI
+	 * @object: object as a #gboolean
+	 *
+	 * Appends a statement with a #gboolean object to insert.
+	 *
+	 * Since: 0.18
+	 */
+	public void insert_boolean (string? graph, string subject, string predicate, bool object) {
+		insert (graph, subject, predicate, object ? "true" : "false");
+	}
+
+	/**
+	 * tracker_sparql_statements_insert_int64:
+	 * @self: a #TrackerSparqlStatements
+	 * @graph: graph IRI, or %NULL for the default graph
+	 * @subject: subject IRI
+	 * @predicate: predicate IRI
+	 * @object: object as a #gint64
+	 *
+	 * Appends a statement with a #gint64 object to insert.
+	 *
+	 * Since: 0.18
+	 */
+	public void insert_int64 (string? graph, string subject, string predicate, int64 object) {
+		insert (graph, subject, predicate, object.to_string ());
+	}
+
+	/**
+	 * tracker_sparql_statements_insert_double:
+	 * @self: a #TrackerSparqlStatements
+	 * @graph: graph IRI, or %NULL for the default graph
+	 * @subject: subject IRI
+	 * @predicate: predicate IRI
+	 * @object: object as a #gdouble
+	 *
+	 * Appends a statement with a #gdouble object to insert.
+	 *
+	 * Since: 0.18
+	 */
+	public void insert_double (string? graph, string subject, string predicate, double object) {
+		insert (graph, subject, predicate, object.to_string ());
+	}
+
+	/**
+	 * tracker_sparql_statements_insert_date:
+	 * @self: a #TrackerSparqlStatements
+	 * @graph: graph IRI, or %NULL for the default graph
+	 * @subject: subject IRI
+	 * @predicate: predicate IRI
+	 * @object: object as a #time_t
+	 *
+	 * Appends a statement with a #time_t object to insert. @object
+	 * will be converted to the date format used by tracker-store.
+	 *
+	 * Since: 0.18
+	 */
+	public void insert_date (string? graph, string subject, string predicate, time_t object) {
+		var tm = Time.gm (object);
+
+		insert (graph, subject, predicate,
+		        "%04d-%02d-%02dT%02d:%02d:%02dZ".printf (tm.year + 1900, tm.month + 1, tm.day, tm.hour, tm.minute, tm.second));
+	}
+
+	/**
+	 * tracker_sparql_statements_delete:
+	 * @self: a #TrackerSparqlStatements
+	 * @graph: graph IRI, or %NULL for the default graph
+	 * @subject: subject IRI
+	 * @predicate: predicate IRI
+	 * @object: object, IRI or literal depending on the predicate range
+	 *
+	 * Appends a statement to delete.
+	 *
+	 * Since: 0.18
+	 */
+	public void @delete (string? graph, string subject, string predicate, string object) {
+		add (Operation.DELETE, graph, subject, predicate, object);
+	}
+
+	/**
+	 * tracker_sparql_statements_update:
+	 * @self: a #TrackerSparqlStatements
+	 * @graph: graph IRI, or %NULL for the default graph
+	 * @subject: subject IRI
+	 * @predicate: predicate IRI
+	 * @object: object, IRI or literal depending on the predicate range,
+	 * or %NULL to delete all values
+	 *
+	 * Appends a statement replacing the values of @predicate.
+	 *
+	 * Since: 0.18
+	 */
+	public void update (string? graph, string subject, string predicate, string? object) {
+		add (Operation.UPDATE, graph, subject, predicate, object);
+	}
+
+	/**
+	 * tracker_sparql_statements_end:
+	 * @self: a #TrackerSparqlStatements
+	 *
+	 * Returns the statements added so far, and starts an empty
+	 * batch in @self.
+	 *
+	 * Returns: a #GVariant of type "a(ymsssms)", free with g_variant_unref()
+	 * when no longer used.
+	 *
+	 * Since: 0.18
+	 */
+	public Variant end () {
+		var statements = builder.end ();
+
+		builder = new VariantBuilder ((VariantType) "a(ymsssms)");
+		length = 0;
+
+		return statements;
+	}
+}
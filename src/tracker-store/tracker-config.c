@@ -32,6 +32,7 @@
 #include "tracker-config.h"
 
 #define GRAPHUPDATED_DELAY_DEFAULT	1000
+#define VERIFY_STATISTICS_DEFAULT	FALSE
 
 static void config_set_property         (GObject       *object,
                                          guint          param_id,
@@ -48,6 +49,7 @@ enum {
 	PROP_0,
 	PROP_VERBOSITY,
 	PROP_GRAPHUPDATED_DELAY,
+	PROP_VERIFY_STATISTICS,
 };
 
 static TrackerConfigMigrationEntry migration[] = {
@@ -87,6 +89,14 @@ tracker_config_class_init (TrackerConfigClass *klass)
 	                                                    GRAPHUPDATED_DELAY_DEFAULT,
 	                                                    G_PARAM_READWRITE));
 
+	g_object_class_install_property (object_class,
+	                                 PROP_VERIFY_STATISTICS,
+	                                 g_param_spec_boolean ("verify-statistics",
+	                                                       "Verify statistics",
+	                                                       "Check kept class instance counts in the background",
+	                                                       VERIFY_STATISTICS_DEFAULT,
+	                                                       G_PARAM_READWRITE));
+
 }
 
 static void
@@ -106,6 +116,11 @@ config_set_property (GObject      *object,
 		                                       g_value_get_int (value));
 		break;
 
+	case PROP_VERIFY_STATISTICS:
+		tracker_config_set_verify_statistics (TRACKER_CONFIG (object),
+		                                      g_value_get_boolean (value));
+		break;
+
 	case PROP_VERBOSITY:
 		tracker_config_set_verbosity (TRACKER_CONFIG (object),
 		                              g_value_get_enum (value));
@@ -127,6 +142,10 @@ config_get_property (GObject    *object,
 		g_value_set_int (value, tracker_config_get_graphupdated_delay (TRACKER_CONFIG (object)));
 		break;
 
+	case PROP_VERIFY_STATISTICS:
+		g_value_set_boolean (value, tracker_config_get_verify_statistics (TRACKER_CONFIG (object)));
+		break;
+
 		/* General */
 	case PROP_VERBOSITY:
 		g_value_set_enum (value, tracker_config_get_verbosity (TRACKER_CONFIG (object)));
@@ -210,3 +229,21 @@ tracker_config_set_graphupdated_delay (TrackerConfig *config,
 	g_settings_set_int(G_SETTINGS (config), "graphupdated-delay", value);
 	g_object_notify (G_OBJECT (config), "graphupdated-delay");
 }
+
+gboolean
+tracker_config_get_verify_statistics (TrackerConfig *config)
+{
+	g_return_val_if_fail (TRACKER_IS_CONFIG (config), VERIFY_STATISTICS_DEFAULT);
+
+	return g_settings_get_boolean (G_SETTINGS (config), "verify-statistics");
+}
+
+void
+tracker_config_set_verify_statistics (TrackerConfig *config,
+                                      gboolean       value)
+{
+	g_return_if_fail (TRACKER_IS_CONFIG (config));
+
+	g_settings_set_boolean (G_SETTINGS (config), "verify-statistics", value);
+	g_object_notify (G_OBJECT (config), "verify-statistics");
+}
@@ -56,6 +56,11 @@ gint           tracker_config_get_graphupdated_delay               (TrackerConfi
 void           tracker_config_set_graphupdated_delay               (TrackerConfig *config,
                                                                     gint           value);
 
+gboolean       tracker_config_get_verify_statistics                (TrackerConfig *config);
+
+void           tracker_config_set_verify_statistics                (TrackerConfig *config,
+                                                                    gboolean       value);
+
 G_END_DECLS
 
 #endif /* __TRACKER_STORE_CONFIG_H__ */
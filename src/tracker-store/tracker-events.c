@@ -126,6 +126,37 @@ tracker_events_reset_pending (void)
 	private->frozen = FALSE;
 }
 
+void
+tracker_events_release_savepoint (void)
+{
+	guint i;
+
+	g_return_if_fail (private != NULL);
+
+	for (i = 0; i < private->notify_classes->len; i++) {
+		TrackerClass *class = g_ptr_array_index (private->notify_classes, i);
+
+		tracker_class_stage_events (class);
+	}
+}
+
+void
+tracker_events_rollback_savepoint (void)
+{
+	guint i, dropped = 0;
+
+	g_return_if_fail (private != NULL);
+
+	for (i = 0; i < private->notify_classes->len; i++) {
+		TrackerClass *class = g_ptr_array_index (private->notify_classes, i);
+
+		dropped += tracker_class_reset_unstaged_events (class);
+	}
+
+	/* total may have been reset meanwhile by an emission */
+	private->total -= MIN (private->total, dropped);
+}
+
 void
 tracker_events_freeze (void)
 {
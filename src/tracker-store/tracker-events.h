@@ -48,6 +48,8 @@ void           tracker_events_add_delete        (gint         graph_id,
                                                  GPtrArray   *rdf_types);
 guint          tracker_events_get_total         (gboolean     and_reset);
 void           tracker_events_reset_pending     (void);
+void           tracker_events_release_savepoint (void);
+void           tracker_events_rollback_savepoint (void);
 void           tracker_events_freeze            (void);
 TrackerClass** tracker_events_get_classes       (guint       *length);
 
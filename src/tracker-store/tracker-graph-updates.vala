@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * A client subscribed through Resources.SubscribeGraphUpdates. The
+ * events of the classes and predicates it asked for are written to
+ * its pipe each time GraphUpdated signals are emitted, as one frame
+ * of host endian int32s:
+ *
+ *   frame size (bytes following this one)
+ *   sequence number
+ *   number of classes
+ *   for each class:
+ *     class id, number of deletes, number of inserts
+ *     (graph id, subject id, predicate id, object id) for each
+ *     delete, then for each insert
+ *
+ * Frames are never written blocking. If the client doesn't read fast
+ * enough, frames are dropped, and the client notices the sequence
+ * number gap.
+ */
+public class Tracker.GraphUpdatesSubscription : Object {
+	const uint MAX_PENDING_SIZE = 4 * 1024 * 1024;
+
+	public uint id { get; private set; }
+	public string sender { get; private set; }
+
+	UnixOutputStream output;
+	HashTable<int,bool> classes;
+	HashTable<int,bool> predicates;
+	int seqnum;
+
+	ByteArray pending;
+	bool writing;
+	Cancellable cancellable;
+
+	public signal void closed ();
+
+	public GraphUpdatesSubscription (uint id, string sender, UnixOutputStream output) {
+		this.id = id;
+		this.sender = sender;
+		this.output = output;
+
+		classes = new HashTable<int,bool> (direct_hash, direct_equal);
+		predicates = new HashTable<int,bool> (direct_hash, direct_equal);
+		pending = new ByteArray ();
+		cancellable = new Cancellable ();
+
+		int fd = output.get_fd ();
+		Posix.fcntl (fd, Posix.F_SETFL, Posix.fcntl (fd, Posix.F_GETFL) | Posix.O_NONBLOCK);
+	}
+
+	/* Pending writes keep the subscription alive, cancel them */
+	public void close () {
+		cancellable.cancel ();
+	}
+
+	public void add_class (Class cl) {
+		classes.insert (cl.id, true);
+	}
+
+	/* With no predicates added, events for all of them are sent */
+	public void add_predicate (Property property) {
+		predicates.insert (property.id, true);
+	}
+
+	public bool wants_class (Class cl) {
+		return classes.contains (cl.id);
+	}
+
+	static void put_int32 (ByteArray frame, int value) {
+		uint8 buf[4];
+
+		Memory.copy (buf, &value, sizeof (int));
+		frame.append (buf);
+	}
+
+	static void set_int32 (ByteArray frame, uint offset, int value) {
+		Memory.copy (&frame.data[offset], &value, sizeof (int));
+	}
+
+	void put_event (ByteArray frame, int graph_id, int subject_id, int pred_id, int object_id) {
+		put_int32 (frame, graph_id);
+		put_int32 (frame, subject_id);
+		put_int32 (frame, pred_id);
+		put_int32 (frame, object_id);
+	}
+
+	public void send_events (Class[] updated_classes) {
+		var frame = new ByteArray ();
+		bool all_predicates = (predicates.size () == 0);
+		int n_classes = 0;
+
+		/* Frame size, sequence number and number of classes,
+		 * filled in once the frame is complete.
+		 */
+		put_int32 (frame, 0);
+		put_int32 (frame, 0);
+		put_int32 (frame, 0);
+
+		foreach (unowned Class cl in updated_classes) {
+			if (!wants_class (cl)) {
+				continue;
+			}
+
+			uint class_offset = frame.len;
+			int n_deletes = 0, n_inserts = 0;
+
+			put_int32 (frame, cl.id);
+			put_int32 (frame, 0);
+			put_int32 (frame, 0);
+
+			cl.foreach_delete_event ((graph_id, subject_id, pred_id, object_id) => {
+				if (all_predicates || predicates.contains (pred_id)) {
+					put_event (frame, graph_id, subject_id, pred_id, object_id);
+					n_deletes++;
+				}
+			});
+
+			cl.foreach_insert_event ((graph_id, subject_id, pred_id, object_id) => {
+				if (all_predicates || predicates.contains (pred_id)) {
+					put_event (frame, graph_id, subject_id, pred_id, object_id);
+					n_inserts++;
+				}
+			});
+
+			if (n_deletes == 0 && n_inserts == 0) {
+				frame.set_size (class_offset);
+				continue;
+			}
+
+			set_int32 (frame, class_offset + 4, n_deletes);
+			set_int32 (frame, class_offset + 8, n_inserts);
+			n_classes++;
+		}
+
+		if (n_classes == 0) {
+			return;
+		}
+
+		set_int32 (frame, 0, (int) frame.len - 4);
+		set_int32 (frame, 4, seqnum++);
+		set_int32 (frame, 8, n_classes);
+
+		if (pending.len + frame.len > MAX_PENDING_SIZE) {
+			debug ("Dropping graph updates frame for subscription %u of %s, client is not reading",
+			       id, sender);
+			return;
+		}
+
+		pending.append (frame.data);
+
+		if (!writing) {
+			write_pending.begin ();
+		}
+	}
+
+	async void write_pending () {
+		writing = true;
+
+		while (pending.len > 0) {
+			var bytes = new Bytes (pending.data);
+			size_t offset = 0;
+
+			pending.set_size (0);
+
+			while (offset < bytes.get_size ()) {
+				try {
+					var remaining = new Bytes.from_bytes (bytes, offset, bytes.get_size () - offset);
+					offset += yield output.write_bytes_async (remaining, GLib.Priority.DEFAULT, cancellable);
+				} catch (Error e) {
+					if (!(e is IOError.CANCELLED)) {
+						debug ("Closing graph updates subscription %u of %s: %s",
+						       id, sender, e.message);
+						closed ();
+					}
+
+					writing = false;
+					return;
+				}
+			}
+		}
+
+		writing = false;
+	}
+}
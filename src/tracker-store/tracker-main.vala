@@ -60,6 +60,7 @@ License which can be viewed at:
 		message ("Store options:");
 		message ("  Readonly mode  ........................  %s", readonly_mode ? "yes" : "no");
 		message ("  GraphUpdated Delay ....................  %d", config.graphupdated_delay);
+		message ("  Verify statistics .....................  %s", config.verify_statistics ? "yes" : "no");
 	}
 
 	static void do_shutdown () {
@@ -296,6 +297,10 @@ License which can be viewed at:
 			Tracker.Writeback.init (get_writeback_predicates);
 			Tracker.Store.resume ();
 
+			if (config.verify_statistics) {
+				Tracker.Store.verify_class_counts ();
+			}
+
 			message ("Waiting for D-Bus requests...");
 		}
 
@@ -54,12 +54,17 @@ public class Tracker.Resources : Object {
 	bool regular_commit_pending;
 	Tracker.Config config;
 
+	HashTable<uint,GraphUpdatesSubscription> subscriptions;
+	uint last_subscription_id;
+
 	public signal void writeback ([DBus (signature = "a{iai}")] Variant subjects);
 	public signal void graph_updated (string classname, [DBus (signature = "a(iiii)")] Variant deletes, [DBus (signature = "a(iiii)")] Variant inserts);
 
 	public Resources (DBusConnection connection, Tracker.Config config_p) {
 		this.connection = connection;
 		this.config = config_p;
+
+		subscriptions = new HashTable<uint,GraphUpdatesSubscription> (direct_hash, direct_equal);
 	}
 
 	public async void load (BusName sender, string uri) throws Error {
@@ -200,6 +205,92 @@ public class Tracker.Resources : Object {
 		/* no longer needed, just return */
 	}
 
+	public uint subscribe_graph_updates (BusName sender, string[] classes, string[] predicates, UnixOutputStream output_stream) throws Error {
+		var request = DBusRequest.begin (sender, "Resources.SubscribeGraphUpdates");
+		try {
+			var subscription = new GraphUpdatesSubscription (last_subscription_id + 1, sender, output_stream);
+
+			foreach (string class_uri in classes) {
+				var cl = Ontologies.get_class_by_uri (class_uri);
+
+				if (cl == null) {
+					throw new Sparql.Error.UNKNOWN_CLASS ("Unknown class '%s'", class_uri);
+				}
+
+				if (!cl.notify) {
+					throw new Sparql.Error.UNSUPPORTED ("Class '%s' has no tracker:notify", class_uri);
+				}
+
+				subscription.add_class (cl);
+			}
+
+			foreach (string predicate_uri in predicates) {
+				var property = Ontologies.get_property_by_uri (predicate_uri);
+
+				if (property == null) {
+					throw new Sparql.Error.UNKNOWN_PROPERTY ("Unknown property '%s'", predicate_uri);
+				}
+
+				subscription.add_predicate (property);
+			}
+
+			last_subscription_id++;
+			subscriptions.insert (subscription.id, subscription);
+			subscription.closed.connect (on_subscription_closed);
+
+			request.debug ("subscription: %u", subscription.id);
+			request.end ();
+
+			return subscription.id;
+		} catch (Error e) {
+			request.end (e);
+			throw e;
+		}
+	}
+
+	public void unsubscribe_graph_updates (BusName sender, uint id) throws Error {
+		var request = DBusRequest.begin (sender, "Resources.UnsubscribeGraphUpdates (id: %u)", id);
+		var subscription = subscriptions.lookup (id);
+
+		if (subscription == null || subscription.sender != sender) {
+			var e = new DBusError.INVALID_ARGS ("No graph updates subscription %u", id);
+			request.end (e);
+			throw e;
+		}
+
+		remove_subscription (subscription);
+		request.end ();
+	}
+
+	void remove_subscription (GraphUpdatesSubscription subscription) {
+		subscription.closed.disconnect (on_subscription_closed);
+		subscription.close ();
+		subscriptions.remove (subscription.id);
+	}
+
+	void on_subscription_closed (GraphUpdatesSubscription subscription) {
+		remove_subscription (subscription);
+	}
+
+	void send_subscribed_events () {
+		Class[] updated_classes = {};
+
+		/* Only classes some subscription asked for are serialized */
+		foreach (var cl in Tracker.Events.get_classes ()) {
+			if (cl.has_insert_events () || cl.has_delete_events ()) {
+				updated_classes += cl;
+			}
+		}
+
+		if (updated_classes.length == 0) {
+			return;
+		}
+
+		foreach (var subscription in subscriptions.get_values ()) {
+			subscription.send_events (updated_classes);
+		}
+	}
+
 	bool emit_graph_updated (Class cl) {
 		if (cl.has_insert_events () || cl.has_delete_events ()) {
 			var builder = new VariantBuilder ((VariantType) "a(iiii)");
@@ -224,6 +315,10 @@ public class Tracker.Resources : Object {
 	}
 
 	bool on_emit_signals () {
+		if (subscriptions.size () > 0) {
+			send_subscribed_events ();
+		}
+
 		foreach (var cl in Tracker.Events.get_classes ()) {
 			emit_graph_updated (cl);
 		}
@@ -307,6 +402,16 @@ public class Tracker.Resources : Object {
 		Tracker.Writeback.reset_pending ();
 	}
 
+	void on_savepoint_ended (bool rolled_back) {
+		if (rolled_back) {
+			Tracker.Events.rollback_savepoint ();
+			Tracker.Writeback.rollback_savepoint ();
+		} else {
+			Tracker.Events.release_savepoint ();
+			Tracker.Writeback.release_savepoint ();
+		}
+	}
+
 	void check_graph_updated_signal () {
 		/* Check for whether we need an immediate emit */
 		if (Tracker.Events.get_total (false) > GRAPH_UPDATED_IMMEDIATE_EMIT_AT) {
@@ -341,6 +446,7 @@ public class Tracker.Resources : Object {
 		Tracker.Data.add_delete_statement_callback (on_statement_deleted);
 		Tracker.Data.add_commit_statement_callback (on_statements_committed);
 		Tracker.Data.add_rollback_statement_callback (on_statements_rolled_back);
+		Tracker.Data.add_savepoint_callback (on_savepoint_ended);
 	}
 
 	[DBus (visible = false)]
@@ -349,10 +455,18 @@ public class Tracker.Resources : Object {
 		Tracker.Data.remove_delete_statement_callback (on_statement_deleted);
 		Tracker.Data.remove_commit_statement_callback (on_statements_committed);
 		Tracker.Data.remove_rollback_statement_callback (on_statements_rolled_back);
+		Tracker.Data.remove_savepoint_callback (on_savepoint_ended);
 
 		if (signal_timeout != 0) {
 			Source.remove (signal_timeout);
 		}
+
+		foreach (var subscription in subscriptions.get_values ()) {
+			subscription.closed.disconnect (on_subscription_closed);
+			subscription.close ();
+		}
+
+		subscriptions.remove_all ();
 	}
 
 	~Resources () {
@@ -362,5 +476,11 @@ public class Tracker.Resources : Object {
 	[DBus (visible = false)]
 	public void unreg_batches (string old_owner) {
 		Tracker.Store.unreg_batches (old_owner);
+
+		foreach (var subscription in subscriptions.get_values ()) {
+			if (subscription.sender == old_owner) {
+				remove_subscription (subscription);
+			}
+		}
 	}
 }
@@ -27,7 +27,9 @@ public class Tracker.Statistics : Object {
 	public new Variant get (BusName sender) throws GLib.Error {
 		var request = DBusRequest.begin (sender, "Statistics.Get");
 
-		if (!initialized) {
+		/* Counts are kept up to date by updates, they only need
+		 * counting here if they were never kept in this database. */
+		if (!initialized && !Tracker.Data.class_counts_loaded ()) {
 			var iface = DBManager.get_db_interface ();
 
 			foreach (var cl in Ontologies.get_classes ()) {
@@ -68,4 +70,27 @@ public class Tracker.Statistics : Object {
 
 		return builder.end ();
 	}
+
+	[DBus (signature = "a(ii)")]
+	public Variant get_fts_segments (BusName sender) throws GLib.Error {
+		var request = DBusRequest.begin (sender, "Statistics.GetFtsSegments");
+		var builder = new VariantBuilder ((VariantType) "a(ii)");
+
+		try {
+			var iface = DBManager.get_db_interface ();
+			var stmt = iface.create_statement (DBStatementCacheType.NONE,
+			                                   "SELECT level, COUNT(1) FROM fts_segdir GROUP BY level ORDER BY level");
+
+			var cursor = stmt.start_cursor ();
+			while (cursor.next ()) {
+				builder.add ("(ii)", (int) cursor.get_integer (0), (int) cursor.get_integer (1));
+			}
+		} catch (DBInterfaceError e) {
+			/* built without FTS support */
+		}
+
+		request.end ();
+
+		return builder.end ();
+	}
 }
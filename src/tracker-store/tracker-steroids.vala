@@ -24,6 +24,59 @@ public class Tracker.Steroids : Object {
 
 	public const int BUFFER_SIZE = 65536;
 
+	/* Writes all rows of cursor to output, in the format read by
+	 * FDCursor in libtracker-bus, and closes it.
+	 */
+	static string[] write_cursor (DBCursor cursor, OutputStream output) throws Error {
+		var data_output_stream = new DataOutputStream (new BufferedOutputStream.sized (output, BUFFER_SIZE));
+		data_output_stream.set_byte_order (DataStreamByteOrder.HOST_ENDIAN);
+
+		int n_columns = cursor.n_columns;
+
+		int[] column_sizes = new int[n_columns];
+		int[] column_offsets = new int[n_columns];
+		string[] column_data = new string[n_columns];
+
+		var variable_names = new string[n_columns];
+		for (int i = 0; i < n_columns; i++) {
+			variable_names[i] = cursor.get_variable_name (i);
+		}
+
+		while (cursor.next ()) {
+			int last_offset = -1;
+
+			for (int i = 0; i < n_columns ; i++) {
+				unowned string str = cursor.get_string (i);
+
+				column_sizes[i] = str != null ? str.length : 0;
+				column_data[i]  = str;
+
+				last_offset += column_sizes[i] + 1;
+				column_offsets[i] = last_offset;
+			}
+
+			data_output_stream.put_int32 (n_columns);
+
+			for (int i = 0; i < n_columns ; i++) {
+				/* Cast from enum to int */
+				data_output_stream.put_int32 ((int) cursor.get_value_type (i));
+			}
+
+			for (int i = 0; i < n_columns ; i++) {
+				data_output_stream.put_int32 (column_offsets[i]);
+			}
+
+			for (int i = 0; i < n_columns ; i++) {
+				data_output_stream.put_string (column_data[i] != null ? column_data[i] : "");
+				data_output_stream.put_byte (0);
+			}
+		}
+
+		data_output_stream.close ();
+
+		return variable_names;
+	}
+
 	public async string[] query (BusName sender, string query, UnixOutputStream output_stream) throws Error {
 		var request = DBusRequest.begin (sender, "Steroids.Query");
 		request.debug ("query: %s", query);
@@ -31,54 +84,104 @@ public class Tracker.Steroids : Object {
 			string[] variable_names = null;
 
 			yield Tracker.Store.sparql_query (query, Tracker.Store.Priority.HIGH, cursor => {
-				var data_output_stream = new DataOutputStream (new BufferedOutputStream.sized (output_stream, BUFFER_SIZE));
-				data_output_stream.set_byte_order (DataStreamByteOrder.HOST_ENDIAN);
+				variable_names = write_cursor (cursor, output_stream);
+			}, sender);
 
-				int n_columns = cursor.n_columns;
+			request.end ();
 
-				int[] column_sizes = new int[n_columns];
-				int[] column_offsets = new int[n_columns];
-				string[] column_data = new string[n_columns];
+			return variable_names;
+		} catch (Error e) {
+			request.end (e);
+			if (e is Sparql.Error) {
+				throw e;
+			} else {
+				throw new Sparql.Error.INTERNAL (e.message);
+			}
+		}
+	}
 
-				variable_names = new string[n_columns];
-				for (int i = 0; i < n_columns; i++) {
-					variable_names[i] = cursor.get_variable_name (i);
-				}
+	/* Like Query, but the results are written to a spill file, whose
+	 * descriptor is returned once the query is done. The read
+	 * transaction ends as soon as the results are written, however
+	 * long the client takes going through them, so it doesn't keep
+	 * WAL checkpoints from completing.
+	 */
+	public async void query_snapshot (BusName sender, string query, out string[] variable_names, out UnixInputStream snapshot) throws Error {
+		var request = DBusRequest.begin (sender, "Steroids.QuerySnapshot");
+		request.debug ("query: %s", query);
+		try {
+			string[] names = null;
 
-				while (cursor.next ()) {
-					int last_offset = -1;
+			/* Next to the database rather than in a possibly
+			 * memory backed temporary directory */
+			string path = Path.build_filename (Environment.get_user_cache_dir (), "tracker", "snapshot-XXXXXX");
+			int fd = FileUtils.mkstemp (path);
 
-					for (int i = 0; i < n_columns ; i++) {
-						unowned string str = cursor.get_string (i);
+			if (fd < 0) {
+				throw new IOError.FAILED ("Could not create snapshot file: %s", strerror (errno));
+			}
 
-						column_sizes[i] = str != null ? str.length : 0;
-						column_data[i]  = str;
+			/* Gone as soon as all descriptors are closed */
+			FileUtils.unlink (path);
 
-						last_offset += column_sizes[i] + 1;
-						column_offsets[i] = last_offset;
-					}
+			var spill = new UnixInputStream (fd, true);
 
-					data_output_stream.put_int32 (n_columns);
+			yield Tracker.Store.sparql_query (query, Tracker.Store.Priority.HIGH, cursor => {
+				names = write_cursor (cursor, new UnixOutputStream (fd, false));
+			}, sender);
 
-					for (int i = 0; i < n_columns ; i++) {
-						/* Cast from enum to int */
-						data_output_stream.put_int32 ((int) cursor.get_value_type (i));
-					}
+			Posix.lseek (fd, 0, Posix.SEEK_SET);
+			variable_names = names;
+			snapshot = spill;
 
-					for (int i = 0; i < n_columns ; i++) {
-						data_output_stream.put_int32 (column_offsets[i]);
-					}
+			request.end ();
+		} catch (Error e) {
+			request.end (e);
+			if (e is Sparql.Error) {
+				throw e;
+			} else {
+				throw new Sparql.Error.INTERNAL (e.message);
+			}
+		}
+	}
+
+	/* Writes the change log entries after modseq for the given
+	 * classes (all of them if none is given) to output_stream, as
+	 * host endian int32 modseq, class, graph, subject, predicate
+	 * and operation. Returns the first modseq the log is complete
+	 * from, clients with an older modseq must query everything again.
+	 */
+	public async int changes_since (BusName sender, int modseq, string[] classes, UnixOutputStream output_stream) throws Error {
+		var request = DBusRequest.begin (sender, "Steroids.ChangesSince (modseq: %d)", modseq);
+		try {
+			int[] class_ids = {};
+
+			foreach (string class_uri in classes) {
+				var cl = Ontologies.get_class_by_uri (class_uri);
 
-					for (int i = 0; i < n_columns ; i++) {
-						data_output_stream.put_string (column_data[i] != null ? column_data[i] : "");
-						data_output_stream.put_byte (0);
+				if (cl == null) {
+					throw new Sparql.Error.UNKNOWN_CLASS ("Unknown class '%s'", class_uri);
+				}
+
+				class_ids += cl.id;
+			}
+
+			int log_start = yield Tracker.Store.changes_since (modseq, class_ids, Tracker.Store.Priority.HIGH, cursor => {
+				var data_output_stream = new DataOutputStream (new BufferedOutputStream.sized (output_stream, BUFFER_SIZE));
+				data_output_stream.set_byte_order (DataStreamByteOrder.HOST_ENDIAN);
+
+				while (cursor.next ()) {
+					for (int i = 0; i < 6; i++) {
+						data_output_stream.put_int32 ((int32) cursor.get_integer (i));
 					}
 				}
+
+				data_output_stream.close ();
 			}, sender);
 
 			request.end ();
 
-			return variable_names;
+			return log_start;
 		} catch (Error e) {
 			request.end (e);
 			if (e is Sparql.Error) {
@@ -155,6 +258,53 @@ public class Tracker.Steroids : Object {
 		return yield update_internal (sender, Tracker.Store.Priority.LOW, true, input_stream);
 	}
 
+	async void update_statements_internal (BusName sender, Tracker.Store.Priority priority, UnixInputStream input_stream) throws Error {
+		var request = DBusRequest.begin (sender,
+			"Steroids.%sUpdateStatements",
+			priority != Tracker.Store.Priority.HIGH ? "Batch" : "");
+		try {
+			size_t bytes_read;
+
+			var data_input_stream = new DataInputStream (input_stream);
+			data_input_stream.set_buffer_size (BUFFER_SIZE);
+			data_input_stream.set_byte_order (DataStreamByteOrder.HOST_ENDIAN);
+
+			int data_size = data_input_stream.read_int32 (null);
+
+			uint8[] data = new uint8[data_size];
+
+			data_input_stream.read_all (data, out bytes_read);
+
+			data_input_stream = null;
+
+			// serialized statements, untrusted as they come from the client
+			var statements = new Variant.from_bytes ((VariantType) "a(ymsssms)", new Bytes.take ((owned) data), false);
+
+			request.debug ("statements: %u", (uint) statements.n_children ());
+
+			yield Tracker.Store.sparql_update_statements (statements, priority, sender);
+
+			request.end ();
+		} catch (DBInterfaceError.NO_SPACE ie) {
+			throw new Sparql.Error.NO_SPACE (ie.message);
+		} catch (Error e) {
+			request.end (e);
+			if (e is Sparql.Error) {
+				throw e;
+			} else {
+				throw new Sparql.Error.INTERNAL (e.message);
+			}
+		}
+	}
+
+	public async void update_statements (BusName sender, UnixInputStream input_stream) throws Error {
+		yield update_statements_internal (sender, Tracker.Store.Priority.HIGH, input_stream);
+	}
+
+	public async void batch_update_statements (BusName sender, UnixInputStream input_stream) throws Error {
+		yield update_statements_internal (sender, Tracker.Store.Priority.LOW, input_stream);
+	}
+
 	[DBus (signature = "as")]
 	public async Variant update_array (BusName sender, UnixInputStream input_stream) throws Error {
 		var request = DBusRequest.begin (sender, "Steroids.UpdateArray");
@@ -165,7 +315,6 @@ public class Tracker.Steroids : Object {
 
 			int query_count = data_input_stream.read_int32 ();
 
-			var combined_query = new StringBuilder ();
 			string[] query_array = new string[query_count];
 
 			int i;
@@ -180,44 +329,35 @@ public class Tracker.Steroids : Object {
 				data_input_stream.read_all (((uint8[]) query_array[i])[0:query_size], out bytes_read);
 
 				request.debug ("query: %s", query_array[i]);
-				combined_query.append (query_array[i]);
 			}
 
 			data_input_stream = null;
 
 			var builder = new VariantBuilder ((VariantType) "as");
 
-			// first try combined query for best possible performance
+			// each query runs in its own savepoint, failing ones are
+			// rolled back without affecting the rest of the batch
 			try {
-				yield Tracker.Store.sparql_update (combined_query.str, Tracker.Store.Priority.LOW, sender);
+				var errors = yield Tracker.Store.sparql_update_array (query_array, Tracker.Store.Priority.LOW, sender);
 
-				// combined query was successful
 				for (i = 0; i < query_count; i++) {
-					builder.add ("s", "");
-					builder.add ("s", "");
+					unowned Error? e1 = (Error?) errors.index (i);
+
+					if (e1 == null) {
+						builder.add ("s", "");
+						builder.add ("s", "");
+					} else {
+						request.debug ("query %d failed: %s", i, e1.message);
+						builder.add ("s", "org.freedesktop.Tracker1.SparqlError.Internal");
+						builder.add ("s", e1.message);
+					}
 				}
-
-				request.end ();
-
-				return builder.end ();
-			} catch {
-				// combined query was not successful
-				combined_query = null;
-			}
-
-			// combined query was not successful, try queries one by one
-			for (i = 0; i < query_count; i++) {
-				request.debug ("query: %s", query_array[i]);
-
-				try {
-					yield Tracker.Store.sparql_update (query_array[i], Tracker.Store.Priority.LOW, sender);
-					builder.add ("s", "");
-					builder.add ("s", "");
-				} catch (Error e1) {
+			} catch (Error e1) {
+				// the transaction as a whole failed
+				for (i = 0; i < query_count; i++) {
 					builder.add ("s", "org.freedesktop.Tracker1.SparqlError.Internal");
 					builder.add ("s", e1.message);
 				}
-
 			}
 
 			request.end ();
@@ -24,6 +24,18 @@ public class Tracker.Store {
 
 	const int MAX_TASK_TIME = 30;
 
+	/* FTS segments are merged after this many seconds without
+	 * queries or updates, writing at most FTS_MERGE_PAGES pages
+	 * per step so new requests never wait long for the writer. */
+	const int FTS_MERGE_IDLE_TIME = 5;
+	const int FTS_MERGE_PAGES = 256;
+	const int FTS_MERGE_MIN_SEGMENTS = 4;
+
+	/* When enabled, instance counts of classes are checked against
+	 * their tables one class per step, after this many seconds
+	 * without queries or updates. */
+	const int COUNT_VERIFY_IDLE_TIME = 30;
+
 	static Queue<Task> query_queues[3 /* TRACKER_STORE_N_PRIORITIES */];
 	static Queue<Task> update_queues[3 /* TRACKER_STORE_N_PRIORITIES */];
 	static int n_queries_running;
@@ -33,6 +45,13 @@ public class Tracker.Store {
 	static ThreadPool<bool> checkpoint_pool;
 	static GenericArray<Task> running_tasks;
 	static int max_task_time;
+	static int fts_merge_pages;
+	static bool fts_merge_needed;
+	static uint fts_merge_id;
+	static Class[] count_verify_classes;
+	static int count_verify_index;
+	static uint count_verify_id;
+	static int64 idle_since;
 	static bool active;
 	static SourceFunc active_callback;
 
@@ -47,7 +66,12 @@ public class Tracker.Store {
 		QUERY,
 		UPDATE,
 		UPDATE_BLANK,
+		UPDATE_ARRAY,
+		UPDATE_STATEMENTS,
+		CHANGES,
 		TURTLE,
+		FTS_MERGE,
+		COUNT_VERIFY,
 	}
 
 	public delegate void SparqlQueryInThread (DBCursor cursor) throws Error;
@@ -72,16 +96,121 @@ public class Tracker.Store {
 		}
 	}
 
+	class ChangesTask : QueryTask {
+		public int since_modseq;
+		public int[] class_ids;
+		public int log_start;
+	}
+
 	class UpdateTask : Task {
 		public string query;
 		public Variant blank_nodes;
 		public Priority priority;
+		public string[] queries;
+		public PtrArray errors;
+		public Variant statements;
 	}
 
 	class TurtleTask : Task {
 		public string path;
 	}
 
+	class FtsMergeTask : Task {
+		public bool more;
+	}
+
+	class CountVerifyTask : Task {
+		public Class cl;
+	}
+
+	static bool is_idle () {
+		if (n_queries_running > 0 || update_running) {
+			return false;
+		}
+
+		for (int i = 0; i < Priority.N_PRIORITIES; i++) {
+			if (query_queues[i].get_length () > 0 || update_queues[i].get_length () > 0) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	static bool fts_merge_cb () {
+		fts_merge_id = 0;
+
+		if (!active || !is_idle ()) {
+			// retried the next time the store becomes idle
+			return false;
+		}
+
+		var task = new FtsMergeTask ();
+		task.type = TaskType.FTS_MERGE;
+
+		update_running = true;
+		try {
+			update_pool.push (task);
+		} catch (Error e) {
+			// ignore harmless thread creation error
+		}
+
+		return false;
+	}
+
+	static void fts_merge_schedule (uint timeout) {
+		if (fts_merge_id != 0) {
+			Source.remove (fts_merge_id);
+		}
+
+		if (timeout == 0) {
+			fts_merge_id = Idle.add (fts_merge_cb, GLib.Priority.LOW);
+		} else {
+			fts_merge_id = Timeout.add_seconds (timeout, fts_merge_cb);
+		}
+	}
+
+	static bool count_verify_cb () {
+		count_verify_id = 0;
+
+		if (!active || !is_idle ()) {
+			// retried the next time the store becomes idle
+			return false;
+		}
+
+		var task = new CountVerifyTask ();
+		task.type = TaskType.COUNT_VERIFY;
+		task.cl = count_verify_classes[count_verify_index++];
+
+		update_running = true;
+		try {
+			update_pool.push (task);
+		} catch (Error e) {
+			// ignore harmless thread creation error
+		}
+
+		return false;
+	}
+
+	static void count_verify_schedule (uint timeout) {
+		if (count_verify_id != 0) {
+			Source.remove (count_verify_id);
+		}
+
+		if (timeout == 0) {
+			count_verify_id = Idle.add (count_verify_cb, GLib.Priority.LOW);
+		} else {
+			count_verify_id = Timeout.add_seconds (timeout, count_verify_cb);
+		}
+	}
+
+	/* Seconds left until the store was idle for idle_time */
+	static uint idle_time_left (int idle_time) {
+		int64 elapsed = (get_monotonic_time () - idle_since) / TimeSpan.SECOND;
+
+		return (uint) (elapsed < idle_time ? idle_time - elapsed : 0);
+	}
+
 	static void sched () {
 		Task task = null;
 
@@ -140,6 +269,8 @@ public class Tracker.Store {
 		switch (task.type) {
 			case TaskType.UPDATE:
 			case TaskType.UPDATE_BLANK:
+			case TaskType.UPDATE_ARRAY:
+			case TaskType.UPDATE_STATEMENTS:
 				if (((UpdateTask) task).priority == Priority.HIGH) {
 					return Tracker.Data.CommitType.REGULAR;
 				} else if (update_queues[Priority.LOW].get_length () > 0) {
@@ -160,7 +291,7 @@ public class Tracker.Store {
 	}
 
 	static bool task_finish_cb (Task task) {
-		if (task.type == TaskType.QUERY) {
+		if (task.type == TaskType.QUERY || task.type == TaskType.CHANGES) {
 			var query_task = (QueryTask) task;
 
 			if (task.error == null) {
@@ -176,7 +307,8 @@ public class Tracker.Store {
 
 			running_tasks.remove (task);
 			n_queries_running--;
-		} else if (task.type == TaskType.UPDATE || task.type == TaskType.UPDATE_BLANK) {
+		} else if (task.type == TaskType.UPDATE || task.type == TaskType.UPDATE_BLANK ||
+		           task.type == TaskType.UPDATE_ARRAY || task.type == TaskType.UPDATE_STATEMENTS) {
 			if (task.error == null) {
 				Tracker.Data.notify_transaction (commit_type (task));
 			}
@@ -194,6 +326,24 @@ public class Tracker.Store {
 			task.error = null;
 
 			update_running = false;
+		} else if (task.type == TaskType.FTS_MERGE) {
+			fts_merge_needed = ((FtsMergeTask) task).more;
+			update_running = false;
+		} else if (task.type == TaskType.COUNT_VERIFY) {
+			if (task.error != null) {
+				warning ("Could not verify instance count of %s: %s",
+				         ((CountVerifyTask) task).cl.name, task.error.message);
+			}
+			update_running = false;
+		}
+
+		if (task.type != TaskType.QUERY && task.type != TaskType.CHANGES &&
+		    task.type != TaskType.FTS_MERGE && task.type != TaskType.COUNT_VERIFY) {
+			fts_merge_needed = (fts_merge_pages > 0);
+		}
+
+		if (task.type != TaskType.FTS_MERGE && task.type != TaskType.COUNT_VERIFY) {
+			idle_since = get_monotonic_time ();
 		}
 
 		if (n_queries_running == 0 && !update_running && active_callback != null) {
@@ -202,6 +352,32 @@ public class Tracker.Store {
 
 		sched ();
 
+		if (is_idle ()) {
+			/* keep merging and verifying while nothing else comes in */
+			bool merge = fts_merge_needed;
+			bool verify = count_verify_index < count_verify_classes.length;
+			uint merge_delay = idle_time_left (FTS_MERGE_IDLE_TIME);
+			uint verify_delay = idle_time_left (COUNT_VERIFY_IDLE_TIME);
+
+			if (merge && verify && merge_delay == 0 && verify_delay == 0) {
+				/* both are due, take turns so neither waits
+				 * for the other to be done */
+				if (task.type == TaskType.FTS_MERGE) {
+					merge = false;
+				} else {
+					verify = false;
+				}
+			}
+
+			if (merge) {
+				fts_merge_schedule (merge_delay);
+			}
+
+			if (verify) {
+				count_verify_schedule (verify_delay);
+			}
+		}
+
 		return false;
 	}
 
@@ -213,6 +389,16 @@ public class Tracker.Store {
 				var cursor = Tracker.Data.query_sparql_cursor (query_task.query);
 
 				query_task.in_thread (cursor);
+			} else if (task.type == TaskType.CHANGES) {
+				var changes_task = (ChangesTask) task;
+
+				var cursor = Tracker.Data.query_changes (changes_task.since_modseq, changes_task.class_ids);
+
+				changes_task.in_thread (cursor);
+
+				/* Only read once done with the cursor, so entries
+				 * trimmed meanwhile show as missing. */
+				changes_task.log_start = Tracker.Data.query_change_log_start ();
 			} else {
 				var iface = DBManager.get_db_interface ();
 				iface.sqlite_wal_hook (wal_hook);
@@ -225,6 +411,14 @@ public class Tracker.Store {
 					var update_task = (UpdateTask) task;
 
 					update_task.blank_nodes = Tracker.Data.update_sparql_blank (update_task.query);
+				} else if (task.type == TaskType.UPDATE_ARRAY) {
+					var update_task = (UpdateTask) task;
+
+					update_task.errors = Tracker.Data.update_array (update_task.queries);
+				} else if (task.type == TaskType.UPDATE_STATEMENTS) {
+					var update_task = (UpdateTask) task;
+
+					Tracker.Data.update_statements (update_task.statements);
 				} else if (task.type == TaskType.TURTLE) {
 					var turtle_task = (TurtleTask) task;
 
@@ -236,6 +430,15 @@ public class Tracker.Store {
 					} finally {
 						Tracker.Events.reset_pending ();
 					}
+				} else if (task.type == TaskType.FTS_MERGE) {
+					var merge_task = (FtsMergeTask) task;
+
+					merge_task.more = iface.sqlite_fts_merge (fts_merge_pages, FTS_MERGE_MIN_SEGMENTS);
+					debug ("FTS merge step done, %s", merge_task.more ? "more segments to merge" : "index is merged");
+				} else if (task.type == TaskType.COUNT_VERIFY) {
+					var verify_task = (CountVerifyTask) task;
+
+					Tracker.Data.class_counts_verify (verify_task.cl);
 				}
 			}
 		} catch (Error e) {
@@ -298,6 +501,16 @@ public class Tracker.Store {
 			max_task_time = MAX_TASK_TIME;
 		}
 
+		string fts_merge_pages_env = Environment.get_variable ("TRACKER_STORE_FTS_MERGE_PAGES");
+		if (fts_merge_pages_env != null) {
+			fts_merge_pages = int.parse (fts_merge_pages_env);
+		} else {
+			fts_merge_pages = FTS_MERGE_PAGES;
+		}
+
+		// segments may be left over from a previous run
+		fts_merge_needed = (fts_merge_pages > 0);
+
 		running_tasks = new GenericArray<Task> ();
 
 		for (int i = 0; i < Priority.N_PRIORITIES; i++) {
@@ -320,7 +533,29 @@ public class Tracker.Store {
 		ThreadPool.set_max_unused_threads (2);
 	}
 
+	/* Checks the kept instance counts of all classes against their
+	 * tables, in the background. */
+	public static void verify_class_counts () {
+		count_verify_classes = Ontologies.get_classes ();
+		count_verify_index = 0;
+		idle_since = get_monotonic_time ();
+
+		count_verify_schedule (COUNT_VERIFY_IDLE_TIME);
+	}
+
 	public static void shutdown () {
+		if (fts_merge_id != 0) {
+			Source.remove (fts_merge_id);
+			fts_merge_id = 0;
+		}
+
+		if (count_verify_id != 0) {
+			Source.remove (count_verify_id);
+			count_verify_id = 0;
+		}
+
+		count_verify_classes = null;
+
 		query_pool = null;
 		update_pool = null;
 		checkpoint_pool = null;
@@ -351,6 +586,30 @@ public class Tracker.Store {
 		}
 	}
 
+	/* Returns the first modseq the change log is complete from */
+	public static async int changes_since (int since_modseq, int[] class_ids, Priority priority, SparqlQueryInThread in_thread, string client_id) throws Error {
+		var task = new ChangesTask ();
+		task.type = TaskType.CHANGES;
+		task.since_modseq = since_modseq;
+		task.class_ids = class_ids;
+		task.cancellable = new Cancellable ();
+		task.in_thread = in_thread;
+		task.callback = changes_since.callback;
+		task.client_id = client_id;
+
+		query_queues[priority].push_tail (task);
+
+		sched ();
+
+		yield;
+
+		if (task.error != null) {
+			throw task.error;
+		}
+
+		return task.log_start;
+	}
+
 	public static async void sparql_update (string sparql, Priority priority, string client_id) throws Error {
 		var task = new UpdateTask ();
 		task.type = TaskType.UPDATE;
@@ -391,6 +650,48 @@ public class Tracker.Store {
 		return task.blank_nodes;
 	}
 
+	/* Runs all queries in one transaction, returning the error of
+	 * each failed query, or null where it succeeded. */
+	public static async PtrArray sparql_update_array (string[] queries, Priority priority, string client_id) throws Error {
+		var task = new UpdateTask ();
+		task.type = TaskType.UPDATE_ARRAY;
+		task.queries = queries;
+		task.priority = priority;
+		task.callback = sparql_update_array.callback;
+		task.client_id = client_id;
+
+		update_queues[priority].push_tail (task);
+
+		sched ();
+
+		yield;
+
+		if (task.error != null) {
+			throw task.error;
+		}
+
+		return (owned) task.errors;
+	}
+
+	public static async void sparql_update_statements (Variant statements, Priority priority, string client_id) throws Error {
+		var task = new UpdateTask ();
+		task.type = TaskType.UPDATE_STATEMENTS;
+		task.statements = statements;
+		task.priority = priority;
+		task.callback = sparql_update_statements.callback;
+		task.client_id = client_id;
+
+		update_queues[priority].push_tail (task);
+
+		sched ();
+
+		yield;
+
+		if (task.error != null) {
+			throw task.error;
+		}
+	}
+
 	public static async void queue_turtle_import (File file, string client_id) throws Error {
 		var task = new TurtleTask ();
 		task.type = TaskType.TURTLE;
@@ -493,5 +794,9 @@ public class Tracker.Store {
 		Tracker.Store.active = true;
 
 		sched ();
+
+		if (fts_merge_needed && is_idle ()) {
+			fts_merge_schedule (FTS_MERGE_IDLE_TIME);
+		}
 	}
 }
@@ -29,6 +29,8 @@
 typedef struct {
 	GHashTable *allowances;
 	GHashTable *pending_events;
+	/* pending events of released savepoints */
+	GHashTable *staged_events;
 	GHashTable *ready_events;
 } WritebackPrivate;
 
@@ -56,6 +58,41 @@ array_free (GArray *array)
 	g_array_free (array, TRUE);
 }
 
+/* Moves the class ids of @subject to @events, adding them to the ones
+ * earlier savepoints or transactions already left there.
+ */
+static void
+merge_events (GHashTable *events,
+              gpointer    subject,
+              GArray     *ids)
+{
+	GArray *existing;
+	guint i, j;
+
+	existing = g_hash_table_lookup (events, subject);
+
+	if (!existing) {
+		g_hash_table_insert (events, subject, ids);
+		return;
+	}
+
+	for (i = 0; i < ids->len; i++) {
+		gint id = g_array_index (ids, gint, i);
+
+		for (j = 0; j < existing->len; j++) {
+			if (g_array_index (existing, gint, j) == id) {
+				break;
+			}
+		}
+
+		if (j == existing->len) {
+			g_array_append_val (existing, id);
+		}
+	}
+
+	array_free (ids);
+}
+
 void
 tracker_writeback_check (gint         graph_id,
                          const gchar *graph,
@@ -99,6 +136,45 @@ tracker_writeback_reset_pending ()
 	if (private->pending_events) {
 		g_hash_table_remove_all (private->pending_events);
 	}
+
+	if (private->staged_events) {
+		g_hash_table_remove_all (private->staged_events);
+	}
+}
+
+void
+tracker_writeback_release_savepoint (void)
+{
+	GHashTableIter iter;
+	gpointer key, value;
+
+	g_return_if_fail (private != NULL);
+
+	if (!private->pending_events)
+		return;
+
+	if (!private->staged_events) {
+		private->staged_events = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+		                                                (GDestroyNotify) NULL,
+		                                                (GDestroyNotify) array_free);
+	}
+
+	g_hash_table_iter_init (&iter, private->pending_events);
+
+	while (g_hash_table_iter_next (&iter, &key, &value)) {
+		g_hash_table_iter_steal (&iter);
+		merge_events (private->staged_events, key, value);
+	}
+}
+
+void
+tracker_writeback_rollback_savepoint (void)
+{
+	g_return_if_fail (private != NULL);
+
+	if (private->pending_events) {
+		g_hash_table_remove_all (private->pending_events);
+	}
 }
 
 void
@@ -130,6 +206,8 @@ free_private (gpointer user_data)
 		g_hash_table_unref (private->ready_events);
 	if (private->pending_events)
 		g_hash_table_unref (private->pending_events);
+	if (private->staged_events)
+		g_hash_table_unref (private->staged_events);
 	g_hash_table_unref (private->allowances);
 	g_free (private);
 }
@@ -185,7 +263,10 @@ tracker_writeback_transact (void)
 	GHashTableIter iter;
 	gpointer key, value;
 
-	if (!private->pending_events)
+	/* Whatever is still pending was committed along */
+	tracker_writeback_release_savepoint ();
+
+	if (!private->staged_events)
 		return;
 
 	if (!private->ready_events) {
@@ -194,11 +275,11 @@ tracker_writeback_transact (void)
 		                                               (GDestroyNotify) array_free);
 	}
 
-	g_hash_table_iter_init (&iter, private->pending_events);
+	g_hash_table_iter_init (&iter, private->staged_events);
 
 	while (g_hash_table_iter_next (&iter, &key, &value)) {
-		g_hash_table_insert (private->ready_events, key, value);
-		g_hash_table_iter_remove (&iter);
+		g_hash_table_iter_steal (&iter);
+		merge_events (private->ready_events, key, value);
 	}
 }
 
@@ -130,6 +130,41 @@ class TestFTSFunctions (CommonTrackerStoreTest):
         """
         self.tracker.update (delete_sparql)
 
+    def test_fts_snippet_offsets (self):
+        """
+        1. Insert a Contact1 with 'one two abcdefxyz three' as fullname
+        2. Query fts:snippet and fts:offsets for 'abcdefxyz' in the same row
+           EXPECTED: Both functions agree on the matched token
+        3. Remove the created resources
+        """
+        insert_sparql = """
+        INSERT {
+        <contact://test/fts-function/snippet/1> a nco:PersonContact ;
+                       nco:fullname 'one two abcdefxyz three' .
+        }
+        """
+        self.tracker.update (insert_sparql)
+
+        query = """
+        SELECT fts:snippet (?contact, '[', ']') fts:offsets (?contact) WHERE {
+           ?contact a nco:PersonContact ;
+                fts:match 'abcdefxyz' .
+        }
+        """
+        results = self.tracker.query (query)
+
+        self.assertEquals (len(results), 1)
+        self.assertEquals (results[0][0], 'one two [abcdefxyz] three')
+        self.assertEquals (results[0][1], 'nco:fullname,8')
+
+        delete_sparql = """
+        DELETE {
+        <contact://test/fts-function/snippet/1> a rdfs:Resource .
+        }
+        """
+        self.tracker.update (delete_sparql)
+
+
 
 if __name__ == '__main__':
     ut.main()
@@ -32,6 +32,9 @@ import glib
 import dbus
 from dbus.mainloop.glib import DBusGMainLoop
 import time
+import os
+import select
+import struct
 
 GRAPH_UPDATED_SIGNAL = "GraphUpdated"
 
@@ -39,6 +42,7 @@ SIGNALS_PATH = "/org/freedesktop/Tracker1/Resources"
 SIGNALS_IFACE = "org.freedesktop.Tracker1.Resources"
 
 CONTACT_CLASS_URI = "http://www.semanticdesktop.org/ontologies/2007/03/22/nco#PersonContact"
+FULLNAME_PROPERTY_URI = "http://www.semanticdesktop.org/ontologies/2007/03/22/nco#fullname"
 
 REASONABLE_TIMEOUT = 10 # Time waiting for the signal to be emitted
 
@@ -183,7 +187,55 @@ class TrackerStoreSignalsTests (CommonTrackerStoreTest):
 
         self.assertEquals (len (self.results_deletes), 1)
         self.assertEquals (len (self.results_inserts), 1)
-        
+
+    def __read_int32s (self, fd, n):
+        data = ""
+        while len (data) < n * 4:
+            chunk = os.read (fd, n * 4 - len (data))
+            self.assertTrue (chunk, "Graph updates stream closed")
+            data += chunk
+        return struct.unpack ("=%di" % n, data)
+
+    def test_05_subscribe_graph_updates (self):
+        self.clean_up_list.append ("test://signals-contact-subscribe")
+
+        resources = dbus.Interface (self.bus.get_object ("org.freedesktop.Tracker1", SIGNALS_PATH),
+                                    dbus_interface = SIGNALS_IFACE)
+        read_fd, write_fd = os.pipe ()
+        subscription = resources.SubscribeGraphUpdates ([CONTACT_CLASS_URI],
+                                                        [FULLNAME_PROPERTY_URI],
+                                                        dbus.types.UnixFd (write_fd))
+        os.close (write_fd)
+
+        self.tracker.update ("""
+               INSERT { <test://signals-contact-subscribe> a nco:PersonContact;
+                            nco:fullname 'subscribed';
+                            nco:nameGiven 'not subscribed' }
+               """)
+
+        ready, _, _ = select.select ([read_fd], [], [], REASONABLE_TIMEOUT)
+        self.assertTrue (ready, "Timeout, no graph updates were written")
+
+        size, seqnum, n_classes = self.__read_int32s (read_fd, 3)
+        class_id, n_deletes, n_inserts = self.__read_int32s (read_fd, 3)
+        graph, subject, predicate, obj = self.__read_int32s (read_fd, 4)
+
+        # Only the nco:fullname insert is sent
+        self.assertEquals (size, 9 * 4)
+        self.assertEquals (seqnum, 0)
+        self.assertEquals (n_classes, 1)
+        self.assertEquals (n_deletes, 0)
+        self.assertEquals (n_inserts, 1)
+
+        ids = self.tracker.query ("""
+               SELECT tracker:id (nco:PersonContact) tracker:id (nco:fullname)
+                      tracker:id (<test://signals-contact-subscribe>) WHERE {}
+               """)
+        self.assertEquals ([class_id, predicate, subject], [int (i) for i in ids[0]])
+
+        resources.UnsubscribeGraphUpdates (subscription)
+        os.close (read_fd)
+
 
 if __name__ == "__main__":
     ut.main()
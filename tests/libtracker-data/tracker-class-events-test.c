@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+
+#include <libtracker-data/tracker-class.h>
+
+typedef struct {
+	gint graph_id;
+	gint subject_id;
+	gint pred_id;
+	gint object_id;
+} Event;
+
+static void
+collect_event (gint     graph_id,
+               gint     subject_id,
+               gint     pred_id,
+               gint     object_id,
+               gpointer user_data)
+{
+	GArray *events = user_data;
+	Event event = { graph_id, subject_id, pred_id, object_id };
+
+	g_array_append_val (events, event);
+}
+
+static GArray *
+get_insert_events (TrackerClass *class)
+{
+	GArray *events;
+
+	events = g_array_new (FALSE, FALSE, sizeof (Event));
+	tracker_class_foreach_insert_event (class, collect_event, events);
+
+	return events;
+}
+
+static void
+assert_event (GArray *events,
+              guint   i,
+              gint    graph_id,
+              gint    subject_id,
+              gint    pred_id,
+              gint    object_id)
+{
+	Event *event;
+
+	g_assert_cmpuint (i, <, events->len);
+	event = &g_array_index (events, Event, i);
+
+	g_assert_cmpint (event->graph_id, ==, graph_id);
+	g_assert_cmpint (event->subject_id, ==, subject_id);
+	g_assert_cmpint (event->pred_id, ==, pred_id);
+	g_assert_cmpint (event->object_id, ==, object_id);
+}
+
+static void
+test_class_events_dedup (void)
+{
+	TrackerClass *class;
+	GArray *events;
+
+	class = tracker_class_new (FALSE);
+
+	/* Only events equal in all fields are merged */
+	tracker_class_add_insert_event (class, 1, 10, 100, 1000);
+	tracker_class_add_insert_event (class, 1, 10, 100, 1001);
+	tracker_class_add_insert_event (class, 2, 10, 100, 1000);
+	tracker_class_add_insert_event (class, 1, 10, 100, 1000);
+	tracker_class_add_insert_event (class, 1, 9, 100, 1000);
+	tracker_class_transact_events (class);
+
+	g_assert (tracker_class_has_insert_events (class));
+	g_assert (!tracker_class_has_delete_events (class));
+
+	/* Sorted on subject and predicate */
+	events = get_insert_events (class);
+	g_assert_cmpuint (events->len, ==, 4);
+	assert_event (events, 0, 1, 9, 100, 1000);
+	assert_event (events, 1, 1, 10, 100, 1000);
+	assert_event (events, 2, 2, 10, 100, 1000);
+	assert_event (events, 3, 1, 10, 100, 1001);
+	g_array_unref (events);
+
+	/* Repeated across transactions, each keeps its own */
+	tracker_class_add_insert_event (class, 1, 10, 100, 1000);
+	tracker_class_transact_events (class);
+
+	events = get_insert_events (class);
+	g_assert_cmpuint (events->len, ==, 5);
+	assert_event (events, 4, 1, 10, 100, 1000);
+	g_array_unref (events);
+
+	tracker_class_reset_ready_events (class);
+	g_assert (!tracker_class_has_insert_events (class));
+
+	g_object_unref (class);
+}
+
+static void
+test_class_events_savepoint_rollback (void)
+{
+	TrackerClass *class;
+	GArray *events;
+
+	class = tracker_class_new (FALSE);
+
+	/* Events up to the released savepoint survive rolling
+	 * back to a later one.
+	 */
+	tracker_class_add_insert_event (class, 1, 10, 100, 1000);
+	tracker_class_add_delete_event (class, 1, 10, 101, 1000);
+	tracker_class_stage_events (class);
+
+	tracker_class_add_insert_event (class, 1, 11, 100, 1000);
+	tracker_class_add_insert_event (class, 1, 12, 100, 1000);
+	tracker_class_add_delete_event (class, 1, 11, 101, 1000);
+	g_assert_cmpuint (tracker_class_reset_unstaged_events (class), ==, 3);
+
+	/* Nothing new to drop */
+	g_assert_cmpuint (tracker_class_reset_unstaged_events (class), ==, 0);
+
+	tracker_class_add_insert_event (class, 1, 13, 100, 1000);
+	tracker_class_transact_events (class);
+
+	events = get_insert_events (class);
+	g_assert_cmpuint (events->len, ==, 2);
+	assert_event (events, 0, 1, 10, 100, 1000);
+	assert_event (events, 1, 1, 13, 100, 1000);
+	g_array_unref (events);
+
+	g_assert (tracker_class_has_delete_events (class));
+
+	/* Committing forgets the staged position */
+	tracker_class_add_insert_event (class, 1, 14, 100, 1000);
+	g_assert_cmpuint (tracker_class_reset_unstaged_events (class), ==, 1);
+
+	tracker_class_reset_ready_events (class);
+	g_object_unref (class);
+}
+
+static void
+test_class_events_recycle (void)
+{
+	TrackerClass *class, *other;
+	GArray *events;
+	gint i;
+
+	class = tracker_class_new (FALSE);
+	other = tracker_class_new (FALSE);
+
+	/* Fill a few batches, and hand them back once emitted */
+	for (i = 0; i < 3; i++) {
+		tracker_class_add_insert_event (class, 1, i, 100, 1000);
+		tracker_class_add_insert_event (class, 1, i, 101, 1000);
+		tracker_class_transact_events (class);
+	}
+
+	events = get_insert_events (class);
+	g_assert_cmpuint (events->len, ==, 6);
+	g_array_unref (events);
+
+	tracker_class_reset_ready_events (class);
+
+	/* Recycled batches start off empty, for this class... */
+	tracker_class_add_insert_event (class, 1, 20, 100, 1000);
+	tracker_class_transact_events (class);
+
+	events = get_insert_events (class);
+	g_assert_cmpuint (events->len, ==, 1);
+	assert_event (events, 0, 1, 20, 100, 1000);
+	g_array_unref (events);
+
+	/* ...and for others sharing them */
+	tracker_class_add_insert_event (other, 2, 30, 100, 1000);
+	tracker_class_transact_events (other);
+
+	events = get_insert_events (other);
+	g_assert_cmpuint (events->len, ==, 1);
+	assert_event (events, 0, 2, 30, 100, 1000);
+	g_array_unref (events);
+
+	/* A rolled back transaction leaves nothing behind */
+	tracker_class_add_insert_event (class, 1, 40, 100, 1000);
+	tracker_class_reset_pending_events (class);
+	tracker_class_transact_events (class);
+
+	events = get_insert_events (class);
+	g_assert_cmpuint (events->len, ==, 1);
+	assert_event (events, 0, 1, 20, 100, 1000);
+	g_array_unref (events);
+
+	/* Same after a rollback dropping ready events too */
+	tracker_class_add_insert_event (class, 1, 50, 100, 1000);
+	tracker_class_reset_pending_events (class);
+	tracker_class_reset_ready_events (class);
+	g_assert (!tracker_class_has_insert_events (class));
+
+	tracker_class_add_insert_event (class, 1, 60, 100, 1000);
+	tracker_class_transact_events (class);
+
+	events = get_insert_events (class);
+	g_assert_cmpuint (events->len, ==, 1);
+	assert_event (events, 0, 1, 60, 100, 1000);
+	g_array_unref (events);
+
+	tracker_class_reset_ready_events (class);
+	tracker_class_reset_ready_events (other);
+	g_object_unref (class);
+	g_object_unref (other);
+}
+
+int
+main (int argc, char **argv)
+{
+	g_test_init (&argc, &argv, NULL);
+
+	g_test_add_func ("/libtracker-data/class-events/dedup", test_class_events_dedup);
+	g_test_add_func ("/libtracker-data/class-events/savepoint-rollback", test_class_events_savepoint_rollback);
+	g_test_add_func ("/libtracker-data/class-events/recycle", test_class_events_recycle);
+
+	return g_test_run ();
+}
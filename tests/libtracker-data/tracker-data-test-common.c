@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config.h"
+
+#include "tracker-data-test-common.h"
+
+/* Initializes the data manager on the database in the current
+ * XDG directories, pass TRACKER_DB_MANAGER_FORCE_REINDEX to
+ * start off an empty one.
+ */
+void
+tracker_data_test_setup (TrackerDBManagerFlags flags)
+{
+	GError *error = NULL;
+
+	tracker_db_journal_set_rotating (FALSE, G_MAXSIZE, NULL);
+
+	tracker_data_manager_init (flags,
+	                           NULL,
+	                           NULL,
+	                           FALSE,
+	                           FALSE,
+	                           100,
+	                           100,
+	                           NULL,
+	                           NULL,
+	                           NULL,
+	                           &error);
+
+	g_assert_no_error (error);
+}
+
+void
+tracker_data_test_teardown (void)
+{
+	tracker_data_manager_shutdown ();
+}
+
+/* Sets up the test framework, with the databases created in the
+ * current directory.
+ */
+void
+tracker_data_test_init (gint    *argc,
+                        gchar ***argv)
+{
+	gchar *current_dir;
+
+	g_test_init (argc, argv, NULL);
+
+	current_dir = g_get_current_dir ();
+
+	g_setenv ("XDG_DATA_HOME", current_dir, TRUE);
+	g_setenv ("XDG_CACHE_HOME", current_dir, TRUE);
+	g_setenv ("TRACKER_DB_ONTOLOGIES_DIR", TOP_SRCDIR "/data/ontologies/", TRUE);
+
+	g_free (current_dir);
+}
+
+static void
+test_fixture_setup (gpointer      fixture,
+                    gconstpointer test_func)
+{
+	tracker_data_test_setup (TRACKER_DB_MANAGER_FORCE_REINDEX);
+}
+
+static void
+test_fixture_run (gpointer      fixture,
+                  gconstpointer test_func)
+{
+	((GTestFunc) test_func) ();
+}
+
+static void
+test_fixture_teardown (gpointer      fixture,
+                       gconstpointer test_func)
+{
+	tracker_data_test_teardown ();
+}
+
+/* Adds a test running on an empty store, the test must leave
+ * the data manager initialized.
+ */
+void
+tracker_data_test_add (const gchar *path,
+                       GTestFunc    test_func)
+{
+	g_test_add_vtable (path, 0, test_func,
+	                   test_fixture_setup,
+	                   test_fixture_run,
+	                   test_fixture_teardown);
+}
+
+gint
+tracker_data_test_run (void)
+{
+	gint result;
+
+	result = g_test_run ();
+
+	/* clean up */
+	g_print ("Removing temporary data\n");
+	g_spawn_command_line_sync ("rm -R tracker/", NULL, NULL, NULL, NULL);
+
+	return result;
+}
@@ -0,0 +1,679 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+
+#include <libtracker-data/tracker-data.h>
+#include <libtracker-data/tracker-sparql-query.h>
+
+#include <tracker-store/tracker-writeback.h>
+
+#include "tracker-data-test-common.h"
+
+static gint
+count_resources (const gchar *uri)
+{
+	TrackerDBCursor *cursor;
+	GError *error = NULL;
+	gchar *query;
+	gint count = 0;
+
+	query = g_strdup_printf ("SELECT ?r WHERE { <%s> a ?r }", uri);
+	cursor = tracker_data_query_sparql_cursor (query, &error);
+	g_assert_no_error (error);
+
+	while (tracker_db_cursor_iter_next (cursor, NULL, &error)) {
+		count++;
+	}
+
+	g_assert_no_error (error);
+	g_object_unref (cursor);
+	g_free (query);
+
+	return count;
+}
+
+static void
+test_update_array (void)
+{
+	const gchar *updates[] = {
+		"INSERT { <urn:array:1> a rdfs:Resource }",
+		"INSERT { <urn:array:2> a rdfs:Resource } "
+		"INSERT { <urn:array:2> nie:nonExistingProperty 42 }",
+		"INSERT { <urn:array:3> a rdfs:Resource }",
+		"INSERT { <urn:array:4> a rdfs:Resource ; not valid sparql",
+	};
+	GPtrArray *errors;
+	GError *error = NULL;
+
+	errors = tracker_data_update_array (updates, G_N_ELEMENTS (updates), &error);
+	g_assert_no_error (error);
+	g_assert (errors != NULL);
+	g_assert_cmpuint (errors->len, ==, G_N_ELEMENTS (updates));
+
+	/* Only the failing updates are rolled back */
+	g_assert (g_ptr_array_index (errors, 0) == NULL);
+	g_assert (g_ptr_array_index (errors, 1) != NULL);
+	g_assert (g_ptr_array_index (errors, 2) == NULL);
+	g_assert (g_ptr_array_index (errors, 3) != NULL);
+
+	g_assert_cmpint (count_resources ("urn:array:1"), ==, 1);
+	g_assert_cmpint (count_resources ("urn:array:2"), ==, 0);
+	g_assert_cmpint (count_resources ("urn:array:3"), ==, 1);
+	g_assert_cmpint (count_resources ("urn:array:4"), ==, 0);
+
+	g_ptr_array_unref (errors);
+
+}
+
+static void
+test_update_statements (void)
+{
+	GVariantBuilder builder;
+	GError *error = NULL;
+
+	g_variant_builder_init (&builder, TRACKER_DATA_STATEMENTS_TYPE);
+	g_variant_builder_add (&builder, "(ymsssms)", TRACKER_DATA_STATEMENT_INSERT, NULL,
+	                       "urn:statements:1", TRACKER_RDF_PREFIX "type", TRACKER_RDFS_PREFIX "Resource");
+	g_variant_builder_add (&builder, "(ymsssms)", TRACKER_DATA_STATEMENT_INSERT, NULL,
+	                       "urn:statements:2", TRACKER_RDF_PREFIX "type", TRACKER_RDFS_PREFIX "Resource");
+	g_variant_builder_add (&builder, "(ymsssms)", TRACKER_DATA_STATEMENT_DELETE, NULL,
+	                       "urn:statements:2", TRACKER_RDF_PREFIX "type", TRACKER_RDFS_PREFIX "Resource");
+	tracker_data_update_statements (g_variant_builder_end (&builder), &error);
+	g_assert_no_error (error);
+
+	g_assert_cmpint (count_resources ("urn:statements:1"), ==, 1);
+	g_assert_cmpint (count_resources ("urn:statements:2"), ==, 0);
+
+	/* A failing statement rolls back the whole batch */
+	g_variant_builder_init (&builder, TRACKER_DATA_STATEMENTS_TYPE);
+	g_variant_builder_add (&builder, "(ymsssms)", TRACKER_DATA_STATEMENT_INSERT, NULL,
+	                       "urn:statements:3", TRACKER_RDF_PREFIX "type", TRACKER_RDFS_PREFIX "Resource");
+	g_variant_builder_add (&builder, "(ymsssms)", TRACKER_DATA_STATEMENT_INSERT, NULL,
+	                       "urn:statements:3", "urn:no-such-property", "42");
+	tracker_data_update_statements (g_variant_builder_end (&builder), &error);
+	g_assert_error (error, TRACKER_SPARQL_ERROR, TRACKER_SPARQL_ERROR_UNKNOWN_PROPERTY);
+	g_clear_error (&error);
+
+	g_assert_cmpint (count_resources ("urn:statements:3"), ==, 0);
+
+}
+
+static GStrv
+writeback_predicates (void)
+{
+	gchar **predicates;
+
+	predicates = g_new0 (gchar *, 2);
+	predicates[0] = g_strdup (TRACKER_NAO_PREFIX "hasTag");
+
+	return predicates;
+}
+
+/* Same wiring as tracker-store's */
+static void
+writeback_statement_inserted (gint         graph_id,
+                              const gchar *graph,
+                              gint         subject_id,
+                              const gchar *subject,
+                              gint         predicate_id,
+                              gint         object_id,
+                              const gchar *object,
+                              GPtrArray   *rdf_types,
+                              gpointer     user_data)
+{
+	tracker_writeback_check (graph_id, graph, subject_id, subject,
+	                         predicate_id, object_id, object, rdf_types);
+}
+
+static void
+writeback_savepoint_ended (gboolean rolled_back,
+                           gpointer user_data)
+{
+	if (rolled_back) {
+		tracker_writeback_rollback_savepoint ();
+	} else {
+		tracker_writeback_release_savepoint ();
+	}
+}
+
+static void
+writeback_committed (TrackerDataCommitType commit_type,
+                     gpointer              user_data)
+{
+	tracker_writeback_transact ();
+}
+
+static gboolean
+array_contains (GArray *array,
+                gint    value)
+{
+	guint i;
+
+	for (i = 0; i < array->len; i++) {
+		if (g_array_index (array, gint, i) == value) {
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+static void
+test_update_array_writeback (void)
+{
+	/* Both elements touch the same subject, with different types */
+	const gchar *updates[] = {
+		"INSERT { <urn:writeback:tag:1> a nao:Tag . "
+		"<urn:writeback:1> a nfo:Media ; nao:hasTag <urn:writeback:tag:1> }",
+		"DELETE { <urn:writeback:1> a nfo:Media } "
+		"INSERT { <urn:writeback:tag:2> a nao:Tag . "
+		"<urn:writeback:1> nao:hasTag <urn:writeback:tag:2> }",
+	};
+	GHashTable *ready;
+	GHashTableIter iter;
+	GPtrArray *errors;
+	GError *error = NULL;
+	gpointer types;
+
+	tracker_writeback_init (writeback_predicates);
+	tracker_data_add_insert_statement_callback (writeback_statement_inserted, NULL);
+	tracker_data_add_savepoint_callback (writeback_savepoint_ended, NULL);
+	tracker_data_add_commit_statement_callback (writeback_committed, NULL);
+
+	errors = tracker_data_update_array (updates, G_N_ELEMENTS (updates), &error);
+	g_assert_no_error (error);
+	g_assert (g_ptr_array_index (errors, 0) == NULL);
+	g_assert (g_ptr_array_index (errors, 1) == NULL);
+	g_ptr_array_unref (errors);
+
+	ready = tracker_writeback_get_ready ();
+	g_assert (ready != NULL);
+	g_assert_cmpuint (g_hash_table_size (ready), ==, 1);
+
+	g_hash_table_iter_init (&iter, ready);
+	g_assert (g_hash_table_iter_next (&iter, NULL, &types));
+
+	/* The types of the first element are kept */
+	g_assert (array_contains (types, tracker_class_get_id (tracker_ontologies_get_class_by_uri (TRACKER_NFO_PREFIX "Media"))));
+	g_assert (array_contains (types, tracker_class_get_id (tracker_ontologies_get_class_by_uri (TRACKER_NIE_PREFIX "InformationElement"))));
+
+	tracker_data_remove_insert_statement_callback (writeback_statement_inserted, NULL);
+	tracker_data_remove_savepoint_callback (writeback_savepoint_ended, NULL);
+	tracker_data_remove_commit_statement_callback (writeback_committed, NULL);
+	tracker_writeback_shutdown ();
+
+}
+
+static void
+test_change_log_query (void)
+{
+	TrackerDBCursor *cursor;
+	GError *error = NULL;
+	gint contact_id, fullname_id, subject_id;
+	gint start, last_modseq = 0, n_changes = 0;
+	gboolean fullname_seen = FALSE;
+
+	start = tracker_data_query_change_log_start (&error);
+	g_assert_no_error (error);
+	g_assert_cmpint (start, >, 0);
+
+	contact_id = tracker_class_get_id (tracker_ontologies_get_class_by_uri (TRACKER_NCO_PREFIX "PersonContact"));
+	fullname_id = tracker_property_get_id (tracker_ontologies_get_property_by_uri (TRACKER_NCO_PREFIX "fullname"));
+
+	tracker_data_update_sparql ("INSERT { <urn:changes:1> a nco:PersonContact ; nco:fullname 'first' } "
+	                            "INSERT { <urn:changes:2> a rdfs:Resource }",
+	                            &error);
+	g_assert_no_error (error);
+
+	subject_id = tracker_data_query_resource_id ("urn:changes:1");
+
+	/* Only resources of tracker:notify classes are logged */
+	cursor = tracker_data_query_changes (start - 1, &contact_id, 1, &error);
+	g_assert_no_error (error);
+
+	while (tracker_db_cursor_iter_next (cursor, NULL, &error)) {
+		last_modseq = tracker_db_cursor_get_int (cursor, 0);
+		g_assert_cmpint (tracker_db_cursor_get_int (cursor, 1), ==, contact_id);
+		g_assert_cmpint (tracker_db_cursor_get_int (cursor, 3), ==, subject_id);
+		g_assert_cmpint (tracker_db_cursor_get_int (cursor, 5), ==, TRACKER_DATA_STATEMENT_INSERT);
+
+		if (tracker_db_cursor_get_int (cursor, 4) == fullname_id) {
+			fullname_seen = TRUE;
+		}
+	}
+
+	g_assert_no_error (error);
+	g_assert (fullname_seen);
+	g_object_unref (cursor);
+
+	/* Entries after the last seen modseq are only the new ones */
+	tracker_data_update_sparql ("DELETE { <urn:changes:1> nco:fullname 'first' }", &error);
+	g_assert_no_error (error);
+
+	cursor = tracker_data_query_changes (last_modseq, NULL, 0, &error);
+	g_assert_no_error (error);
+
+	while (tracker_db_cursor_iter_next (cursor, NULL, &error)) {
+		g_assert_cmpint (tracker_db_cursor_get_int (cursor, 0), >, last_modseq);
+		g_assert_cmpint (tracker_db_cursor_get_int (cursor, 3), ==, subject_id);
+		g_assert_cmpint (tracker_db_cursor_get_int (cursor, 4), ==, fullname_id);
+		g_assert_cmpint (tracker_db_cursor_get_int (cursor, 5), ==, TRACKER_DATA_STATEMENT_DELETE);
+		n_changes++;
+	}
+
+	g_assert_no_error (error);
+	g_assert_cmpint (n_changes, >, 0);
+	g_object_unref (cursor);
+
+}
+
+static void
+test_change_log_trim (void)
+{
+	TrackerDBCursor *cursor;
+	GError *error = NULL;
+	gint start, new_start, last_subject = 0, n_rows = 0;
+	gint i;
+
+	/* Trim to a handful of rows every few transactions, the
+	 * limits are read when the store starts.
+	 */
+	g_setenv ("TRACKER_CHANGE_LOG_MAX_ROWS", "5", TRUE);
+	g_setenv ("TRACKER_CHANGE_LOG_TRIM_INTERVAL", "4", TRUE);
+
+	tracker_data_test_teardown ();
+	tracker_data_test_setup (TRACKER_DB_MANAGER_FORCE_REINDEX);
+
+	g_unsetenv ("TRACKER_CHANGE_LOG_MAX_ROWS");
+	g_unsetenv ("TRACKER_CHANGE_LOG_TRIM_INTERVAL");
+
+	start = tracker_data_query_change_log_start (&error);
+	g_assert_no_error (error);
+
+	/* Each transaction adds a few rows, so at least one
+	 * trim happens once there are more than 5.
+	 */
+	for (i = 0; i < 10; i++) {
+		gchar *sparql;
+
+		sparql = g_strdup_printf ("INSERT { <urn:trim:%d> a nco:PersonContact ; nco:fullname 'trim' }", i);
+		tracker_data_update_sparql (sparql, &error);
+		g_assert_no_error (error);
+		g_free (sparql);
+	}
+
+	new_start = tracker_data_query_change_log_start (&error);
+	g_assert_no_error (error);
+	g_assert_cmpint (new_start, >, start);
+
+	/* Nothing older than the start is left, and the most
+	 * recent changes are still there.
+	 */
+	cursor = tracker_data_query_changes (0, NULL, 0, &error);
+	g_assert_no_error (error);
+
+	while (tracker_db_cursor_iter_next (cursor, NULL, &error)) {
+		g_assert_cmpint (tracker_db_cursor_get_int (cursor, 0), >=, new_start);
+		last_subject = tracker_db_cursor_get_int (cursor, 3);
+		n_rows++;
+	}
+
+	g_assert_no_error (error);
+	g_assert_cmpint (n_rows, >, 5);
+	g_assert_cmpint (last_subject, ==, tracker_data_query_resource_id ("urn:trim:9"));
+	g_object_unref (cursor);
+}
+
+static void
+test_class_counts_persist (void)
+{
+	TrackerClass *contact;
+	GError *error = NULL;
+	gint count;
+
+	g_assert (tracker_data_class_counts_loaded ());
+
+	contact = tracker_ontologies_get_class_by_uri (TRACKER_NCO_PREFIX "PersonContact");
+	count = tracker_class_get_count (contact);
+
+	tracker_data_update_sparql ("INSERT { <urn:counts:1> a nco:PersonContact } "
+	                            "INSERT { <urn:counts:2> a nco:PersonContact }",
+	                            &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (tracker_class_get_count (contact), ==, count + 2);
+
+	tracker_data_test_teardown ();
+
+	/* Counts are kept across restarts */
+	tracker_data_test_setup (0);
+
+	contact = tracker_ontologies_get_class_by_uri (TRACKER_NCO_PREFIX "PersonContact");
+	g_assert_cmpint (tracker_class_get_count (contact), ==, count + 2);
+
+	/* And fixed on verification if they went wrong */
+	tracker_class_set_count (contact, 0);
+	g_assert (!tracker_data_class_counts_verify (contact, &error));
+	g_assert_no_error (error);
+	g_assert_cmpint (tracker_class_get_count (contact), ==, count + 2);
+
+	g_assert (tracker_data_class_counts_verify (contact, &error));
+	g_assert_no_error (error);
+}
+
+#define NIE_PREFIX_DIRECTIVE "@prefix nie: <http://www.semanticdesktop.org/ontologies/2007/01/19/nie#> .\n"
+
+/* Every statement ends up in a chunk of its own, see main() */
+static void
+load_turtle (const gchar  *data,
+             GError      **error)
+{
+	const gchar *filename = "turtle-test.ttl";
+
+	g_assert (g_file_set_contents (filename, data, -1, NULL));
+
+	tracker_turtle_reader_load (filename, error);
+
+	g_unlink (filename);
+}
+
+static gchar *
+query_string (const gchar *query)
+{
+	TrackerDBCursor *cursor;
+	GError *error = NULL;
+	gchar *result = NULL;
+
+	cursor = tracker_data_query_sparql_cursor (query, &error);
+	g_assert_no_error (error);
+
+	if (tracker_db_cursor_iter_next (cursor, NULL, &error)) {
+		result = g_strdup (tracker_db_cursor_get_string (cursor, 0, NULL));
+	}
+
+	g_assert_no_error (error);
+	g_object_unref (cursor);
+
+	return result;
+}
+
+static gint
+query_count (const gchar *query)
+{
+	gchar *result;
+	gint count;
+
+	result = query_string (query);
+	g_assert (result != NULL);
+	count = atoi (result);
+	g_free (result);
+
+	return count;
+}
+
+static void
+assert_title (const gchar *uri,
+              const gchar *title)
+{
+	gchar *query, *result;
+
+	query = g_strdup_printf ("SELECT ?t WHERE { <%s> nie:title ?t }", uri);
+	result = query_string (query);
+	g_assert_cmpstr (result, ==, title);
+	g_free (result);
+	g_free (query);
+}
+
+static void
+test_turtle_chunks_dots (void)
+{
+	GError *error = NULL;
+	gchar *result;
+
+	load_turtle (NIE_PREFIX_DIRECTIVE
+	             "<urn:turtle:1> a nie:InformationElement ; nie:title \"short. string\" .\n"
+	             "<urn:turtle:2> a nie:InformationElement ; nie:title \"\"\"long.\n. string\"\"\" .\n"
+	             "<urn:turtle:3.#dot> a nie:InformationElement ; nie:title \"iri\" .\n"
+	             "<urn:turtle:4> a nie:InformationElement ; nie:title \"brackets [. and (. \" ;\n"
+	             "\tnie:isLogicalPartOf [ a nie:InformationElement ; nie:title \"inner. \" ] .\n"
+	             "<urn:turtle:5> a nie:InformationElement ; nie:title \"last\" .\n",
+	             &error);
+	g_assert_no_error (error);
+
+	assert_title ("urn:turtle:1", "short. string");
+	assert_title ("urn:turtle:2", "long.\n. string");
+	assert_title ("urn:turtle:3.#dot", "iri");
+	assert_title ("urn:turtle:4", "brackets [. and (. ");
+	assert_title ("urn:turtle:5", "last");
+
+	result = query_string ("SELECT ?t WHERE { <urn:turtle:4> nie:isLogicalPartOf ?p . ?p nie:title ?t }");
+	g_assert_cmpstr (result, ==, "inner. ");
+	g_free (result);
+}
+
+static void
+test_turtle_chunks_prefixes (void)
+{
+	GError *error = NULL;
+
+	/* Directives are replayed in file order before each chunk */
+	load_turtle (NIE_PREFIX_DIRECTIVE
+	             "@prefix ex: <urn:first:> .\n"
+	             "ex:a a nie:InformationElement .\n"
+	             "@prefix ex: <urn:second:> .\n"
+	             "ex:b a nie:InformationElement .\n",
+	             &error);
+	g_assert_no_error (error);
+
+	g_assert_cmpint (query_count ("SELECT COUNT(?c) WHERE { <urn:first:a> a ?c }"), >, 0);
+	g_assert_cmpint (query_count ("SELECT COUNT(?c) WHERE { <urn:second:b> a ?c }"), >, 0);
+	g_assert_cmpint (query_count ("SELECT COUNT(?c) WHERE { <urn:first:b> a ?c }"), ==, 0);
+}
+
+static void
+test_turtle_chunks_blank_nodes (void)
+{
+	GError *error = NULL;
+
+	load_turtle (NIE_PREFIX_DIRECTIVE
+	             "<urn:turtle:b1> a nie:InformationElement ; nie:title \"anon\" ; nie:isLogicalPartOf [ a nie:InformationElement ] .\n"
+	             "<urn:turtle:b2> a nie:InformationElement ; nie:title \"anon\" ; nie:isLogicalPartOf [ a nie:InformationElement ] .\n"
+	             "<urn:turtle:b3> a nie:InformationElement ; nie:title \"anon\" ; nie:isLogicalPartOf [ a nie:InformationElement ] .\n"
+	             "_:shared a nie:InformationElement .\n"
+	             "<urn:turtle:b4> a nie:InformationElement ; nie:title \"shared\" ; nie:isLogicalPartOf _:shared .\n"
+	             "<urn:turtle:b5> a nie:InformationElement ; nie:title \"shared\" ; nie:isLogicalPartOf _:shared .\n",
+	             &error);
+	g_assert_no_error (error);
+
+	/* Anonymous nodes of different chunks are different resources,
+	 * labeled ones are the same resource in the whole file.
+	 */
+	g_assert_cmpint (query_count ("SELECT COUNT(DISTINCT ?p) WHERE { ?s nie:title \"anon\" ; nie:isLogicalPartOf ?p }"), ==, 3);
+	g_assert_cmpint (query_count ("SELECT COUNT(DISTINCT ?p) WHERE { ?s nie:title \"shared\" ; nie:isLogicalPartOf ?p }"), ==, 1);
+}
+
+static void
+test_turtle_chunks_error_line (void)
+{
+	GError *error = NULL;
+
+	load_turtle (NIE_PREFIX_DIRECTIVE
+	             "<urn:turtle:e1> a nie:InformationElement .\n"
+	             "<urn:turtle:e2> a nie:InformationElement ;\n"
+	             "\tnie:title \"\"\"two\nlines\"\"\" .\n"
+	             "\n"
+	             "<urn:turtle:e3> a\n"
+	             "\t, .\n",
+	             &error);
+	g_assert_error (error, TRACKER_SPARQL_ERROR, TRACKER_SPARQL_ERROR_PARSE);
+
+	/* Lines are counted from the start of the file, not of the chunk */
+	g_assert (g_str_has_prefix (error->message, "8."));
+	g_clear_error (&error);
+
+	/* The whole file is loaded in a single transaction */
+	g_assert_cmpint (query_count ("SELECT COUNT(?c) WHERE { <urn:turtle:e1> a ?c }"), ==, 0);
+}
+
+#define TRACKER_DUMP TOP_BUILDDIR "/utils/tracker-dump/tracker-dump"
+
+/* Runs tracker-dump on the store in the current XDG directories */
+static gchar *
+run_dump (const gchar *args)
+{
+	gchar *command, *output = NULL;
+	GError *error = NULL;
+	gint exit_status;
+
+	command = g_strdup_printf (TRACKER_DUMP " %s", args);
+	g_spawn_command_line_sync (command, &output, NULL, &exit_status, &error);
+	g_assert_no_error (error);
+
+	g_spawn_check_exit_status (exit_status, &error);
+	g_assert_no_error (error);
+
+	g_free (command);
+
+	return output;
+}
+
+static gint
+compare_lines (gconstpointer a,
+               gconstpointer b)
+{
+	return strcmp (*(const gchar **) a, *(const gchar **) b);
+}
+
+/* Triples come out in table order, tracker:modified is rewritten
+ * by every update, thus left out of the comparison.
+ */
+static gchar *
+sorted_triples (const gchar *ntriples)
+{
+	gchar **lines, *result;
+	GPtrArray *kept;
+	guint i;
+
+	lines = g_strsplit (ntriples, "\n", -1);
+	kept = g_ptr_array_new ();
+
+	for (i = 0; lines[i]; i++) {
+		if (lines[i][0] == '\0' ||
+		    strstr (lines[i], "<" TRACKER_TRACKER_PREFIX "modified>")) {
+			continue;
+		}
+
+		g_ptr_array_add (kept, lines[i]);
+	}
+
+	g_ptr_array_sort (kept, compare_lines);
+	g_ptr_array_add (kept, NULL);
+
+	result = g_strjoinv ("\n", (gchar **) kept->pdata);
+
+	g_ptr_array_free (kept, TRUE);
+	g_strfreev (lines);
+
+	return result;
+}
+
+static void
+test_dump_round_trip (void)
+{
+	gchar *original, *imported, *graph_dump, *output;
+	gchar *original_triples, *imported_triples;
+	GError *error = NULL;
+
+	tracker_data_update_sparql ("INSERT { <urn:dump:1> a nie:InformationElement ; "
+	                            "nie:title \"quoted \\\" and\\nsplit\" ; "
+	                            "nie:contentCreated \"2014-01-01T10:00:00Z\" . "
+	                            "<urn:dump:2> a nie:InformationElement ; "
+	                            "nie:isLogicalPartOf <urn:dump:1> ; "
+	                            "nie:contentSize 42 } "
+	                            "INSERT { GRAPH <urn:dump:graph> { "
+	                            "<urn:dump:3> a nie:InformationElement ; nie:title \"three\" } }",
+	                            &error);
+	g_assert_no_error (error);
+
+	/* tracker-dump opens the store itself */
+	tracker_data_test_teardown ();
+
+	original = run_dump ("--format ntriples");
+	g_assert (strstr (original, "<urn:dump:2>") != NULL);
+
+	output = run_dump ("--format binary --output dump.bin");
+	g_free (output);
+
+	/* Import into a fresh store */
+	g_spawn_command_line_sync ("rm -R tracker/", NULL, NULL, NULL, NULL);
+
+	output = run_dump ("--import dump.bin");
+	g_free (output);
+
+	imported = run_dump ("--format ntriples");
+
+	original_triples = sorted_triples (original);
+	imported_triples = sorted_triples (imported);
+	g_assert_cmpstr (original_triples, ==, imported_triples);
+
+	/* Graphs are kept by the binary format */
+	graph_dump = run_dump ("--graph urn:dump:graph");
+	g_assert (strstr (graph_dump, "<urn:dump:3>") != NULL);
+	g_assert (strstr (graph_dump, "<urn:dump:1>") == NULL);
+
+	g_unlink ("dump.bin");
+	g_free (original);
+	g_free (imported);
+	g_free (graph_dump);
+	g_free (original_triples);
+	g_free (imported_triples);
+
+	/* Leave the imported store open for the test teardown */
+	tracker_data_test_setup (0);
+}
+
+int
+main (int argc, char **argv)
+{
+	tracker_data_test_init (&argc, &argv);
+
+	/* Read once, when the first file is loaded */
+	g_setenv ("TRACKER_TURTLE_CHUNK_SIZE", "1", TRUE);
+
+	tracker_data_test_add ("/libtracker-data/update/array", test_update_array);
+	tracker_data_test_add ("/libtracker-data/update/statements", test_update_statements);
+	tracker_data_test_add ("/libtracker-data/update/array-writeback", test_update_array_writeback);
+	tracker_data_test_add ("/libtracker-data/change-log/query", test_change_log_query);
+	tracker_data_test_add ("/libtracker-data/change-log/trim", test_change_log_trim);
+	tracker_data_test_add ("/libtracker-data/class-counts/persist", test_class_counts_persist);
+	tracker_data_test_add ("/libtracker-data/turtle/chunks/dots", test_turtle_chunks_dots);
+	tracker_data_test_add ("/libtracker-data/turtle/chunks/prefixes", test_turtle_chunks_prefixes);
+	tracker_data_test_add ("/libtracker-data/turtle/chunks/blank-nodes", test_turtle_chunks_blank_nodes);
+	tracker_data_test_add ("/libtracker-data/turtle/chunks/error-line", test_turtle_chunks_error_line);
+	tracker_data_test_add ("/libtracker-data/dump/round-trip", test_dump_round_trip);
+
+	return tracker_data_test_run ();
+}
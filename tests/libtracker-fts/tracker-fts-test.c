@@ -19,6 +19,7 @@
 
 #include "config.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 #include <glib.h>
@@ -45,9 +46,19 @@ const TestInfo tests[] = {
 	{ "fts3ae", 1 },
 	{ "prefix/fts3prefix", 3 },
 	{ "limits/fts3limits", 4 },
+	{ "update/fts3update", 4 },
+	{ "rank/fts3rank", 4 },
 	{ NULL }
 };
 
+/* Roughly the size of the nie:plainTextContent of a text document */
+#define PERF_TEXT_SIZE   (64 * 1024)
+#define PERF_N_RESOURCES 100
+
+/* Corpus size for prefix searches, can be raised through the
+ * TRACKER_FTS_PERF_DOCUMENTS envvar, e.g. to 1000000 */
+#define PERF_N_DOCUMENTS 100000
+
 static void
 test_sparql_query (gconstpointer test_data)
 {
@@ -173,6 +184,178 @@ test_sparql_query (gconstpointer test_data)
 	tracker_data_manager_shutdown ();
 }
 
+static void
+perf_run_updates (const gchar *format,
+                  const gchar *description)
+{
+	GError *error = NULL;
+	GTimer *timer;
+	gchar *update;
+	gint i;
+
+	timer = g_timer_new ();
+
+	for (i = 0; i < PERF_N_RESOURCES; i++) {
+		update = g_strdup_printf (format, i, i, i);
+		tracker_data_update_sparql (update, &error);
+		g_assert_no_error (error);
+		g_free (update);
+	}
+
+	g_test_minimized_result (g_timer_elapsed (timer, NULL) / PERF_N_RESOURCES,
+	                         "%s: %f secs per update", description,
+	                         g_timer_elapsed (timer, NULL) / PERF_N_RESOURCES);
+	g_timer_destroy (timer);
+}
+
+static void
+test_fts_update_perf (void)
+{
+	GError *error = NULL;
+	GString *body;
+	gchar *prefix, *data_prefix, *update;
+	const gchar *test_schemas[2] = { NULL, NULL };
+	gint i;
+
+	prefix = g_build_path (G_DIR_SEPARATOR_S, TOP_SRCDIR, "tests", "libtracker-fts", NULL);
+	data_prefix = g_build_filename (prefix, "data", NULL);
+	g_free (prefix);
+
+	test_schemas[0] = data_prefix;
+	tracker_db_journal_set_rotating (FALSE, G_MAXSIZE, NULL);
+	tracker_data_manager_init (TRACKER_DB_MANAGER_FORCE_REINDEX,
+	                           test_schemas,
+	                           NULL, FALSE, FALSE,
+	                           100, 100, NULL, NULL, NULL, &error);
+	g_assert_no_error (error);
+
+	body = g_string_new (NULL);
+
+	for (i = 0; body->len < PERF_TEXT_SIZE; i++) {
+		g_string_append_printf (body, "word%d ", i % 5000);
+	}
+
+	for (i = 0; i < PERF_N_RESOURCES; i++) {
+		update = g_strdup_printf ("INSERT { test:perf%d a test:A ; test:p \"%s\" ; test:o \"title\" }",
+		                          i, body->str);
+		tracker_data_update_sparql (update, &error);
+		g_assert_no_error (error);
+		g_free (update);
+	}
+
+	perf_run_updates ("DELETE { test:perf%d test:o ?o } WHERE { test:perf%d test:o ?o } "
+	                  "INSERT { test:perf%d test:o \"renamed\" }",
+	                  "Changing a small column next to a large one");
+	perf_run_updates ("DELETE { test:perf%d test:o ?o } WHERE { test:perf%d test:o ?o } "
+	                  "INSERT { test:perf%d test:o \"renamed\" }",
+	                  "Rewriting unchanged indexed text");
+
+	g_string_free (body, TRUE);
+	g_free (data_prefix);
+
+	tracker_data_manager_shutdown ();
+}
+
+static gchar *
+perf_random_word (GRand *rand)
+{
+	static const gchar *syllables[] = {
+		"tra", "ck", "er", "se", "ar", "ch", "in", "dex",
+		"fi", "le", "mu", "sic", "pho", "to", "do", "cu"
+	};
+	GString *word;
+	gint i, n;
+
+	word = g_string_new (NULL);
+	n = g_rand_int_range (rand, 1, 5);
+
+	for (i = 0; i < n; i++) {
+		g_string_append (word, syllables[g_rand_int_range (rand, 0, G_N_ELEMENTS (syllables))]);
+	}
+
+	return g_string_free (word, FALSE);
+}
+
+static void
+test_fts_prefix_perf (void)
+{
+	GError *error = NULL;
+	GString *update;
+	GRand *rand;
+	GTimer *timer;
+	gchar *prefix, *data_prefix, *query;
+	const gchar *n_documents_env;
+	const gchar *test_schemas[2] = { NULL, NULL };
+	const gchar *typed = "tracker";
+	gint i, j, n_documents;
+
+	n_documents_env = g_getenv ("TRACKER_FTS_PERF_DOCUMENTS");
+	n_documents = n_documents_env ? atoi (n_documents_env) : PERF_N_DOCUMENTS;
+
+	prefix = g_build_path (G_DIR_SEPARATOR_S, TOP_SRCDIR, "tests", "libtracker-fts", NULL);
+	data_prefix = g_build_filename (prefix, "data", NULL);
+	g_free (prefix);
+
+	test_schemas[0] = data_prefix;
+	tracker_db_journal_set_rotating (FALSE, G_MAXSIZE, NULL);
+	tracker_data_manager_init (TRACKER_DB_MANAGER_FORCE_REINDEX,
+	                           test_schemas,
+	                           NULL, FALSE, FALSE,
+	                           100, 100, NULL, NULL, NULL, &error);
+	g_assert_no_error (error);
+
+	rand = g_rand_new_with_seed (42);
+
+	for (i = 0; i < n_documents; i += 1000) {
+		update = g_string_new ("INSERT {");
+
+		for (j = i; j < MIN (i + 1000, n_documents); j++) {
+			gchar *p, *o;
+
+			p = perf_random_word (rand);
+			o = perf_random_word (rand);
+			g_string_append_printf (update, " test:doc%d a test:A ; test:p \"%s %s\" .", j, p, o);
+			g_free (p);
+			g_free (o);
+		}
+
+		g_string_append (update, " }");
+		tracker_data_update_sparql (update->str, &error);
+		g_assert_no_error (error);
+		g_string_free (update, TRUE);
+	}
+
+	/* Simulate the queries issued while typing a search term */
+	for (i = 1; typed[i - 1] != '\0'; i++) {
+		TrackerDBCursor *cursor;
+		gdouble elapsed;
+
+		query = g_strdup_printf ("SELECT ?u WHERE { ?u fts:match \"%.*s*\" } "
+		                         "ORDER BY DESC (fts:rank (?u)) LIMIT 10",
+		                         i, typed);
+
+		timer = g_timer_new ();
+		cursor = tracker_data_query_sparql_cursor (query, &error);
+		g_assert_no_error (error);
+
+		while (tracker_db_cursor_iter_next (cursor, NULL, &error));
+		g_assert_no_error (error);
+
+		elapsed = g_timer_elapsed (timer, NULL);
+		g_test_minimized_result (elapsed, "Keystroke %d ('%.*s*') on %d documents: %f secs",
+		                         i, i, typed, n_documents, elapsed);
+
+		g_object_unref (cursor);
+		g_timer_destroy (timer);
+		g_free (query);
+	}
+
+	g_rand_free (rand);
+	g_free (data_prefix);
+
+	tracker_data_manager_shutdown ();
+}
+
 int
 main (int argc, char **argv)
 {
@@ -201,6 +384,11 @@ main (int argc, char **argv)
 		g_free (testpath);
 	}
 
+	if (g_test_perf ()) {
+		g_test_add_func ("/libtracker-fts/perf/update", test_fts_update_perf);
+		g_test_add_func ("/libtracker-fts/perf/prefix", test_fts_prefix_perf);
+	}
+
 	/* run tests */
 	result = g_test_run ();
 
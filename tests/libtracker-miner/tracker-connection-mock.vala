@@ -94,4 +94,22 @@ public class TrackerMockConnection : Sparql.Connection {
         this.results = results;
     }
 
+    /* Whether array updates fail as a whole, as they do when
+     * the store can't be reached.
+     */
+    public bool fail_updates { get; set; }
+
+    public async override GenericArray<Error?>? update_array_async (string[] sparql, int priority = GLib.Priority.DEFAULT, Cancellable? cancellable = null)
+    throws Sparql.Error, IOError, DBusError {
+        if (this.fail_updates) {
+            throw new Sparql.Error.INTERNAL ("Mock update failure");
+        }
+
+        var result = new GenericArray<Error?> ();
+        for (int i = 0; i < sparql.length; i++) {
+            result.add (null);
+        }
+        return result;
+    }
+
 }
@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+
+/* NOTE: We're not including tracker-miner.h here because this is private. */
+#include <libtracker-miner/tracker-crawl-cache.h>
+
+typedef struct {
+	gchar *dir;
+	gchar *path;
+} TestCommonContext;
+
+#define test_add(path,fun)	  \
+	g_test_add (path, \
+	            TestCommonContext, \
+	            NULL, \
+	            test_common_context_setup, \
+	            fun, \
+	            test_common_context_teardown)
+
+static void
+test_common_context_setup (TestCommonContext *fixture,
+                           gconstpointer      data)
+{
+	fixture->dir = g_dir_make_tmp ("tracker-crawl-cache-test-XXXXXX", NULL);
+	g_assert (fixture->dir != NULL);
+
+	fixture->path = g_build_filename (fixture->dir, "cache", NULL);
+}
+
+static void
+test_common_context_teardown (TestCommonContext *fixture,
+                              gconstpointer      data)
+{
+	g_unlink (fixture->path);
+	g_rmdir (fixture->dir);
+
+	g_free (fixture->path);
+	g_free (fixture->dir);
+}
+
+static void
+entry_set (TrackerCrawlCacheEntry *entry,
+           guint64                 value)
+{
+	entry->inode = value;
+	entry->mtime = value + 1;
+	entry->children_mtime_sum = value + 2;
+	entry->n_children = value + 3;
+}
+
+static void
+cache_record (TrackerCrawlCache *cache,
+              const gchar       *path,
+              guint64            value)
+{
+	TrackerCrawlCacheEntry entry;
+	GFile *file;
+
+	file = g_file_new_for_path (path);
+	entry_set (&entry, value);
+	tracker_crawl_cache_record (cache, file, &entry);
+	g_object_unref (file);
+}
+
+static gboolean
+cache_lookup (TrackerCrawlCache *cache,
+              const gchar       *path,
+              guint64            value)
+{
+	TrackerCrawlCacheEntry entry, expected;
+	gboolean found;
+	GFile *file;
+
+	file = g_file_new_for_path (path);
+	found = tracker_crawl_cache_lookup (cache, file, &entry);
+	g_object_unref (file);
+
+	if (found) {
+		entry_set (&expected, value);
+		g_assert (tracker_crawl_cache_entry_equal (&entry, &expected));
+	}
+
+	return found;
+}
+
+static void
+test_crawl_cache_missing (TestCommonContext *fixture,
+                          gconstpointer      data)
+{
+	TrackerCrawlCache *cache;
+
+	cache = tracker_crawl_cache_new (fixture->path);
+	g_assert (!cache_lookup (cache, "/a", 0));
+	tracker_crawl_cache_free (cache);
+}
+
+static void
+test_crawl_cache_save_load (TestCommonContext *fixture,
+                            gconstpointer      data)
+{
+	TrackerCrawlCache *cache;
+	GError *error = NULL;
+
+	cache = tracker_crawl_cache_new (fixture->path);
+	cache_record (cache, "/a", 10);
+	cache_record (cache, "/a/b", 20);
+	cache_record (cache, "/c", 30);
+
+	/* Recorded entries are only visible once saved */
+	g_assert (!cache_lookup (cache, "/a", 10));
+
+	tracker_crawl_cache_save (cache, &error);
+	g_assert_no_error (error);
+	tracker_crawl_cache_free (cache);
+
+	cache = tracker_crawl_cache_new (fixture->path);
+	g_assert (cache_lookup (cache, "/a", 10));
+	g_assert (cache_lookup (cache, "/a/b", 20));
+	g_assert (cache_lookup (cache, "/c", 30));
+	g_assert (!cache_lookup (cache, "/b", 0));
+	g_assert (!cache_lookup (cache, "/a/b/c", 0));
+	tracker_crawl_cache_free (cache);
+}
+
+static void
+test_crawl_cache_replace_tree (TestCommonContext *fixture,
+                               gconstpointer      data)
+{
+	TrackerCrawlCache *cache;
+	GError *error = NULL;
+	GFile *file;
+
+	cache = tracker_crawl_cache_new (fixture->path);
+	cache_record (cache, "/a", 10);
+	cache_record (cache, "/a/b", 20);
+	cache_record (cache, "/a2", 30);
+	tracker_crawl_cache_save (cache, &error);
+	g_assert_no_error (error);
+	tracker_crawl_cache_free (cache);
+
+	cache = tracker_crawl_cache_new (fixture->path);
+
+	file = g_file_new_for_path ("/a");
+	g_assert (!tracker_crawl_cache_has_recorded (cache, file));
+	tracker_crawl_cache_begin_tree (cache, file);
+	g_assert (tracker_crawl_cache_has_recorded (cache, file));
+	g_object_unref (file);
+
+	cache_record (cache, "/a", 40);
+	cache_record (cache, "/a/d", 50);
+
+	file = g_file_new_for_path ("/a/d");
+	g_assert (tracker_crawl_cache_has_recorded (cache, file));
+	g_object_unref (file);
+
+	file = g_file_new_for_path ("/a2");
+	g_assert (!tracker_crawl_cache_has_recorded (cache, file));
+	g_object_unref (file);
+
+	tracker_crawl_cache_save (cache, &error);
+	g_assert_no_error (error);
+	tracker_crawl_cache_free (cache);
+
+	/* /a/b is gone with the tree it belonged to, /a2 is kept */
+	cache = tracker_crawl_cache_new (fixture->path);
+	g_assert (cache_lookup (cache, "/a", 40));
+	g_assert (!cache_lookup (cache, "/a/b", 0));
+	g_assert (cache_lookup (cache, "/a/d", 50));
+	g_assert (cache_lookup (cache, "/a2", 30));
+	tracker_crawl_cache_free (cache);
+}
+
+static void
+test_crawl_cache_invalid (TestCommonContext *fixture,
+                          gconstpointer      data)
+{
+	TrackerCrawlCache *cache;
+	GError *error = NULL;
+
+	g_file_set_contents (fixture->path,
+	                     "TRKCRAWL\x04\x03\x02\x01 not really a crawl cache",
+	                     -1, &error);
+	g_assert_no_error (error);
+
+	cache = tracker_crawl_cache_new (fixture->path);
+	g_assert (!cache_lookup (cache, "/a", 0));
+
+	/* An invalid cache is overwritten on save */
+	cache_record (cache, "/a", 10);
+	tracker_crawl_cache_save (cache, &error);
+	g_assert_no_error (error);
+	tracker_crawl_cache_free (cache);
+
+	cache = tracker_crawl_cache_new (fixture->path);
+	g_assert (cache_lookup (cache, "/a", 10));
+	tracker_crawl_cache_free (cache);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+	g_test_init (&argc, &argv, NULL);
+
+	g_test_message ("Testing crawl cache");
+
+	test_add ("/libtracker-miner/crawl-cache/missing",
+	          test_crawl_cache_missing);
+	test_add ("/libtracker-miner/crawl-cache/save-load",
+	          test_crawl_cache_save_load);
+	test_add ("/libtracker-miner/crawl-cache/replace-tree",
+	          test_crawl_cache_replace_tree);
+	test_add ("/libtracker-miner/crawl-cache/invalid",
+	          test_crawl_cache_invalid);
+
+	return g_test_run ();
+}
@@ -20,9 +20,20 @@
 #include "config.h"
 
 #include <locale.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <glib/gstdio.h>
 
 #include <libtracker-miner/tracker-crawler.h>
 
+/* Number of files in the generated tree, can be changed through
+ * the TRACKER_CRAWLER_PERF_FILES envvar
+ */
+#define PERF_N_FILES          1000000
+#define PERF_FILES_PER_DIR    1000
+#define PERF_DIRS_PER_DIR     10
+
 typedef struct CrawlerTest CrawlerTest;
 
 struct CrawlerTest {
@@ -321,6 +332,97 @@ test_crawler_crawl_n_signals_non_recursive (void)
 	g_object_unref (file);
 }
 
+static void
+perf_create_tree (const gchar *path,
+                  gint         n_files)
+{
+	gint i, n_dirs;
+
+	/* Spread the files in directories of PERF_FILES_PER_DIR
+	 * files each, PERF_DIRS_PER_DIR directories per level.
+	 */
+	n_dirs = (n_files + PERF_FILES_PER_DIR - 1) / PERF_FILES_PER_DIR;
+
+	for (i = 0; i < n_dirs; i++) {
+		GString *dir;
+		gint j, k;
+
+		dir = g_string_new (path);
+
+		for (k = i; k >= PERF_DIRS_PER_DIR; k /= PERF_DIRS_PER_DIR) {
+			g_string_append_printf (dir, "/%d", k % PERF_DIRS_PER_DIR);
+		}
+
+		g_string_append_printf (dir, "/dir%d", i);
+		g_assert_cmpint (g_mkdir_with_parents (dir->str, 0700), ==, 0);
+
+		for (j = 0; j < PERF_FILES_PER_DIR && n_files > 0; j++, n_files--) {
+			gchar *file;
+			gint fd;
+
+			file = g_strdup_printf ("%s/file%d", dir->str, j);
+			fd = g_creat (file, 0600);
+			g_assert_cmpint (fd, >=, 0);
+			close (fd);
+			g_free (file);
+		}
+
+		g_string_free (dir, TRUE);
+	}
+}
+
+static void
+test_crawler_crawl_perf (void)
+{
+	TrackerCrawler *crawler;
+	CrawlerTest test = { 0 };
+	GError *error = NULL;
+	const gchar *n_files_env;
+	gchar *path, *command;
+	GTimer *timer;
+	GFile *file;
+	gint n_files;
+	gdouble elapsed;
+
+	n_files_env = g_getenv ("TRACKER_CRAWLER_PERF_FILES");
+	n_files = n_files_env ? atoi (n_files_env) : PERF_N_FILES;
+
+	path = g_dir_make_tmp ("tracker-crawler-perf-XXXXXX", &error);
+	g_assert_no_error (error);
+
+	perf_create_tree (path, n_files);
+
+	test.main_loop = g_main_loop_new (NULL, FALSE);
+
+	crawler = tracker_crawler_new ();
+	g_signal_connect (crawler, "finished",
+			  G_CALLBACK (crawler_finished_cb), &test);
+	g_signal_connect (crawler, "directory-crawled",
+			  G_CALLBACK (crawler_directory_crawled_cb), &test);
+
+	file = g_file_new_for_path (path);
+
+	timer = g_timer_new ();
+	tracker_crawler_start (crawler, file, TRUE);
+	g_main_loop_run (test.main_loop);
+	elapsed = g_timer_elapsed (timer, NULL);
+
+	g_assert_cmpint (test.files_found, ==, n_files);
+
+	g_test_minimized_result (elapsed, "Crawling %d files: %f secs",
+	                         n_files, elapsed);
+
+	g_timer_destroy (timer);
+	g_main_loop_unref (test.main_loop);
+	g_object_unref (crawler);
+	g_object_unref (file);
+
+	command = g_strdup_printf ("rm -R %s", path);
+	g_spawn_command_line_sync (command, NULL, NULL, NULL, NULL);
+	g_free (command);
+	g_free (path);
+}
+
 int
 main (int    argc,
       char **argv)
@@ -346,5 +448,10 @@ main (int    argc,
 	g_test_add_func ("/libtracker-miner/tracker-crawler/crawl-n-signals-non-recursive",
 	                 test_crawler_crawl_n_signals_non_recursive);
 
+	if (g_test_perf ()) {
+		g_test_add_func ("/libtracker-miner/tracker-crawler/perf/crawl",
+		                 test_crawler_crawl_perf);
+	}
+
 	return g_test_run ();
 }
@@ -25,10 +25,14 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <locale.h>
+#include <time.h>
+#include <utime.h>
 
 #include <glib.h>
 #include <glib/gstdio.h>
 
+#include <libtracker-common/tracker-common.h>
+#include <libtracker-sparql/tracker-sparql.h>
 #include <libtracker-miner/tracker-miner-enums.h>
 #include <libtracker-miner/tracker-file-notifier.h>
 
@@ -257,6 +261,121 @@ test_common_context_remove_dir (TestCommonContext     *fixture,
 	g_object_unref (file);
 }
 
+static void
+test_common_context_set_mtime (TestCommonContext *fixture,
+                               const gchar       *filename,
+                               time_t             mtime)
+{
+	struct utimbuf buf;
+	gchar *path;
+
+	path = g_build_filename (fixture->test_path, filename, NULL);
+	buf.actime = buf.modtime = mtime;
+	g_assert_cmpint (g_utime (path, &buf), ==, 0);
+	g_free (path);
+}
+
+/* Inserts @filenames in the store as the miner would after
+ * processing them, with their current mtime.
+ */
+static void
+test_common_context_store_files (TestCommonContext  *fixture,
+                                 const gchar       **filenames)
+{
+	TrackerSparqlConnection *connection;
+	GError *error = NULL;
+	GString *sparql;
+	guint i;
+
+	connection = tracker_sparql_connection_get (NULL, &error);
+	g_assert_no_error (error);
+
+	sparql = g_string_new ("INSERT {");
+
+	for (i = 0; filenames[i]; i++) {
+		GFileInfo *info;
+		GFile *file, *parent;
+		gchar *path, *uri, *parent_uri, *date;
+
+		path = g_build_filename (fixture->test_path, filenames[i], NULL);
+		file = g_file_new_for_path (path);
+		info = g_file_query_info (file,
+		                          G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+		                          G_FILE_ATTRIBUTE_TIME_MODIFIED,
+		                          G_FILE_QUERY_INFO_NONE,
+		                          NULL, &error);
+		g_assert_no_error (error);
+
+		uri = g_file_get_uri (file);
+		date = tracker_date_to_string (g_file_info_get_attribute_uint64 (info,
+		                                                                 G_FILE_ATTRIBUTE_TIME_MODIFIED));
+
+		g_string_append_printf (sparql,
+		                        " <%s> a nfo:FileDataObject%s ; "
+		                        "nie:url \"%s\" ; "
+		                        "nfo:fileLastModified \"%s\"",
+		                        uri,
+		                        g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY ?
+		                        ", nfo:Folder" : "",
+		                        uri, date);
+
+		/* Roots are looked up by URL, everything
+		 * else through their parent folder.
+		 */
+		parent = g_file_get_parent (file);
+
+		if (!g_file_equal (parent, fixture->test_file)) {
+			parent_uri = g_file_get_uri (parent);
+			g_string_append_printf (sparql, " ; nfo:belongsToContainer <%s>",
+			                        parent_uri);
+			g_free (parent_uri);
+		}
+
+		g_string_append (sparql, " .");
+
+		g_object_unref (parent);
+		g_object_unref (info);
+		g_object_unref (file);
+		g_free (date);
+		g_free (uri);
+		g_free (path);
+	}
+
+	g_string_append (sparql, " }");
+
+	tracker_sparql_connection_update (connection, sparql->str,
+	                                  G_PRIORITY_DEFAULT, NULL, &error);
+	g_assert_no_error (error);
+
+	g_string_free (sparql, TRUE);
+	g_object_unref (connection);
+}
+
+static void
+test_common_context_unstore_files (TestCommonContext *fixture)
+{
+	TrackerSparqlConnection *connection;
+	GError *error = NULL;
+	gchar *uri, *sparql;
+
+	connection = tracker_sparql_connection_get (NULL, &error);
+	g_assert_no_error (error);
+
+	uri = g_file_get_uri (fixture->test_file);
+	sparql = g_strdup_printf ("DELETE { ?u a rdfs:Resource } "
+	                          "WHERE { ?u nie:url ?url . "
+	                          "FILTER (fn:starts-with (?url, \"%s/\")) }",
+	                          uri);
+
+	tracker_sparql_connection_update (connection, sparql,
+	                                  G_PRIORITY_DEFAULT, NULL, &error);
+	g_assert_no_error (error);
+
+	g_free (sparql);
+	g_free (uri);
+	g_object_unref (connection);
+}
+
 static void
 test_common_context_setup (TestCommonContext *fixture,
                            gconstpointer      data)
@@ -575,6 +694,115 @@ test_file_notifier_crawling_ignore_within_recursive (TestCommonContext *fixture,
 	tracker_file_notifier_stop (fixture->notifier);
 }
 
+static void
+test_file_notifier_crawling_incremental (TestCommonContext *fixture,
+                                         gconstpointer      data)
+{
+	FilesystemOperation expected_results[] = {
+		{ OPERATION_CREATE, "recursive", NULL },
+		{ OPERATION_CREATE, "recursive/folder", NULL },
+		{ OPERATION_CREATE, "recursive/folder/aaa", NULL },
+		{ OPERATION_CREATE, "recursive/other", NULL },
+		{ OPERATION_CREATE, "recursive/other/bbb", NULL },
+	};
+	FilesystemOperation expected_results2[] = {
+		{ OPERATION_CREATE, "recursive/folder/aaa", NULL },
+	};
+	FilesystemOperation expected_results3[] = {
+		{ OPERATION_CREATE, "recursive/other/ccc", NULL },
+	};
+	/* recursive/folder/aaa is left out of the store, as
+	 * if it failed processing, so it must be notified again.
+	 */
+	const gchar *stored[] = {
+		"recursive",
+		"recursive/folder",
+		"recursive/other",
+		"recursive/other/bbb",
+		NULL
+	};
+	const gchar *stored2[] = {
+		"recursive/folder/aaa",
+		NULL
+	};
+	gchar *cache_path;
+	time_t mtime;
+
+	CREATE_FOLDER (fixture, "recursive/folder");
+	CREATE_UPDATE_FILE (fixture, "recursive/folder/aaa");
+	CREATE_FOLDER (fixture, "recursive/other");
+	CREATE_UPDATE_FILE (fixture, "recursive/other/bbb");
+
+	/* Keep mtimes stable, so only the crawl cache
+	 * tells changed directories apart.
+	 */
+	mtime = time (NULL) - 3600;
+	test_common_context_set_mtime (fixture, "recursive", mtime);
+	test_common_context_set_mtime (fixture, "recursive/folder", mtime);
+	test_common_context_set_mtime (fixture, "recursive/folder/aaa", mtime);
+	test_common_context_set_mtime (fixture, "recursive/other", mtime);
+	test_common_context_set_mtime (fixture, "recursive/other/bbb", mtime);
+
+	cache_path = g_build_filename (fixture->test_path, "non-indexed",
+	                               "crawl-cache", NULL);
+	tracker_file_notifier_set_crawl_cache (fixture->notifier, cache_path);
+
+	test_common_context_index_dir (fixture, "recursive",
+	                               TRACKER_DIRECTORY_FLAG_RECURSE |
+	                               TRACKER_DIRECTORY_FLAG_CHECK_MTIME);
+
+	/* Nothing cached yet, everything is crawled */
+	tracker_file_notifier_start (fixture->notifier);
+	test_common_context_expect_results (fixture, expected_results,
+	                                    G_N_ELEMENTS (expected_results),
+	                                    2, TRUE);
+	tracker_file_notifier_stop (fixture->notifier);
+
+	test_common_context_store_files (fixture, stored);
+	tracker_file_notifier_save_crawl_cache (fixture->notifier);
+
+	/* Load the saved cache again, as a new session would */
+	tracker_file_notifier_set_crawl_cache (fixture->notifier, cache_path);
+
+	/* Changing the flags makes the root be crawled again,
+	 * directories with notified files were not cached.
+	 */
+	test_common_context_index_dir (fixture, "recursive",
+	                               TRACKER_DIRECTORY_FLAG_RECURSE |
+	                               TRACKER_DIRECTORY_FLAG_CHECK_MTIME |
+	                               TRACKER_DIRECTORY_FLAG_PRESERVE);
+
+	tracker_file_notifier_start (fixture->notifier);
+	test_common_context_expect_results (fixture, expected_results2,
+	                                    G_N_ELEMENTS (expected_results2),
+	                                    2, TRUE);
+	tracker_file_notifier_stop (fixture->notifier);
+
+	test_common_context_store_files (fixture, stored2);
+	tracker_file_notifier_save_crawl_cache (fixture->notifier);
+	tracker_file_notifier_set_crawl_cache (fixture->notifier, cache_path);
+
+	CREATE_UPDATE_FILE (fixture, "recursive/other/ccc");
+	test_common_context_set_mtime (fixture, "recursive/other", mtime);
+
+	/* The root is cached now, so only changed directories
+	 * and the one left uncached are compared with the store.
+	 */
+	test_common_context_index_dir (fixture, "recursive",
+	                               TRACKER_DIRECTORY_FLAG_RECURSE |
+	                               TRACKER_DIRECTORY_FLAG_CHECK_MTIME |
+	                               TRACKER_DIRECTORY_FLAG_PRIORITY);
+
+	tracker_file_notifier_start (fixture->notifier);
+	test_common_context_expect_results (fixture, expected_results3,
+	                                    G_N_ELEMENTS (expected_results3),
+	                                    2, TRUE);
+	tracker_file_notifier_stop (fixture->notifier);
+
+	test_common_context_unstore_files (fixture);
+	g_free (cache_path);
+}
+
 static void
 test_file_notifier_changes_remove_non_recursive (TestCommonContext *fixture,
 						 gconstpointer      data)
@@ -764,6 +992,8 @@ main (gint    argc,
 	          test_file_notifier_crawling_recursive_within_non_recursive);
 	test_add ("/libtracker-miner/file-notifier/crawling-ignore-within-recursive",
 	          test_file_notifier_crawling_ignore_within_recursive);
+	test_add ("/libtracker-miner/file-notifier/crawling-incremental",
+	          test_file_notifier_crawling_incremental);
 
 	/* Config changes */
 	test_add ("/libtracker-miner/file-notifier/changes-remove-non-recursive",
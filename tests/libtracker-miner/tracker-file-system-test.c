@@ -17,6 +17,7 @@
  * 02110-1301, USA.
  */
 #include <string.h>
+#include <stdlib.h>
 #include <unistd.h>
 
 #include <glib.h>
@@ -231,6 +232,85 @@ test_file_system_properties (TestCommonContext *fixture,
 	g_assert (ret_value == NULL);
 }
 
+#define PERF_N_FILES 1000000
+#define PERF_FILES_PER_DIR 1000
+
+/* Resident set size in bytes, or 0 if it can't be read */
+static gsize
+perf_get_rss (void)
+{
+	gchar *contents, **fields;
+	gsize rss = 0;
+
+	if (!g_file_get_contents ("/proc/self/statm", &contents, NULL, NULL)) {
+		return 0;
+	}
+
+	fields = g_strsplit (contents, " ", -1);
+
+	if (g_strv_length (fields) > 1) {
+		rss = (gsize) g_ascii_strtoull (fields[1], NULL, 10) * sysconf (_SC_PAGESIZE);
+	}
+
+	g_strfreev (fields);
+	g_free (contents);
+
+	return rss;
+}
+
+static void
+test_file_system_perf (TestCommonContext *fixture,
+                       gconstpointer      data)
+{
+	GFile *dir, *file, *canonical_dir;
+	const gchar *n_files_env;
+	gsize rss_before, rss_after;
+	gint n_files, i;
+	GTimer *timer;
+	gchar *uri;
+
+	n_files_env = g_getenv ("TRACKER_FILE_SYSTEM_PERF_FILES");
+	n_files = n_files_env ? atoi (n_files_env) : PERF_N_FILES;
+
+	rss_before = perf_get_rss ();
+	timer = g_timer_new ();
+	canonical_dir = NULL;
+
+	for (i = 0; i < n_files; i++) {
+		if (i % PERF_FILES_PER_DIR == 0) {
+			uri = g_strdup_printf ("file:///perf/dir%d", i / PERF_FILES_PER_DIR);
+			dir = g_file_new_for_uri (uri);
+			canonical_dir = tracker_file_system_get_file (fixture->file_system, dir,
+			                                              G_FILE_TYPE_DIRECTORY, NULL);
+			g_object_unref (dir);
+			g_free (uri);
+		}
+
+		uri = g_strdup_printf ("file:///perf/dir%d/file%d",
+		                       i / PERF_FILES_PER_DIR, i);
+		file = g_file_new_for_uri (uri);
+		g_assert (tracker_file_system_get_file (fixture->file_system, file,
+		                                        G_FILE_TYPE_REGULAR,
+		                                        canonical_dir) != NULL);
+		g_object_unref (file);
+		g_free (uri);
+	}
+
+	rss_after = perf_get_rss ();
+
+	g_test_minimized_result (g_timer_elapsed (timer, NULL),
+	                         "Inserting %d files: %f secs",
+	                         n_files, g_timer_elapsed (timer, NULL));
+
+	if (rss_before > 0 && rss_after > rss_before) {
+		g_test_minimized_result ((gdouble) (rss_after - rss_before) / n_files,
+		                         "Memory per file: %.1f bytes",
+		                         (gdouble) (rss_after - rss_before) / n_files);
+	}
+
+	g_timer_destroy (timer);
+}
+
 gint
 main (gint    argc,
       gchar **argv)
@@ -250,5 +330,10 @@ main (gint    argc,
 	test_add ("/libtracker-miner/file-system/file-properties",
 	          test_file_system_properties);
 
+	if (g_test_perf ()) {
+		test_add ("/libtracker-miner/file-system/perf/insertions",
+		          test_file_system_perf);
+	}
+
 	return g_test_run ();
 }
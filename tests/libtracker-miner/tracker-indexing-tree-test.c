@@ -943,6 +943,93 @@ test_indexing_tree_030 (TestCommonContext *fixture,
 	ASSERT_INDEXABLE (fixture, TEST_DIRECTORY_ABA);
 }
 
+static gboolean
+file_matches_filter (TrackerIndexingTree *tree,
+                     TrackerFilterType    type,
+                     const gchar         *uri)
+{
+	gboolean matches;
+	GFile *file;
+
+	file = g_file_new_for_uri (uri);
+	matches = tracker_indexing_tree_file_matches_filter (tree, type, file);
+	g_object_unref (file);
+
+	return matches;
+}
+
+/* Literal, suffix, prefix and generic glob filters on basenames */
+static void
+test_indexing_tree_filter_globs (TestCommonContext *fixture,
+                                 gconstpointer      data)
+{
+	TrackerIndexingTree *tree = fixture->tree;
+
+	tracker_indexing_tree_add_filter (tree, TRACKER_FILTER_FILE, "core");
+	tracker_indexing_tree_add_filter (tree, TRACKER_FILTER_FILE, "*~");
+	tracker_indexing_tree_add_filter (tree, TRACKER_FILTER_FILE, "*.o");
+	tracker_indexing_tree_add_filter (tree, TRACKER_FILTER_FILE, "*.part");
+	tracker_indexing_tree_add_filter (tree, TRACKER_FILTER_FILE, ".#*");
+	tracker_indexing_tree_add_filter (tree, TRACKER_FILTER_FILE, "#*#");
+	tracker_indexing_tree_add_filter (tree, TRACKER_FILTER_FILE, "?.tmp");
+
+	g_assert (file_matches_filter (tree, TRACKER_FILTER_FILE, "file:///a/core"));
+	g_assert (!file_matches_filter (tree, TRACKER_FILTER_FILE, "file:///a/core2"));
+	g_assert (!file_matches_filter (tree, TRACKER_FILTER_FILE, "file:///core/a"));
+
+	g_assert (file_matches_filter (tree, TRACKER_FILTER_FILE, "file:///a/file.txt~"));
+	g_assert (file_matches_filter (tree, TRACKER_FILTER_FILE, "file:///a/main.o"));
+	g_assert (file_matches_filter (tree, TRACKER_FILTER_FILE, "file:///a/.o"));
+	g_assert (file_matches_filter (tree, TRACKER_FILTER_FILE, "file:///a/video.part"));
+	g_assert (!file_matches_filter (tree, TRACKER_FILTER_FILE, "file:///a/main.c"));
+	g_assert (!file_matches_filter (tree, TRACKER_FILTER_FILE, "file:///a/video.par"));
+
+	g_assert (file_matches_filter (tree, TRACKER_FILTER_FILE, "file:///a/.#lock"));
+	g_assert (!file_matches_filter (tree, TRACKER_FILTER_FILE, "file:///a/.lock"));
+
+	g_assert (file_matches_filter (tree, TRACKER_FILTER_FILE, "file:///a/#draft#"));
+	g_assert (!file_matches_filter (tree, TRACKER_FILTER_FILE, "file:///a/#draft"));
+	g_assert (file_matches_filter (tree, TRACKER_FILTER_FILE, "file:///a/x.tmp"));
+	g_assert (!file_matches_filter (tree, TRACKER_FILTER_FILE, "file:///a/xy.tmp"));
+
+	/* Filters only apply to their own type */
+	g_assert (!file_matches_filter (tree, TRACKER_FILTER_DIRECTORY, "file:///a/core"));
+
+	tracker_indexing_tree_clear_filters (tree, TRACKER_FILTER_FILE);
+	g_assert (!file_matches_filter (tree, TRACKER_FILTER_FILE, "file:///a/core"));
+	g_assert (!file_matches_filter (tree, TRACKER_FILTER_FILE, "file:///a/main.o"));
+
+	tracker_indexing_tree_add_filter (tree, TRACKER_FILTER_FILE, "*");
+	g_assert (file_matches_filter (tree, TRACKER_FILTER_FILE, "file:///a/core"));
+}
+
+/* Absolute path filters match the path and everything below it */
+static void
+test_indexing_tree_filter_paths (TestCommonContext *fixture,
+                                 gconstpointer      data)
+{
+	TrackerIndexingTree *tree = fixture->tree;
+
+	tracker_indexing_tree_add_filter (tree, TRACKER_FILTER_DIRECTORY, "/A/B/");
+	tracker_indexing_tree_add_filter (tree, TRACKER_FILTER_DIRECTORY, "/C");
+
+	g_assert (file_matches_filter (tree, TRACKER_FILTER_DIRECTORY, "file:///A/B"));
+	g_assert (file_matches_filter (tree, TRACKER_FILTER_DIRECTORY, "file:///A/B/A"));
+	g_assert (file_matches_filter (tree, TRACKER_FILTER_DIRECTORY, "file:///C/D/E"));
+	g_assert (!file_matches_filter (tree, TRACKER_FILTER_DIRECTORY, "file:///A"));
+	g_assert (!file_matches_filter (tree, TRACKER_FILTER_DIRECTORY, "file:///A/BB"));
+	g_assert (!file_matches_filter (tree, TRACKER_FILTER_DIRECTORY, "file:///CD"));
+
+	tracker_indexing_tree_add (tree,
+	                           fixture->test_dir[TEST_DIRECTORY_A],
+	                           TRACKER_DIRECTORY_FLAG_RECURSE);
+
+	ASSERT_INDEXABLE (fixture, TEST_DIRECTORY_A);
+	ASSERT_INDEXABLE (fixture, TEST_DIRECTORY_AAA);
+	ASSERT_NOT_INDEXABLE (fixture, TEST_DIRECTORY_AB);
+	ASSERT_NOT_INDEXABLE (fixture, TEST_DIRECTORY_ABA);
+}
+
 gint
 main (gint    argc,
       gchar **argv)
@@ -981,6 +1068,8 @@ main (gint    argc,
 	test_add ("/libtracker-miner/indexing-tree/028", test_indexing_tree_028);
 	test_add ("/libtracker-miner/indexing-tree/029", test_indexing_tree_029);
 	test_add ("/libtracker-miner/indexing-tree/030", test_indexing_tree_030);
+	test_add ("/libtracker-miner/indexing-tree/filter-globs", test_indexing_tree_filter_globs);
+	test_add ("/libtracker-miner/indexing-tree/filter-paths", test_indexing_tree_filter_paths);
 
 	return g_test_run ();
 }
@@ -17,8 +17,11 @@
  * 02110-1301, USA.
  */
 
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <time.h>
+#include <utime.h>
 
 #include <glib.h>
 #include <glib/gstdio.h>
@@ -30,6 +33,12 @@
 
 #define TEST_TIMEOUT 5 /* seconds */
 
+/* Number of files written in the file storm performance test,
+ * can be changed through the TRACKER_MONITOR_PERF_FILES envvar
+ */
+#define PERF_N_FILES          10000
+#define PERF_FILES_PER_BATCH  100
+
 typedef enum {
 	MONITOR_SIGNAL_NONE                   = 0,
 	MONITOR_SIGNAL_ITEM_CREATED           = 1 << 0,
@@ -1205,6 +1214,58 @@ test_monitor_file_event_blacklisting_attribute_updated_moved (TrackerMonitorTest
 	g_free (dest_path);
 }
 
+static void
+test_monitor_file_event_blacklisting_deleted_created (TrackerMonitorTestFixture *fixture,
+                                                      gconstpointer              data)
+{
+	GFile *test_file;
+	guint file_events;
+
+	/*
+	 * Event merging:
+	 *  DELETED + CREATED = UPDATED
+	 */
+
+	/* Create file to test with, before setting up environment */
+	set_file_contents (fixture->monitored_directory, "created.txt", "foo", &test_file);
+	g_assert (test_file != NULL);
+
+	/* Set up environment */
+	tracker_monitor_set_enabled (fixture->monitor, TRUE);
+
+	/* Remove the test file, and create it again */
+	g_assert_cmpint (g_file_delete (test_file, NULL, NULL), ==, TRUE);
+	set_file_contents (fixture->monitored_directory, "created.txt", "barrrr", NULL);
+
+	g_hash_table_insert (fixture->events,
+	                     g_object_ref (test_file),
+	                     GUINT_TO_POINTER (MONITOR_SIGNAL_NONE));
+
+	/* Wait for events */
+	events_wait (fixture);
+
+	/* Get events in the file */
+	file_events = GPOINTER_TO_UINT (g_hash_table_lookup (fixture->events, test_file));
+
+	/* Fail if we didn't get the UPDATED signal */
+	g_assert_cmpuint ((file_events & MONITOR_SIGNAL_ITEM_UPDATED), >, 0);
+
+	/* Fail if we got any other signal */
+	g_assert_cmpuint ((file_events & MONITOR_SIGNAL_ITEM_CREATED), ==, 0);
+	g_assert_cmpuint ((file_events & MONITOR_SIGNAL_ITEM_ATTRIBUTE_UPDATED), ==, 0);
+	g_assert_cmpuint ((file_events & MONITOR_SIGNAL_ITEM_MOVED_FROM), ==, 0);
+	g_assert_cmpuint ((file_events & MONITOR_SIGNAL_ITEM_MOVED_TO), ==, 0);
+	g_assert_cmpuint ((file_events & MONITOR_SIGNAL_ITEM_DELETED), ==, 0);
+	g_assert_cmpuint (tracker_monitor_get_folded_events (fixture->monitor), >, 0);
+
+	/* Cleanup environment */
+	tracker_monitor_set_enabled (fixture->monitor, FALSE);
+
+	/* Remove the test file */
+	g_assert_cmpint (g_file_delete (test_file, NULL, NULL), ==, TRUE);
+	g_object_unref (test_file);
+}
+
 /* ----------------------------- DIRECTORY EVENT TESTS --------------------------------- */
 
 static void
@@ -1790,6 +1851,71 @@ test_monitor_directory_event_moved_from_not_monitored (TrackerMonitorTestFixture
 	g_free (dest_path);
 }
 
+static void
+test_monitor_directory_event_deleted_with_contents (TrackerMonitorTestFixture *fixture,
+                                                    gconstpointer              data)
+{
+	GFile *source_dir;
+	GFile *file_in_source_dir;
+	gchar *source_path;
+	guint file_events;
+
+	/*
+	 * Event merging:
+	 *  DELETED (A/file) + DELETED (A) = DELETED (A)
+	 */
+
+	/* Create directory to test with in a monitored place,
+	 * before setting up the environment */
+	create_directory (fixture->monitored_directory, "foo", &source_dir);
+	source_path = g_file_get_path (source_dir);
+	g_assert (source_dir != NULL);
+
+	set_file_contents (source_path, "lalala.txt", "whatever", &file_in_source_dir);
+	g_assert (file_in_source_dir != NULL);
+
+	/* Set to monitor the new dir also */
+	g_assert_cmpint (tracker_monitor_add (fixture->monitor, source_dir), ==, TRUE);
+
+	/* Set up environment */
+	tracker_monitor_set_enabled (fixture->monitor, TRUE);
+
+	/* Now, delete the file and the directory */
+	g_assert_cmpint (g_file_delete (file_in_source_dir, NULL, NULL), ==, TRUE);
+	g_assert_cmpint (g_file_delete (source_dir, NULL, NULL), ==, TRUE);
+
+	g_hash_table_insert (fixture->events,
+	                     g_object_ref (source_dir),
+	                     GUINT_TO_POINTER (MONITOR_SIGNAL_NONE));
+	g_hash_table_insert (fixture->events,
+	                     g_object_ref (file_in_source_dir),
+	                     GUINT_TO_POINTER (MONITOR_SIGNAL_NONE));
+
+	/* Wait for events */
+	events_wait (fixture);
+
+	/* Get events in the source dir */
+	file_events = GPOINTER_TO_UINT (g_hash_table_lookup (fixture->events, source_dir));
+	/* Fail if we didn't get DELETED signal */
+	g_assert_cmpuint ((file_events & MONITOR_SIGNAL_ITEM_DELETED), >, 0);
+	/* Fail if we got a CREATEd, UPDATED, MOVED_FROM or MOVED_TO signal */
+	g_assert_cmpuint ((file_events & MONITOR_SIGNAL_ITEM_CREATED), ==, 0);
+	g_assert_cmpuint ((file_events & MONITOR_SIGNAL_ITEM_UPDATED), ==, 0);
+	g_assert_cmpuint ((file_events & MONITOR_SIGNAL_ITEM_ATTRIBUTE_UPDATED), ==, 0);
+	g_assert_cmpuint ((file_events & MONITOR_SIGNAL_ITEM_MOVED_FROM), ==, 0);
+	g_assert_cmpuint ((file_events & MONITOR_SIGNAL_ITEM_MOVED_TO), ==, 0);
+
+	/* Get events in the file, it should be merged in the directory DELETED */
+	file_events = GPOINTER_TO_UINT (g_hash_table_lookup (fixture->events, file_in_source_dir));
+	g_assert_cmpuint (file_events, ==, MONITOR_SIGNAL_NONE);
+
+	/* Cleanup environment */
+	tracker_monitor_set_enabled (fixture->monitor, FALSE);
+	g_object_unref (file_in_source_dir);
+	g_object_unref (source_dir);
+	g_free (source_path);
+}
+
 /* ----------------------------- BASIC API TESTS --------------------------------- */
 
 static void
@@ -1870,6 +1996,253 @@ test_monitor_basic (void)
 	g_object_unref (monitor);
 }
 
+/* ----------------------------- POLLING TESTS --------------------------------- */
+
+typedef struct {
+	GMainLoop *main_loop;
+	GList *rescanned;
+} PollTestData;
+
+static void
+poll_directory_rescan_cb (TrackerMonitor *monitor,
+                          GFile          *file,
+                          gpointer        user_data)
+{
+	PollTestData *data = user_data;
+
+	data->rescanned = g_list_prepend (data->rescanned, g_object_ref (file));
+	g_main_loop_quit (data->main_loop);
+}
+
+static GFile *
+poll_create_directory (const gchar *parent,
+                       const gchar *name)
+{
+	struct utimbuf times;
+	gchar *path;
+	GFile *file;
+
+	path = g_build_filename (parent, name, NULL);
+	g_assert_cmpint (g_mkdir (path, 00755), ==, 0);
+
+	/* Date it back, so a change is noticed even within
+	 * the same second it was created in.
+	 */
+	times.actime = times.modtime = time (NULL) - 3600;
+	g_assert_cmpint (g_utime (path, &times), ==, 0);
+
+	file = g_file_new_for_path (path);
+	g_free (path);
+
+	return file;
+}
+
+static void
+poll_assert_queue (TrackerMonitor *monitor,
+                   GFile          *expected[])
+{
+	GList *polled, *l;
+	gint i;
+
+	polled = tracker_monitor_get_polled (monitor);
+
+	for (l = polled, i = 0; l && expected[i]; l = l->next, i++) {
+		g_assert (g_file_equal (l->data, expected[i]));
+	}
+
+	g_assert (l == NULL);
+	g_assert (expected[i] == NULL);
+
+	g_list_free (polled);
+}
+
+static void
+test_monitor_polling (void)
+{
+	TrackerMonitor *monitor;
+	PollTestData data = { 0 };
+	GFile *root, *dirs[3];
+	GError *error = NULL;
+	gchar *path, *changed_path, *command;
+	guint timeout_id;
+	gint i;
+
+	path = g_dir_make_tmp ("tracker-monitor-poll-XXXXXX", &error);
+	g_assert_no_error (error);
+	root = g_file_new_for_path (path);
+
+	for (i = 0; i < 3; i++) {
+		gchar *name;
+
+		name = g_strdup_printf ("dir-%d", i);
+		dirs[i] = poll_create_directory (path, name);
+		g_free (name);
+	}
+
+	/* Only the first directory added gets a monitor */
+	g_setenv ("TRACKER_MONITOR_LIMIT", "1", TRUE);
+	g_setenv ("TRACKER_MONITOR_POLL_INTERVAL", "1", TRUE);
+	monitor = tracker_monitor_new ();
+	g_unsetenv ("TRACKER_MONITOR_LIMIT");
+	g_unsetenv ("TRACKER_MONITOR_POLL_INTERVAL");
+
+	g_signal_connect (monitor, "directory-rescan",
+	                  G_CALLBACK (poll_directory_rescan_cb), &data);
+
+	g_assert_cmpint (tracker_monitor_add (monitor, root), ==, TRUE);
+
+	for (i = 0; i < 3; i++) {
+		g_assert_cmpint (tracker_monitor_add (monitor, dirs[i]), ==, FALSE);
+		g_assert_cmpint (tracker_monitor_is_watched (monitor, dirs[i]), ==, FALSE);
+	}
+
+	g_assert_cmpint (tracker_monitor_get_count (monitor), ==, 1);
+	g_assert_cmpint (tracker_monitor_get_ignored (monitor), ==, 3);
+	poll_assert_queue (monitor, (GFile *[]) { dirs[0], dirs[1], dirs[2], NULL });
+
+	/* Change the directory in the middle of the queue */
+	changed_path = g_file_get_path (dirs[1]);
+	set_file_contents (changed_path, "foo.txt", "foo", NULL);
+	g_free (changed_path);
+
+	data.main_loop = g_main_loop_new (NULL, FALSE);
+	timeout_id = g_timeout_add_seconds (TEST_TIMEOUT, timeout_cb, data.main_loop);
+	g_main_loop_run (data.main_loop);
+
+	g_assert_cmpint (g_list_length (data.rescanned), ==, 1);
+	g_assert (g_file_equal (data.rescanned->data, dirs[1]));
+	g_source_remove (timeout_id);
+
+	/* It goes first from now on, the others keep their order */
+	poll_assert_queue (monitor, (GFile *[]) { dirs[1], dirs[0], dirs[2], NULL });
+
+	/* Freeing the only monitor hands it over to the head of the queue */
+	g_assert_cmpint (tracker_monitor_remove (monitor, root), ==, TRUE);
+	g_assert_cmpint (tracker_monitor_is_watched (monitor, dirs[1]), ==, TRUE);
+	g_assert_cmpint (tracker_monitor_get_count (monitor), ==, 1);
+	poll_assert_queue (monitor, (GFile *[]) { dirs[0], dirs[2], NULL });
+
+	/* Cleanup */
+	g_object_unref (monitor);
+	g_main_loop_unref (data.main_loop);
+	g_list_free_full (data.rescanned, g_object_unref);
+
+	for (i = 0; i < 3; i++) {
+		g_object_unref (dirs[i]);
+	}
+
+	g_object_unref (root);
+
+	command = g_strdup_printf ("rm -R %s", path);
+	g_spawn_command_line_sync (command, NULL, NULL, NULL, NULL);
+	g_free (command);
+	g_free (path);
+}
+
+/* ----------------------------- PERFORMANCE TESTS --------------------------------- */
+
+typedef struct {
+	GMainLoop *main_loop;
+	gchar *path;
+	gint n_files;
+	gint n_written;
+	gint n_created;
+} PerfStormData;
+
+static void
+perf_storm_created_cb (TrackerMonitor *monitor,
+                       GFile          *file,
+                       gboolean        is_directory,
+                       gpointer        user_data)
+{
+	PerfStormData *data = user_data;
+
+	data->n_created++;
+
+	if (data->n_created == data->n_files) {
+		g_main_loop_quit (data->main_loop);
+	}
+}
+
+static gboolean
+perf_storm_write_cb (gpointer user_data)
+{
+	PerfStormData *data = user_data;
+	gint i;
+
+	/* Write files in batches from the main loop, so events
+	 * are read while the storm goes on instead of overflowing
+	 * the kernel queue.
+	 */
+	for (i = 0; i < PERF_FILES_PER_BATCH && data->n_written < data->n_files; i++) {
+		gchar *filename;
+
+		filename = g_strdup_printf ("storm-%d.txt", data->n_written);
+		set_file_contents (data->path, filename, "foo", NULL);
+		g_free (filename);
+
+		data->n_written++;
+	}
+
+	return data->n_written < data->n_files;
+}
+
+static void
+test_monitor_perf_file_storm (gconstpointer user_data)
+{
+	TrackerMonitor *monitor;
+	PerfStormData data = { 0 };
+	const gchar *backend = user_data;
+	const gchar *n_files_env;
+	GError *error = NULL;
+	gchar *command;
+	GTimer *timer;
+	GFile *file;
+	gdouble elapsed;
+
+	n_files_env = g_getenv ("TRACKER_MONITOR_PERF_FILES");
+	data.n_files = n_files_env ? atoi (n_files_env) : PERF_N_FILES;
+
+	data.path = g_dir_make_tmp ("tracker-monitor-perf-XXXXXX", &error);
+	g_assert_no_error (error);
+
+	if (g_strcmp0 (backend, "gio") == 0) {
+		g_setenv ("TRACKER_USE_GIO_MONITORS", "1", TRUE);
+	}
+
+	monitor = tracker_monitor_new ();
+	g_unsetenv ("TRACKER_USE_GIO_MONITORS");
+
+	g_signal_connect (monitor, "item-created",
+	                  G_CALLBACK (perf_storm_created_cb), &data);
+
+	file = g_file_new_for_path (data.path);
+	g_assert_cmpint (tracker_monitor_add (monitor, file), ==, TRUE);
+
+	data.main_loop = g_main_loop_new (NULL, FALSE);
+
+	timer = g_timer_new ();
+	g_idle_add (perf_storm_write_cb, &data);
+	g_main_loop_run (data.main_loop);
+	elapsed = g_timer_elapsed (timer, NULL);
+
+	g_assert_cmpint (data.n_created, ==, data.n_files);
+
+	g_test_maximized_result (data.n_files / elapsed,
+	                         "Monitoring %d created files (%s): %f files/sec",
+	                         data.n_files, backend, data.n_files / elapsed);
+
+	g_timer_destroy (timer);
+	g_main_loop_unref (data.main_loop);
+	g_object_unref (monitor);
+	g_object_unref (file);
+
+	command = g_strdup_printf ("rm -R %s", data.path);
+	g_spawn_command_line_sync (command, NULL, NULL, NULL, NULL);
+	g_free (command);
+	g_free (data.path);
+}
+
 gint
 main (gint    argc,
       gchar **argv)
@@ -1882,6 +2255,10 @@ main (gint    argc,
 	g_test_add_func ("/libtracker-miner/tracker-monitor/basic",
 	                 test_monitor_basic);
 
+	/* Polling fallback tests */
+	g_test_add_func ("/libtracker-miner/tracker-monitor/polling",
+	                 test_monitor_polling);
+
 	/* File Event tests */
 	g_test_add ("/libtracker-miner/tracker-monitor/file-event/created",
 	            TrackerMonitorTestFixture,
@@ -1969,6 +2346,12 @@ main (gint    argc,
 	            test_monitor_common_setup,
 	            test_monitor_file_event_blacklisting_attribute_updated_moved,
 	            test_monitor_common_teardown);
+	g_test_add ("/libtracker-miner/tracker-monitor/file-event/blacklisting/deleted-created",
+	            TrackerMonitorTestFixture,
+	            NULL,
+	            test_monitor_common_setup,
+	            test_monitor_file_event_blacklisting_deleted_created,
+	            test_monitor_common_teardown);
 
 	/* Directory Event tests */
 	g_test_add ("/libtracker-miner/tracker-monitor/directory-event/created",
@@ -1983,6 +2366,12 @@ main (gint    argc,
 	            test_monitor_common_setup,
 	            test_monitor_directory_event_deleted,
 	            test_monitor_common_teardown);
+	g_test_add ("/libtracker-miner/tracker-monitor/directory-event/deleted-with-contents",
+	            TrackerMonitorTestFixture,
+	            NULL,
+	            test_monitor_common_setup,
+	            test_monitor_directory_event_deleted_with_contents,
+	            test_monitor_common_teardown);
 	g_test_add ("/libtracker-miner/tracker-monitor/directory-event/moved/to-monitored",
 	            TrackerMonitorTestFixture,
 	            NULL,
@@ -2014,5 +2403,14 @@ main (gint    argc,
 		    test_monitor_directory_event_moved_from_not_monitored,
 	            test_monitor_common_teardown);
 
+	if (g_test_perf ()) {
+		g_test_add_data_func ("/libtracker-miner/tracker-monitor/perf/file-storm",
+		                      "native",
+		                      test_monitor_perf_file_storm);
+		g_test_add_data_func ("/libtracker-miner/tracker-monitor/perf/file-storm-gio",
+		                      "gio",
+		                      test_monitor_perf_file_storm);
+	}
+
 	return g_test_run ();
 }
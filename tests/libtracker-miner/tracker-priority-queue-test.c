@@ -17,6 +17,8 @@
  * 02110-1301, USA.
  */
 
+#include <stdlib.h>
+
 #include <glib-object.h>
 
 /* NOTE: We're not including tracker-miner.h here because this is private. */
@@ -224,6 +226,184 @@ test_priority_queue_branches (void)
         tracker_priority_queue_unref (queue);
 }
 
+static void
+test_priority_queue_indexed (void)
+{
+        TrackerPriorityQueue *queue;
+        gchar                *result;
+        gint                  priority;
+
+        queue = tracker_priority_queue_new_indexed (g_str_hash, g_str_equal, NULL);
+
+        tracker_priority_queue_add (queue, g_strdup ("x"), 10);
+        tracker_priority_queue_add (queue, g_strdup ("y"), 5);
+        tracker_priority_queue_add (queue, g_strdup ("x"), 1);
+
+        result = tracker_priority_queue_lookup (queue, "x", &priority);
+        g_assert_cmpstr (result, ==, "x");
+        g_assert_cmpint (priority, ==, 10);
+        g_assert (tracker_priority_queue_lookup (queue, "z", NULL) == NULL);
+
+        /* Popping keeps the index in sync */
+        result = tracker_priority_queue_pop (queue, &priority);
+        g_assert_cmpstr (result, ==, "x");
+        g_assert_cmpint (priority, ==, 1);
+        g_free (result);
+
+        g_assert (tracker_priority_queue_lookup (queue, "x", &priority) != NULL);
+        g_assert_cmpint (priority, ==, 10);
+
+        tracker_priority_queue_foreach_remove (queue, g_str_equal, "x", g_free);
+        g_assert (tracker_priority_queue_lookup (queue, "x", NULL) == NULL);
+        g_assert (tracker_priority_queue_lookup (queue, "y", NULL) != NULL);
+
+        tracker_priority_queue_foreach (queue, (GFunc) g_free, NULL);
+        tracker_priority_queue_unref (queue);
+}
+
+static void
+test_priority_queue_indexed_remove_all (void)
+{
+        TrackerPriorityQueue *queue;
+        gchar                *result;
+
+        queue = tracker_priority_queue_new_indexed (g_str_hash, g_str_equal, NULL);
+
+        tracker_priority_queue_add (queue, g_strdup ("y"), 1);
+        tracker_priority_queue_add (queue, g_strdup ("x"), 2);
+        tracker_priority_queue_add (queue, g_strdup ("y"), 3);
+        tracker_priority_queue_add (queue, g_strdup ("x"), 4);
+        tracker_priority_queue_add (queue, g_strdup ("y"), 5);
+
+        g_assert (tracker_priority_queue_remove_all (queue, "y", g_free));
+        g_assert (!tracker_priority_queue_remove_all (queue, "y", g_free));
+        g_assert_cmpint (tracker_priority_queue_get_length (queue), ==, 2);
+
+        result = tracker_priority_queue_pop (queue, NULL);
+        g_assert_cmpstr (result, ==, "x");
+        g_free (result);
+
+        g_assert (tracker_priority_queue_remove_all (queue, "x", g_free));
+        g_assert (tracker_priority_queue_is_empty (queue));
+
+        tracker_priority_queue_unref (queue);
+}
+
+static gpointer
+pair_get_key (gchar **pair)
+{
+        return pair[0];
+}
+
+static void
+test_priority_queue_indexed_replace (void)
+{
+        TrackerPriorityQueue *queue;
+        gchar                *first[] = { "a", "1" };
+        gchar                *second[] = { "b", "2" };
+        gchar                *third[] = { "c", "3" };
+        gchar               **result;
+        GList                *node;
+        gint                  priority;
+
+        queue = tracker_priority_queue_new_indexed (g_str_hash, g_str_equal,
+                                                    (TrackerPriorityQueueKeyFunc) pair_get_key);
+
+        tracker_priority_queue_add (queue, first, 1);
+        tracker_priority_queue_add (queue, second, 2);
+
+        node = tracker_priority_queue_lookup_node (queue, "b", &priority);
+        g_assert (node != NULL);
+        g_assert_cmpint (priority, ==, 2);
+
+        result = tracker_priority_queue_replace_data (queue, node, third);
+        g_assert (result == second);
+
+        g_assert (tracker_priority_queue_lookup (queue, "b", NULL) == NULL);
+        g_assert (tracker_priority_queue_lookup (queue, "c", &priority) == third);
+        g_assert_cmpint (priority, ==, 2);
+
+        /* Position in the queue is kept */
+        g_assert (tracker_priority_queue_pop (queue, NULL) == first);
+        g_assert (tracker_priority_queue_pop (queue, NULL) == third);
+        g_assert (tracker_priority_queue_lookup (queue, "c", NULL) == NULL);
+
+        tracker_priority_queue_unref (queue);
+}
+
+#define PERF_N_ITEMS 1000000
+#define PERF_N_LOOKUPS 100
+
+static void
+test_priority_queue_perf_lookup (void)
+{
+        TrackerPriorityQueue *plain, *indexed;
+        const gchar          *n_items_env;
+        GTimer               *timer;
+        gdouble               find_elapsed, lookup_elapsed;
+        gchar               **keys;
+        gint                  n_items, i;
+
+        n_items_env = g_getenv ("TRACKER_PRIORITY_QUEUE_PERF_ITEMS");
+        n_items = n_items_env ? atoi (n_items_env) : PERF_N_ITEMS;
+        g_assert_cmpint (n_items, >, 0);
+
+        keys = g_new (gchar *, n_items);
+        plain = tracker_priority_queue_new ();
+        indexed = tracker_priority_queue_new_indexed (g_str_hash, g_str_equal, NULL);
+
+        for (i = 0; i < n_items; i++) {
+                keys[i] = g_strdup_printf ("file:///tmp/perf/file%d", i);
+                tracker_priority_queue_add (plain, keys[i], i % 4);
+                tracker_priority_queue_add (indexed, keys[i], i % 4);
+        }
+
+        /* Look up the elements at the back of the queue, the
+         * worst case for a linear search.
+         */
+        timer = g_timer_new ();
+
+        for (i = 0; i < PERF_N_LOOKUPS; i++) {
+                g_assert (tracker_priority_queue_find (plain, NULL, g_str_equal,
+                                                       keys[n_items - 1 - (i % n_items)]));
+        }
+
+        find_elapsed = g_timer_elapsed (timer, NULL);
+        g_timer_start (timer);
+
+        for (i = 0; i < PERF_N_LOOKUPS; i++) {
+                g_assert (tracker_priority_queue_lookup (indexed,
+                                                         keys[n_items - 1 - (i % n_items)],
+                                                         NULL));
+        }
+
+        lookup_elapsed = g_timer_elapsed (timer, NULL);
+
+        g_test_message ("Linear find of %d items in a %d items queue: %f secs",
+                        PERF_N_LOOKUPS, n_items, find_elapsed);
+        g_test_minimized_result (lookup_elapsed,
+                                 "Indexed lookup of %d items in a %d items queue: %f secs",
+                                 PERF_N_LOOKUPS, n_items, lookup_elapsed);
+
+        /* Removal through the index */
+        g_timer_start (timer);
+
+        for (i = 0; i < n_items; i++) {
+                g_assert (tracker_priority_queue_remove_all (indexed, keys[i], NULL));
+        }
+
+        g_test_minimized_result (g_timer_elapsed (timer, NULL),
+                                 "Indexed removal of %d items: %f secs",
+                                 n_items, g_timer_elapsed (timer, NULL));
+        g_assert (tracker_priority_queue_is_empty (indexed));
+
+        g_timer_destroy (timer);
+        tracker_priority_queue_unref (indexed);
+        tracker_priority_queue_foreach (plain, (GFunc) g_free, NULL);
+        tracker_priority_queue_unref (plain);
+        g_free (keys);
+}
+
 int
 main (int    argc,
       char **argv)
@@ -248,5 +428,17 @@ main (int    argc,
         g_test_add_func ("/libtracker-miner/tracker-priority-queue/branches",
                          test_priority_queue_branches);
 
+	g_test_add_func ("/libtracker-miner/tracker-priority-queue/indexed",
+	                 test_priority_queue_indexed);
+	g_test_add_func ("/libtracker-miner/tracker-priority-queue/indexed_remove_all",
+	                 test_priority_queue_indexed_remove_all);
+	g_test_add_func ("/libtracker-miner/tracker-priority-queue/indexed_replace",
+	                 test_priority_queue_indexed_replace);
+
+	if (g_test_perf ()) {
+		g_test_add_func ("/libtracker-miner/tracker-priority-queue/perf/lookup",
+		                 test_priority_queue_perf_lookup);
+	}
+
 	return g_test_run ();
 }
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include <string.h>
+
+#include <glib.h>
+
+/* NOTE: We're not including tracker-miner.h here because this is private. */
+#include <libtracker-miner/tracker-sparql-buffer.h>
+
+#include "tracker-miner-mock.h"
+
+#define BUFFER_LIMIT 64
+
+typedef struct {
+	TrackerMockConnection *connection;
+	TrackerSparqlBuffer *buffer;
+	GMainLoop *main_loop;
+	guint n_pending;
+	guint n_pushed;
+} BufferTestData;
+
+static gboolean
+ignore_buffer_criticals (const gchar    *log_domain,
+                         GLogLevelFlags  log_level,
+                         const gchar    *message,
+                         gpointer        user_data)
+{
+	/* Failed updates are reported as criticals */
+	return strstr (message, "(Sparql buffer)") == NULL;
+}
+
+static void
+task_finished_cb (GObject      *object,
+                  GAsyncResult *result,
+                  gpointer      user_data)
+{
+	BufferTestData *data = user_data;
+
+	data->n_pending--;
+
+	if (data->n_pending == 0) {
+		g_main_loop_quit (data->main_loop);
+	}
+}
+
+/* Pushes tasks until a batch is flushed, then waits for it */
+static guint
+flush_batch (BufferTestData *data)
+{
+	guint batch_size, i;
+
+	batch_size = tracker_sparql_buffer_get_batch_size (data->buffer);
+	data->n_pending = batch_size;
+
+	for (i = 0; i < batch_size; i++) {
+		TrackerTask *task;
+		GFile *file;
+		gchar *uri;
+
+		uri = g_strdup_printf ("file:///sparql-buffer-test/%u", data->n_pushed++);
+		file = g_file_new_for_uri (uri);
+		task = tracker_sparql_task_new_with_sparql_str (file, "INSERT { <urn:test> a rdfs:Resource }");
+		tracker_sparql_buffer_push (data->buffer, task, G_PRIORITY_DEFAULT,
+		                            task_finished_cb, data);
+		g_object_unref (file);
+		g_free (uri);
+	}
+
+	g_main_loop_run (data->main_loop);
+
+	return tracker_sparql_buffer_get_batch_size (data->buffer);
+}
+
+static void
+buffer_test_data_init (BufferTestData *data)
+{
+	data->connection = tracker_mock_connection_new ();
+	data->buffer = tracker_sparql_buffer_new (TRACKER_SPARQL_CONNECTION (data->connection),
+	                                          BUFFER_LIMIT);
+	data->main_loop = g_main_loop_new (NULL, FALSE);
+	data->n_pending = 0;
+	data->n_pushed = 0;
+}
+
+static void
+buffer_test_data_clear (BufferTestData *data)
+{
+	g_main_loop_unref (data->main_loop);
+	g_object_unref (data->buffer);
+	g_object_unref (data->connection);
+}
+
+static void
+test_sparql_buffer_batch_size_grow (void)
+{
+	BufferTestData data;
+	guint batch_size, prev;
+
+	buffer_test_data_init (&data);
+
+	/* Starts off at half the limit */
+	batch_size = tracker_sparql_buffer_get_batch_size (data.buffer);
+	g_assert_cmpuint (batch_size, ==, BUFFER_LIMIT / 2);
+
+	/* Grows with each quick full batch, up to the limit */
+	do {
+		prev = batch_size;
+		batch_size = flush_batch (&data);
+
+		if (prev < BUFFER_LIMIT) {
+			g_assert_cmpuint (batch_size, >, prev);
+		}
+
+		g_assert_cmpuint (batch_size, <=, BUFFER_LIMIT);
+	} while (prev < BUFFER_LIMIT);
+
+	g_assert_cmpuint (batch_size, ==, BUFFER_LIMIT);
+
+	buffer_test_data_clear (&data);
+}
+
+static void
+test_sparql_buffer_batch_size_shrink (void)
+{
+	BufferTestData data;
+	guint batch_size, prev;
+
+	buffer_test_data_init (&data);
+
+	/* Halves on each failed batch, down to a single task */
+	tracker_mock_connection_set_fail_updates (data.connection, TRUE);
+	batch_size = tracker_sparql_buffer_get_batch_size (data.buffer);
+
+	do {
+		prev = batch_size;
+		batch_size = flush_batch (&data);
+		g_assert_cmpuint (batch_size, ==, MAX (prev / 2, 1));
+	} while (prev > 1);
+
+	g_assert_cmpuint (batch_size, ==, 1);
+
+	/* And grows back once updates succeed */
+	tracker_mock_connection_set_fail_updates (data.connection, FALSE);
+	batch_size = flush_batch (&data);
+	g_assert_cmpuint (batch_size, ==, 2);
+
+	buffer_test_data_clear (&data);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+	g_test_init (&argc, &argv, NULL);
+	g_test_log_set_fatal_handler (ignore_buffer_criticals, NULL);
+
+	g_test_message ("Testing SPARQL buffer");
+
+	g_test_add_func ("/libtracker-miner/tracker-sparql-buffer/batch-size-grow",
+	                 test_sparql_buffer_batch_size_grow);
+	g_test_add_func ("/libtracker-miner/tracker-sparql-buffer/batch-size-shrink",
+	                 test_sparql_buffer_batch_size_shrink);
+
+	return g_test_run ();
+}
@@ -364,6 +364,76 @@ test_tracker_sparql_update_array_async (void)
 
 }
 
+static void
+async_update_statements_callback (GObject      *source_object,
+                                  GAsyncResult *result,
+                                  gpointer      user_data)
+{
+	AsyncData *data = user_data;
+	TrackerSparqlCursor *cursor;
+	GError *error = NULL;
+	gint n_titles = 0;
+
+	g_main_loop_quit (data->main_loop);
+
+	tracker_sparql_connection_update_statements_finish (connection, result, &error);
+	g_assert_no_error (error);
+
+	cursor = tracker_sparql_connection_query (connection,
+	                                          "SELECT ?t WHERE { <urn:statements:1> nie:title ?t }",
+	                                          NULL, &error);
+	g_assert_no_error (error);
+
+	while (tracker_sparql_cursor_next (cursor, NULL, NULL)) {
+		g_assert_cmpstr (tracker_sparql_cursor_get_string (cursor, 0, NULL), ==, "statements");
+		n_titles++;
+	}
+
+	g_assert_cmpint (n_titles, ==, 1);
+	g_object_unref (cursor);
+
+	tracker_sparql_connection_update (connection, "DELETE { <urn:statements:1> a rdfs:Resource }",
+	                                  0, NULL, &error);
+	g_assert_no_error (error);
+}
+
+static void
+test_tracker_sparql_update_statements_async (void)
+{
+	TrackerSparqlStatements *statements;
+	GMainLoop *main_loop;
+	AsyncData *data;
+
+	main_loop = g_main_loop_new (NULL, FALSE);
+
+	data = g_slice_new (AsyncData);
+	data->main_loop = main_loop;
+
+	statements = tracker_sparql_statements_new ();
+	tracker_sparql_statements_insert (statements, NULL, "urn:statements:1",
+	                                  "http://www.w3.org/1999/02/22-rdf-syntax-ns#type",
+	                                  "http://www.semanticdesktop.org/ontologies/2007/03/22/nmo#Message");
+	tracker_sparql_statements_insert (statements, NULL, "urn:statements:1",
+	                                  "http://www.semanticdesktop.org/ontologies/2007/01/19/nie#title",
+	                                  "statements");
+
+	tracker_sparql_connection_update_statements_async (connection,
+	                                                   statements,
+	                                                   0,
+	                                                   NULL,
+	                                                   async_update_statements_callback,
+	                                                   data);
+
+	g_main_loop_run (main_loop);
+
+	/* Emptied once sent, ready for the next batch */
+	g_assert_cmpint (tracker_sparql_statements_get_length (statements), ==, 0);
+
+	g_object_unref (statements);
+	g_slice_free (AsyncData, data);
+	g_main_loop_unref (main_loop);
+}
+
 static void
 test_tracker_sparql_update_fast_error ()
 {
@@ -519,6 +589,79 @@ test_tracker_sparql_query_iterate_async (void)
 	g_main_loop_unref (main_loop);
 }
 
+static void
+async_query_snapshot_cb (GObject      *source_object,
+                         GAsyncResult *result,
+                         gpointer      user_data)
+{
+	TrackerSparqlCursor *cursor_snapshot;
+	TrackerSparqlCursor *cursor_glib;
+	AsyncData *data = user_data;
+	GError *error = NULL;
+	gint n_snapshot = 0, n_glib = 0;
+
+	g_main_loop_quit (data->main_loop);
+
+	cursor_snapshot = tracker_sparql_connection_query_snapshot_finish (connection, result, &error);
+
+	g_assert_no_error (error);
+	g_assert (cursor_snapshot != NULL);
+
+	/* Changes after the snapshot was taken don't show in it */
+	tracker_sparql_connection_update (connection,
+	                                  "INSERT { <urn:snapshot:1> a nfo:FileDataObject ; nie:url 'file:///snapshot' }",
+	                                  0, NULL, &error);
+	g_assert_no_error (error);
+
+	cursor_glib = tracker_sparql_connection_query (connection, data->query, NULL, &error);
+
+	g_assert_no_error (error);
+	g_assert (cursor_glib != NULL);
+
+	while (tracker_sparql_cursor_next (cursor_snapshot, NULL, NULL)) {
+		g_assert_cmpstr (tracker_sparql_cursor_get_string (cursor_snapshot, 1, NULL), !=, "file:///snapshot");
+		n_snapshot++;
+	}
+
+	while (tracker_sparql_cursor_next (cursor_glib, NULL, NULL)) {
+		n_glib++;
+	}
+
+	g_assert_cmpint (n_glib, ==, n_snapshot + 1);
+
+	g_object_unref (cursor_snapshot);
+	g_object_unref (cursor_glib);
+
+	tracker_sparql_connection_update (connection, "DELETE { <urn:snapshot:1> a rdfs:Resource }",
+	                                  0, NULL, &error);
+	g_assert_no_error (error);
+}
+
+static void
+test_tracker_sparql_query_snapshot_async (void)
+{
+	const gchar *query = "SELECT ?r nie:url(?r) WHERE {?r a nfo:FileDataObject}";
+	GMainLoop *main_loop;
+	AsyncData *data;
+
+	main_loop = g_main_loop_new (NULL, FALSE);
+
+	data = g_slice_new (AsyncData);
+	data->main_loop = main_loop;
+	data->query = query;
+
+	tracker_sparql_connection_query_snapshot_async (connection,
+	                                                query,
+	                                                NULL,
+	                                                async_query_snapshot_cb,
+	                                                data);
+
+	g_main_loop_run (main_loop);
+
+	g_slice_free (AsyncData, data);
+	g_main_loop_unref (main_loop);
+}
+
 static void
 cancel_query_cb (GObject      *source_object,
                  GAsyncResult *result,
@@ -705,10 +848,12 @@ main (gint argc, gchar **argv)
 	g_test_add_func ("/steroids/tracker/tracker_batch_sparql_update_fast", test_tracker_batch_sparql_update_fast);
 	g_test_add_func ("/steroids/tracker/tracker_sparql_query_iterate_async", test_tracker_sparql_query_iterate_async);
 	g_test_add_func ("/steroids/tracker/tracker_sparql_query_iterate_async_cancel", test_tracker_sparql_query_iterate_async_cancel);
+	g_test_add_func ("/steroids/tracker/tracker_sparql_query_snapshot_async", test_tracker_sparql_query_snapshot_async);
 	g_test_add_func ("/steroids/tracker/tracker_sparql_update_async", test_tracker_sparql_update_async);
 	g_test_add_func ("/steroids/tracker/tracker_sparql_update_async_cancel", test_tracker_sparql_update_async_cancel);
 	g_test_add_func ("/steroids/tracker/tracker_sparql_update_blank_async", test_tracker_sparql_update_blank_async);
 	g_test_add_func ("/steroids/tracker/tracker_sparql_update_array_async", test_tracker_sparql_update_array_async);
+	g_test_add_func ("/steroids/tracker/tracker_sparql_update_statements_async", test_tracker_sparql_update_statements_async);
 
 	return g_test_run ();
 }
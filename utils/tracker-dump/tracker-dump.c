@@ -0,0 +1,976 @@
+/*
+ * Copyright (C) 2026, agent <agent@local>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <locale.h>
+
+#include <glib.h>
+#include <glib/gi18n.h>
+
+#include <libtracker-common/tracker-date-time.h>
+#include <libtracker-data/tracker-data.h>
+
+/* Dumps all triples of the store reading the class tables directly,
+ * one property table or column per job, as N-Triples or in a binary
+ * format meant to be mapped and imported back quickly.
+ *
+ * The binary format is a sequence of host endian guint32s, following
+ * the "TRKDUMP1" magic:
+ *
+ *   DUMP_RECORD_RESOURCE, id, length, URI
+ *   DUMP_RECORD_URI, graph id, subject id, predicate id, object id
+ *   DUMP_RECORD_LITERAL, graph id, subject id, predicate id, length, value
+ *
+ * Strings are NUL terminated, the length includes the NUL, and they
+ * are padded to a multiple of 4 bytes so records stay aligned. All
+ * resources are defined before the first triple, graph id 0 stands
+ * for the default graph.
+ *
+ * Each job reads through its own connection, thus its own snapshot of
+ * the store. Dumps are only consistent if tracker-store is not running,
+ * otherwise tables may be read at different points in time.
+ */
+
+#define DUMP_MAGIC "TRKDUMP1"
+
+/* Size of the pieces of output handed from the jobs to the writer */
+#define CHUNK_SIZE (64 * 1024)
+
+/* Chunks a job may have waiting for the writer before it blocks */
+#define MAX_QUEUED_CHUNKS 4
+
+/* Triples inserted per transaction on import */
+#define IMPORT_BATCH_SIZE 10000
+
+#define XSD_PREFIX "http://www.w3.org/2001/XMLSchema#"
+
+typedef enum {
+	DUMP_RECORD_RESOURCE = 1,
+	DUMP_RECORD_URI,
+	DUMP_RECORD_LITERAL
+} DumpRecordType;
+
+typedef struct {
+	/* NULL for the resource definitions */
+	TrackerProperty *property;
+
+	/* GBytes chunks, an empty one ends the job */
+	GAsyncQueue *chunks;
+	GByteArray *buffer;
+
+	/* Chunks pushed and not yet written */
+	guint n_queued;
+	GMutex mutex;
+	GCond cond;
+
+	guint64 n_triples;
+	GError *error;
+} DumpJob;
+
+static gchar *output;
+static gchar *format;
+static gchar **classes;
+static gchar *graph;
+static gint jobs;
+static gchar *import;
+
+static gboolean binary;
+static gint graph_id;
+static gchar *subject_filter;
+
+static GPrivate worker_iface = G_PRIVATE_INIT (g_object_unref);
+
+static GOptionEntry entries[] = {
+	{ "output", 'o', 0, G_OPTION_ARG_FILENAME, &output,
+	  "File to dump to, standard output by default",
+	  "FILE",
+	},
+	{ "format", 'f', 0, G_OPTION_ARG_STRING, &format,
+	  "Dump format, \"ntriples\" (default) or \"binary\". Graphs are only kept in the binary format",
+	  "FORMAT",
+	},
+	{ "class", 'c', 0, G_OPTION_ARG_STRING_ARRAY, &classes,
+	  "Only dump instances of CLASS, may be given more than once",
+	  "CLASS",
+	},
+	{ "graph", 'g', 0, G_OPTION_ARG_STRING, &graph,
+	  "Only dump triples in GRAPH",
+	  "GRAPH",
+	},
+	{ "jobs", 'j', 0, G_OPTION_ARG_INT, &jobs,
+	  "Number of tables read in parallel, the number of processors by default. "
+	  "Tables are read in separate snapshots, tracker-store should not be running",
+	  "N",
+	},
+	{ "import", 'i', 0, G_OPTION_ARG_FILENAME, &import,
+	  "Import a binary dump, tracker-store must not be running",
+	  "FILE",
+	},
+	{ NULL }
+};
+
+static void
+put_uint32 (GByteArray *buffer,
+            guint32     value)
+{
+	g_byte_array_append (buffer, (const guint8 *) &value, sizeof (value));
+}
+
+static void
+put_string (GByteArray  *buffer,
+            const gchar *str)
+{
+	static const guint8 padding[4] = { 0 };
+	guint32 len;
+
+	len = strlen (str) + 1;
+	put_uint32 (buffer, len);
+	g_byte_array_append (buffer, (const guint8 *) str, len);
+	g_byte_array_append (buffer, padding, (4 - len % 4) % 4);
+}
+
+static void
+put_text (GByteArray  *buffer,
+          const gchar *str)
+{
+	g_byte_array_append (buffer, (const guint8 *) str, strlen (str));
+}
+
+static void
+put_iri (GByteArray  *buffer,
+         const gchar *iri)
+{
+	put_text (buffer, "<");
+	put_text (buffer, iri);
+	put_text (buffer, ">");
+}
+
+static void
+put_literal (GByteArray  *buffer,
+             const gchar *value,
+             const gchar *datatype)
+{
+	const gchar *p;
+
+	put_text (buffer, "\"");
+
+	for (p = value; *p; p++) {
+		switch (*p) {
+		case '"':
+			put_text (buffer, "\\\"");
+			break;
+		case '\\':
+			put_text (buffer, "\\\\");
+			break;
+		case '\n':
+			put_text (buffer, "\\n");
+			break;
+		case '\r':
+			put_text (buffer, "\\r");
+			break;
+		case '\t':
+			put_text (buffer, "\\t");
+			break;
+		default:
+			g_byte_array_append (buffer, (const guint8 *) p, 1);
+			break;
+		}
+	}
+
+	put_text (buffer, "\"");
+
+	if (datatype) {
+		put_text (buffer, "^^<" XSD_PREFIX);
+		put_text (buffer, datatype);
+		put_text (buffer, ">");
+	}
+}
+
+static const gchar *
+literal_datatype (TrackerPropertyType type)
+{
+	switch (type) {
+	case TRACKER_PROPERTY_TYPE_BOOLEAN:
+		return "boolean";
+	case TRACKER_PROPERTY_TYPE_INTEGER:
+		return "integer";
+	case TRACKER_PROPERTY_TYPE_DOUBLE:
+		return "double";
+	case TRACKER_PROPERTY_TYPE_DATE:
+		return "date";
+	case TRACKER_PROPERTY_TYPE_DATETIME:
+		return "dateTime";
+	default:
+		return NULL;
+	}
+}
+
+/* Same format tracker_data_insert_statement_with_string() takes */
+static gchar *
+literal_to_string (TrackerDBCursor     *cursor,
+                   guint                column,
+                   TrackerPropertyType  type)
+{
+	gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+	gchar *str;
+
+	switch (type) {
+	case TRACKER_PROPERTY_TYPE_BOOLEAN:
+		return g_strdup (tracker_db_cursor_get_int (cursor, column) ? "true" : "false");
+	case TRACKER_PROPERTY_TYPE_INTEGER:
+		return g_strdup_printf ("%" G_GINT64_FORMAT, tracker_db_cursor_get_int (cursor, column));
+	case TRACKER_PROPERTY_TYPE_DOUBLE:
+		return g_strdup (g_ascii_dtostr (buf, sizeof (buf), tracker_db_cursor_get_double (cursor, column)));
+	case TRACKER_PROPERTY_TYPE_DATE:
+		str = tracker_date_to_string (tracker_db_cursor_get_double (cursor, column));
+		/* it's a date-only, cut off the time */
+		str[10] = '\0';
+		return str;
+	case TRACKER_PROPERTY_TYPE_DATETIME:
+		/* Local time is not kept, dates are dumped in UTC */
+		return tracker_date_to_string (tracker_db_cursor_get_double (cursor, column));
+	default:
+		return g_strdup (tracker_db_cursor_get_string (cursor, column, NULL));
+	}
+}
+
+/* Each thread of the pool reads through its own connection, the
+ * one of the data manager is shared in read-only mode.
+ */
+static TrackerDBInterface *
+get_worker_iface (GError **error)
+{
+	TrackerDBInterface *iface;
+
+	iface = g_private_get (&worker_iface);
+
+	if (!iface) {
+		iface = tracker_db_manager_new_ro_db_interface (error);
+		if (iface) {
+			g_private_set (&worker_iface, iface);
+		}
+	}
+
+	return iface;
+}
+
+static void
+dump_job_flush (DumpJob  *job,
+                gboolean  force)
+{
+	if (job->buffer->len == 0 ||
+	    (!force && job->buffer->len < CHUNK_SIZE)) {
+		return;
+	}
+
+	/* Wait for the writer, so slow output doesn't pile up in memory */
+	g_mutex_lock (&job->mutex);
+	while (job->n_queued >= MAX_QUEUED_CHUNKS) {
+		g_cond_wait (&job->cond, &job->mutex);
+	}
+	job->n_queued++;
+	g_mutex_unlock (&job->mutex);
+
+	g_async_queue_push (job->chunks, g_byte_array_free_to_bytes (job->buffer));
+	job->buffer = g_byte_array_sized_new (CHUNK_SIZE);
+}
+
+static void
+dump_job_chunk_written (DumpJob *job)
+{
+	g_mutex_lock (&job->mutex);
+	job->n_queued--;
+	g_cond_signal (&job->cond);
+	g_mutex_unlock (&job->mutex);
+}
+
+static TrackerDBCursor *
+dump_job_start_cursor (DumpJob  *job,
+                       GError  **error)
+{
+	TrackerDBInterface *iface;
+	TrackerDBStatement *stmt;
+	TrackerDBCursor *cursor;
+	const gchar *name, *table;
+	gchar *object, *graph_filter;
+
+	iface = get_worker_iface (error);
+	if (!iface) {
+		return NULL;
+	}
+
+	if (!job->property) {
+		stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_NONE, error,
+		                                              "SELECT ID, Uri FROM Resource");
+	} else {
+		name = tracker_property_get_name (job->property);
+		table = tracker_property_get_table_name (job->property);
+
+		if (graph_id != 0) {
+			graph_filter = g_strdup_printf (" AND \"%s:graph\" = %d", name, graph_id);
+		} else {
+			graph_filter = g_strdup ("");
+		}
+
+		if (binary) {
+			stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_NONE, error,
+			                                              "SELECT ID, \"%s\", \"%s:graph\" FROM \"%s\" "
+			                                              "WHERE \"%s\" IS NOT NULL%s%s",
+			                                              name, name, table,
+			                                              name, subject_filter, graph_filter);
+		} else {
+			if (tracker_property_get_data_type (job->property) == TRACKER_PROPERTY_TYPE_RESOURCE) {
+				object = g_strdup_printf ("(SELECT Uri FROM Resource WHERE ID = \"%s\")", name);
+			} else {
+				object = g_strdup_printf ("\"%s\"", name);
+			}
+
+			stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_NONE, error,
+			                                              "SELECT (SELECT Uri FROM Resource WHERE ID = \"%s\".ID), %s "
+			                                              "FROM \"%s\" WHERE \"%s\" IS NOT NULL%s%s",
+			                                              table, object, table,
+			                                              name, subject_filter, graph_filter);
+			g_free (object);
+		}
+
+		g_free (graph_filter);
+	}
+
+	if (!stmt) {
+		return NULL;
+	}
+
+	cursor = tracker_db_statement_start_cursor (stmt, error);
+	g_object_unref (stmt);
+
+	return cursor;
+}
+
+static void
+dump_job_run (DumpJob *job,
+              gpointer user_data)
+{
+	TrackerDBCursor *cursor;
+	TrackerPropertyType type = TRACKER_PROPERTY_TYPE_UNKNOWN;
+	const gchar *predicate = NULL, *datatype = NULL;
+	guint32 predicate_id = 0;
+	GError *error = NULL;
+
+	cursor = dump_job_start_cursor (job, &error);
+
+	if (job->property) {
+		type = tracker_property_get_data_type (job->property);
+		predicate = tracker_property_get_uri (job->property);
+		predicate_id = tracker_property_get_id (job->property);
+		datatype = literal_datatype (type);
+	}
+
+	while (cursor && tracker_db_cursor_iter_next (cursor, NULL, &error)) {
+		gchar *value;
+
+		if (!job->property) {
+			put_uint32 (job->buffer, DUMP_RECORD_RESOURCE);
+			put_uint32 (job->buffer, tracker_db_cursor_get_int (cursor, 0));
+			put_string (job->buffer, tracker_db_cursor_get_string (cursor, 1, NULL));
+		} else if (binary) {
+			if (type == TRACKER_PROPERTY_TYPE_RESOURCE) {
+				put_uint32 (job->buffer, DUMP_RECORD_URI);
+				put_uint32 (job->buffer, tracker_db_cursor_get_int (cursor, 2));
+				put_uint32 (job->buffer, tracker_db_cursor_get_int (cursor, 0));
+				put_uint32 (job->buffer, predicate_id);
+				put_uint32 (job->buffer, tracker_db_cursor_get_int (cursor, 1));
+			} else {
+				value = literal_to_string (cursor, 1, type);
+
+				put_uint32 (job->buffer, DUMP_RECORD_LITERAL);
+				put_uint32 (job->buffer, tracker_db_cursor_get_int (cursor, 2));
+				put_uint32 (job->buffer, tracker_db_cursor_get_int (cursor, 0));
+				put_uint32 (job->buffer, predicate_id);
+				put_string (job->buffer, value);
+				g_free (value);
+			}
+
+			job->n_triples++;
+		} else {
+			const gchar *subject;
+
+			subject = tracker_db_cursor_get_string (cursor, 0, NULL);
+
+			if (type == TRACKER_PROPERTY_TYPE_RESOURCE) {
+				const gchar *object;
+
+				object = tracker_db_cursor_get_string (cursor, 1, NULL);
+
+				if (!subject || !object) {
+					continue;
+				}
+
+				put_iri (job->buffer, subject);
+				put_text (job->buffer, " ");
+				put_iri (job->buffer, predicate);
+				put_text (job->buffer, " ");
+				put_iri (job->buffer, object);
+			} else {
+				if (!subject) {
+					continue;
+				}
+
+				value = literal_to_string (cursor, 1, type);
+
+				put_iri (job->buffer, subject);
+				put_text (job->buffer, " ");
+				put_iri (job->buffer, predicate);
+				put_text (job->buffer, " ");
+				put_literal (job->buffer, value, datatype);
+				g_free (value);
+			}
+
+			put_text (job->buffer, " .\n");
+			job->n_triples++;
+		}
+
+		dump_job_flush (job, FALSE);
+	}
+
+	if (cursor) {
+		g_object_unref (cursor);
+	}
+
+	job->error = error;
+
+	dump_job_flush (job, TRUE);
+	g_async_queue_push (job->chunks, g_bytes_new (NULL, 0));
+}
+
+static DumpJob *
+dump_job_new (TrackerProperty *property)
+{
+	DumpJob *job;
+
+	job = g_slice_new0 (DumpJob);
+	job->property = property;
+	job->chunks = g_async_queue_new_full ((GDestroyNotify) g_bytes_unref);
+	job->buffer = g_byte_array_sized_new (CHUNK_SIZE);
+	g_mutex_init (&job->mutex);
+	g_cond_init (&job->cond);
+
+	return job;
+}
+
+static void
+dump_job_free (DumpJob *job)
+{
+	g_async_queue_unref (job->chunks);
+	g_byte_array_unref (job->buffer);
+	g_clear_error (&job->error);
+	g_mutex_clear (&job->mutex);
+	g_cond_clear (&job->cond);
+	g_slice_free (DumpJob, job);
+}
+
+/* Subjects belonging to the ontology are left out, they would
+ * be recreated from the ontology files on import anyway.
+ */
+static gboolean
+build_subject_filter (GError **error)
+{
+	GString *filter;
+	gint i;
+
+	filter = g_string_new (" AND ID NOT IN (SELECT ID FROM \"rdfs:Class\" "
+	                       "UNION ALL SELECT ID FROM \"rdf:Property\" "
+	                       "UNION ALL SELECT ID FROM \"tracker:Namespace\" "
+	                       "UNION ALL SELECT ID FROM \"tracker:Ontology\")");
+
+	for (i = 0; classes && classes[i]; i++) {
+		TrackerClass *class;
+
+		class = tracker_ontologies_get_class_by_uri (classes[i]);
+
+		if (!class) {
+			TrackerClass **all;
+			guint n_all, j;
+
+			/* Also accept prefixed names */
+			all = tracker_ontologies_get_classes (&n_all);
+
+			for (j = 0; j < n_all; j++) {
+				if (g_strcmp0 (tracker_class_get_name (all[j]), classes[i]) == 0) {
+					class = all[j];
+					break;
+				}
+			}
+		}
+
+		if (!class) {
+			g_set_error (error, TRACKER_DB_INTERFACE_ERROR, TRACKER_DB_QUERY_ERROR,
+			             "Unknown class '%s'", classes[i]);
+			g_string_free (filter, TRUE);
+			return FALSE;
+		}
+
+		g_string_append_printf (filter, "%s SELECT ID FROM \"%s\"",
+		                        i == 0 ? " AND ID IN (" : " UNION ALL",
+		                        tracker_class_get_name (class));
+	}
+
+	if (i > 0) {
+		g_string_append (filter, ")");
+	}
+
+	subject_filter = g_string_free (filter, FALSE);
+
+	return TRUE;
+}
+
+static gboolean
+lookup_graph (GError **error)
+{
+	TrackerDBInterface *iface;
+	TrackerDBStatement *stmt;
+	TrackerDBCursor *cursor = NULL;
+	GError *internal_error = NULL;
+
+	iface = tracker_db_manager_get_db_interface ();
+	stmt = tracker_db_interface_create_statement (iface, TRACKER_DB_STATEMENT_CACHE_TYPE_NONE, &internal_error,
+	                                              "SELECT ID FROM Resource WHERE Uri = ?");
+
+	if (stmt) {
+		tracker_db_statement_bind_text (stmt, 0, graph);
+		cursor = tracker_db_statement_start_cursor (stmt, &internal_error);
+		g_object_unref (stmt);
+	}
+
+	if (cursor) {
+		if (tracker_db_cursor_iter_next (cursor, NULL, &internal_error)) {
+			graph_id = tracker_db_cursor_get_int (cursor, 0);
+		}
+		g_object_unref (cursor);
+	}
+
+	if (internal_error) {
+		g_propagate_error (error, internal_error);
+		return FALSE;
+	}
+
+	if (graph_id == 0) {
+		g_set_error (error, TRACKER_DB_INTERFACE_ERROR, TRACKER_DB_QUERY_ERROR,
+		             "Unknown graph '%s'", graph);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static gboolean
+dump (FILE     *file,
+      GError  **error)
+{
+	TrackerProperty **properties;
+	GThreadPool *pool;
+	GPtrArray *queue;
+	guint n_properties, i, next_job;
+	guint64 n_triples = 0;
+	gint64 start_time;
+	gdouble elapsed;
+	GError *internal_error = NULL;
+
+	if (!build_subject_filter (error)) {
+		return FALSE;
+	}
+
+	if (graph && !lookup_graph (error)) {
+		return FALSE;
+	}
+
+	if (binary) {
+		fwrite (DUMP_MAGIC, 1, strlen (DUMP_MAGIC), file);
+	}
+
+	queue = g_ptr_array_new_with_free_func ((GDestroyNotify) dump_job_free);
+
+	if (binary) {
+		g_ptr_array_add (queue, dump_job_new (NULL));
+	}
+
+	/* rdf:type goes first, so instances exist by the
+	 * time their properties are imported.
+	 */
+	g_ptr_array_add (queue, dump_job_new (tracker_ontologies_get_rdf_type ()));
+
+	properties = tracker_ontologies_get_properties (&n_properties);
+
+	for (i = 0; i < n_properties; i++) {
+		if (properties[i] == tracker_ontologies_get_rdf_type () ||
+		    tracker_property_get_transient (properties[i])) {
+			continue;
+		}
+
+		g_ptr_array_add (queue, dump_job_new (properties[i]));
+	}
+
+	pool = g_thread_pool_new ((GFunc) dump_job_run, NULL, jobs, FALSE, NULL);
+	start_time = g_get_monotonic_time ();
+
+	/* Jobs are written in order as they are read, only a few
+	 * are started ahead so the output doesn't pile up in memory.
+	 * Jobs run in the order they are pushed, so the one being
+	 * written is always running, even if the ones ahead block.
+	 */
+	for (next_job = 0; next_job < queue->len && next_job < (guint) jobs * 2; next_job++) {
+		g_thread_pool_push (pool, g_ptr_array_index (queue, next_job), NULL);
+	}
+
+	for (i = 0; i < queue->len; i++) {
+		DumpJob *job = g_ptr_array_index (queue, i);
+		GBytes *chunk;
+
+		while ((chunk = g_async_queue_pop (job->chunks)) != NULL) {
+			gsize size;
+			gconstpointer data;
+
+			data = g_bytes_get_data (chunk, &size);
+
+			if (size == 0) {
+				g_bytes_unref (chunk);
+				break;
+			}
+
+			if (!internal_error && fwrite (data, 1, size, file) != size) {
+				g_set_error (&internal_error, G_FILE_ERROR, G_FILE_ERROR_IO,
+				             "Could not write dump: %s", g_strerror (errno));
+			}
+
+			g_bytes_unref (chunk);
+			dump_job_chunk_written (job);
+		}
+
+		if (!internal_error && job->error) {
+			internal_error = g_error_copy (job->error);
+		}
+
+		n_triples += job->n_triples;
+
+		if (next_job < queue->len) {
+			g_thread_pool_push (pool, g_ptr_array_index (queue, next_job++), NULL);
+		}
+	}
+
+	g_thread_pool_free (pool, FALSE, TRUE);
+	g_ptr_array_unref (queue);
+
+	if (internal_error) {
+		g_propagate_error (error, internal_error);
+		return FALSE;
+	}
+
+	elapsed = (g_get_monotonic_time () - start_time) / (gdouble) G_USEC_PER_SEC;
+
+	g_printerr ("Dumped %" G_GUINT64_FORMAT " triples in %.2f seconds (%.0f triples/s)\n",
+	            n_triples, elapsed, elapsed > 0 ? n_triples / elapsed : 0);
+
+	return TRUE;
+}
+
+static const gchar *
+import_lookup (GHashTable  *resources,
+               guint32      id,
+               GError     **error)
+{
+	const gchar *uri;
+
+	uri = g_hash_table_lookup (resources, GUINT_TO_POINTER (id));
+
+	if (!uri) {
+		g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+		             "Invalid dump, resource %u is not defined", id);
+	}
+
+	return uri;
+}
+
+/* Returns the string at @record, or NULL if it overflows @end */
+static const gchar *
+import_string (const guint32  *record,
+               const guint32  *end,
+               const guint32 **next)
+{
+	const gchar *str;
+	guint32 len;
+
+	if (record >= end) {
+		return NULL;
+	}
+
+	len = record[0];
+	str = (const gchar *) &record[1];
+
+	if (len == 0 || len > (gsize) ((const gchar *) end - str) || str[len - 1] != '\0') {
+		return NULL;
+	}
+
+	*next = &record[1] + (len + 3) / 4;
+
+	return str;
+}
+
+static gboolean
+import_dump (const gchar  *path,
+             GError      **error)
+{
+	GMappedFile *mapped_file;
+	GHashTable *resources;
+	const guint32 *record, *end;
+	const gchar *contents;
+	guint64 n_triples = 0;
+	gsize length;
+	gint64 start_time;
+	gdouble elapsed;
+	GError *internal_error = NULL;
+
+	mapped_file = g_mapped_file_new (path, FALSE, error);
+
+	if (!mapped_file) {
+		return FALSE;
+	}
+
+	contents = g_mapped_file_get_contents (mapped_file);
+	length = g_mapped_file_get_length (mapped_file);
+
+	if (length < strlen (DUMP_MAGIC) ||
+	    memcmp (contents, DUMP_MAGIC, strlen (DUMP_MAGIC)) != 0 ||
+	    length % 4 != 0) {
+		g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+		             "'%s' is not a binary dump", path);
+		g_mapped_file_unref (mapped_file);
+		return FALSE;
+	}
+
+	/* URIs point straight into the mapped file */
+	resources = g_hash_table_new (NULL, NULL);
+
+	record = (const guint32 *) (contents + strlen (DUMP_MAGIC));
+	end = (const guint32 *) (contents + length);
+
+	start_time = g_get_monotonic_time ();
+	tracker_data_begin_transaction (&internal_error);
+
+	while (!internal_error && record < end) {
+		const gchar *graph_uri = NULL, *subject = NULL, *predicate = NULL, *object = NULL;
+		const guint32 *next;
+
+		if (record[0] == DUMP_RECORD_RESOURCE) {
+			if (record + 2 > end ||
+			    !(object = import_string (&record[2], end, &next))) {
+				break;
+			}
+
+			g_hash_table_insert (resources, GUINT_TO_POINTER (record[1]), (gpointer) object);
+			record = next;
+			continue;
+		}
+
+		if ((record[0] != DUMP_RECORD_URI && record[0] != DUMP_RECORD_LITERAL) ||
+		    record + 5 > end) {
+			break;
+		}
+
+		if ((record[1] != 0 && !(graph_uri = import_lookup (resources, record[1], &internal_error))) ||
+		    !(subject = import_lookup (resources, record[2], &internal_error)) ||
+		    !(predicate = import_lookup (resources, record[3], &internal_error))) {
+			break;
+		}
+
+		if (record[0] == DUMP_RECORD_URI) {
+			if (!(object = import_lookup (resources, record[4], &internal_error))) {
+				break;
+			}
+
+			tracker_data_insert_statement_with_uri (graph_uri, subject, predicate, object,
+			                                        &internal_error);
+			record += 5;
+		} else {
+			if (!(object = import_string (&record[4], end, &next))) {
+				break;
+			}
+
+			tracker_data_insert_statement_with_string (graph_uri, subject, predicate, object,
+			                                           &internal_error);
+			record = next;
+		}
+
+		if (internal_error) {
+			break;
+		}
+
+		tracker_data_update_buffer_might_flush (&internal_error);
+
+		if (!internal_error && ++n_triples % IMPORT_BATCH_SIZE == 0) {
+			tracker_data_commit_transaction (&internal_error);
+
+			if (!internal_error) {
+				tracker_data_begin_transaction (&internal_error);
+			}
+		}
+	}
+
+	if (!internal_error && record < end) {
+		g_set_error (&internal_error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+		             "Invalid dump, corrupt record at offset %" G_GSIZE_FORMAT,
+		             (gsize) ((const gchar *) record - contents));
+	}
+
+	if (!internal_error) {
+		tracker_data_commit_transaction (&internal_error);
+	} else {
+		tracker_data_rollback_transaction ();
+	}
+
+	g_hash_table_unref (resources);
+	g_mapped_file_unref (mapped_file);
+
+	if (internal_error) {
+		g_propagate_prefixed_error (error, internal_error,
+		                            "Imported %" G_GUINT64_FORMAT " triples, then failed: ",
+		                            n_triples - n_triples % IMPORT_BATCH_SIZE);
+		return FALSE;
+	}
+
+	elapsed = (g_get_monotonic_time () - start_time) / (gdouble) G_USEC_PER_SEC;
+
+	g_printerr ("Imported %" G_GUINT64_FORMAT " triples in %.2f seconds (%.0f triples/s)\n",
+	            n_triples, elapsed, elapsed > 0 ? n_triples / elapsed : 0);
+
+	return TRUE;
+}
+
+int
+main (int argc, char **argv)
+{
+	GOptionContext *context;
+	GError *error = NULL;
+	const gchar *error_message;
+	gboolean first_time = FALSE;
+	gboolean success;
+	FILE *file;
+
+	setlocale (LC_ALL, "");
+
+	bindtextdomain (GETTEXT_PACKAGE, LOCALEDIR);
+	bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
+	textdomain (GETTEXT_PACKAGE);
+
+	context = g_option_context_new (_("- Dump all triples of the store, or import a binary dump"));
+
+	g_option_context_add_main_entries (context, entries, NULL);
+	g_option_context_parse (context, &argc, &argv, NULL);
+
+	if (format && strcmp (format, "ntriples") != 0 && strcmp (format, "binary") != 0) {
+		error_message = _("Format must be either \"ntriples\" or \"binary\"");
+	} else if (import && (output || format || classes || graph)) {
+		error_message = _("Import can not be used together with dump options");
+	} else if (jobs < 0) {
+		error_message = _("Number of jobs must be positive");
+	} else {
+		error_message = NULL;
+	}
+
+	if (error_message) {
+		gchar *help;
+
+		g_printerr ("%s\n\n", error_message);
+
+		help = g_option_context_get_help (context, TRUE, NULL);
+		g_option_context_free (context);
+		g_printerr ("%s", help);
+		g_free (help);
+
+		return EXIT_FAILURE;
+	}
+
+	g_option_context_free (context);
+
+	binary = g_strcmp0 (format, "binary") == 0;
+
+	if (jobs == 0) {
+		jobs = g_get_num_processors ();
+	}
+
+	if (!tracker_data_manager_init (import ? 0 : TRACKER_DB_MANAGER_READONLY,
+	                                NULL,
+	                                &first_time,
+	                                FALSE,
+	                                FALSE,
+	                                100,
+	                                100,
+	                                NULL,
+	                                NULL,
+	                                NULL,
+	                                &error)) {
+		g_printerr ("%s: %s\n",
+		            _("Failed to initialize data manager"),
+		            error->message);
+		g_error_free (error);
+		return EXIT_FAILURE;
+	}
+
+	if (import) {
+		success = import_dump (import, &error);
+	} else {
+		if (!output || strcmp (output, "-") == 0) {
+			file = stdout;
+		} else {
+			file = fopen (output, "wb");
+		}
+
+		if (!file) {
+			g_printerr ("%s:'%s', %s\n",
+			            _("Could not open file"),
+			            output,
+			            g_strerror (errno));
+			tracker_data_manager_shutdown ();
+			return EXIT_FAILURE;
+		}
+
+		success = dump (file, &error);
+
+		if (file != stdout && fclose (file) != 0 && success) {
+			g_set_error (&error, G_FILE_ERROR, G_FILE_ERROR_IO,
+			             "Could not write dump: %s", g_strerror (errno));
+			success = FALSE;
+		}
+	}
+
+	tracker_data_manager_shutdown ();
+
+	if (!success) {
+		g_printerr ("%s: %s\n",
+		            import ? _("Could not import dump") : _("Could not dump"),
+		            error->message);
+		g_error_free (error);
+
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}